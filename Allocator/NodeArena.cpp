@@ -0,0 +1,80 @@
+#include "NodeArena.h"
+#include <new>
+
+using namespace std;
+
+NodeArena::~NodeArena()
+{
+    for (void *block : heapBlocks)
+    {
+        ::operator delete(block);
+    }
+}
+
+size_t NodeArena::roundUp(size_t bytes)
+{
+    return bytes == 0 ? GRANULARITY : (bytes + GRANULARITY - 1) / GRANULARITY * GRANULARITY;
+}
+
+void *NodeArena::allocateFromHeap(size_t bytes)
+{
+    void *block = ::operator new(bytes);
+    heapBlocks.push_back(block);
+    reservedBytes += bytes;
+    heapAllocations++;
+    return block;
+}
+
+void *NodeArena::allocate(size_t bytes)
+{
+    bytes = roundUp(bytes);
+    FreeBlock **freeList;
+    if (bytes <= SMALL_LIMIT)
+    {
+        freeList = &smallBlocks[bytes / GRANULARITY - 1];
+    }
+    else
+    {
+        freeList = &largeBlocks[bytes];
+    }
+    if (*freeList)
+    {
+        FreeBlock *block = *freeList;
+        *freeList = block->next;
+        return block;
+    }
+
+    if (bytes > SMALL_LIMIT)
+    {
+        return allocateFromHeap(bytes);
+    }
+    if (chunkLeft < bytes)
+    {
+        // The rest of the old chunk is too small for this class, it stays unused
+        chunkCursor = static_cast<char *>(allocateFromHeap(CHUNK_SIZE));
+        chunkLeft = CHUNK_SIZE;
+    }
+    void *block = chunkCursor;
+    chunkCursor += bytes;
+    chunkLeft -= bytes;
+    return block;
+}
+
+void NodeArena::deallocate(void *block, size_t bytes)
+{
+    bytes = roundUp(bytes);
+    FreeBlock *freed = static_cast<FreeBlock *>(block);
+    FreeBlock *&freeList = bytes <= SMALL_LIMIT ? smallBlocks[bytes / GRANULARITY - 1] : largeBlocks[bytes];
+    freed->next = freeList;
+    freeList = freed;
+}
+
+size_t NodeArena::getReservedBytes() const
+{
+    return reservedBytes;
+}
+
+uint64_t NodeArena::getHeapAllocations() const
+{
+    return heapAllocations;
+}
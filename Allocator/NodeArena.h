@@ -0,0 +1,52 @@
+#ifndef NODEARENA_H
+#define NODEARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Per-simulator pool of recycled memory blocks. Small blocks, container nodes, are carved from large
+// chunks and kept on a free list per size class. Larger blocks, second-level page tables and hash
+// buckets, are recycled by exact size. Nothing goes back to the heap before the arena does, so once the
+// simulated state stops growing every allocation is served from a free list. Not thread-safe: every
+// simulator, and so every parallel replay worker, has an arena of its own
+class NodeArena
+{
+private:
+    static const std::size_t GRANULARITY = 16; // Block sizes are rounded up to this, which keeps them aligned
+    static const std::size_t SMALL_LIMIT = 256;
+    static const std::size_t CHUNK_SIZE = 64 * 1024;
+
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    FreeBlock *smallBlocks[SMALL_LIMIT / GRANULARITY] = {};
+    std::unordered_map<std::size_t, FreeBlock *> largeBlocks; // Free lists by exact size
+    std::vector<void *> heapBlocks;                           // Chunks and large blocks, freed with the arena
+    char *chunkCursor = nullptr;
+    std::size_t chunkLeft = 0;
+
+    std::size_t reservedBytes = 0;
+    uint64_t heapAllocations = 0;
+
+    static std::size_t roundUp(std::size_t bytes);
+    void *allocateFromHeap(std::size_t bytes);
+
+public:
+    NodeArena() = default;
+    ~NodeArena();
+    NodeArena(const NodeArena &) = delete;
+    NodeArena &operator=(const NodeArena &) = delete;
+
+    void *allocate(std::size_t bytes);
+    void deallocate(void *block, std::size_t bytes);
+
+    // Bytes taken from the heap, and how many heap allocations that took
+    std::size_t getReservedBytes() const;
+    uint64_t getHeapAllocations() const;
+};
+
+#endif // NODEARENA_H
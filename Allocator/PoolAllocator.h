@@ -0,0 +1,64 @@
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <type_traits>
+#include "NodeArena.h"
+
+// Standard allocator drawing from a NodeArena. Containers share the arena, which stays alive as long as
+// any of them does, e.g. a process a parallel replay worker hands over. Without an arena it uses the heap
+template <typename T>
+class PoolAllocator
+{
+private:
+    std::shared_ptr<NodeArena> arena;
+
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Arena blocks are not aligned for over-aligned types");
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    PoolAllocator() = default;
+    explicit PoolAllocator(std::shared_ptr<NodeArena> arena) : arena(std::move(arena)) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U> &other) : arena(other.getArena())
+    {
+    }
+
+    T *allocate(std::size_t count)
+    {
+        if (!arena)
+        {
+            return std::allocator<T>().allocate(count);
+        }
+        return static_cast<T *>(arena->allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T *block, std::size_t count)
+    {
+        if (!arena)
+        {
+            std::allocator<T>().deallocate(block, count);
+            return;
+        }
+        arena->deallocate(block, count * sizeof(T));
+    }
+
+    const std::shared_ptr<NodeArena> &getArena() const { return arena; }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U> &other) const { return arena == other.getArena(); }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U> &other) const { return arena != other.getArena(); }
+};
+
+template <typename T>
+using PoolList = std::list<T, PoolAllocator<T>>;
+
+#endif // POOLALLOCATOR_H
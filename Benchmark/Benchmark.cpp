@@ -0,0 +1,500 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <memory>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <iomanip>
+#include <algorithm>
+#include "../PageTable/PageTable.h"
+#include "../PageTable/ConcurrentPageTable.h"
+#include "../PageTable/PhysicalFrameManager.h"
+#include "../TLB/TLB.h"
+#include "../Log/Log.h"
+
+using namespace std;
+
+#ifndef VMSIM_SIMULATOR_PATH
+#define VMSIM_SIMULATOR_PATH "./vmsimulator"
+#endif
+
+// Components log every step, the benchmarks send that output nowhere
+static ostream nullStream(nullptr);
+
+static volatile uint64_t sink; // Keeps results of benchmarked calls alive
+
+struct BenchmarkResult {
+    string name;
+    double rate;
+    string unit;
+};
+
+// Accumulates the time between start() and stop(), so setup inside a benchmark is not measured
+class Stopwatch {
+private:
+    chrono::steady_clock::time_point started;
+    chrono::nanoseconds elapsed{0};
+
+public:
+    void start() {
+        started = chrono::steady_clock::now();
+    }
+
+    void stop() {
+        elapsed += chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - started);
+    }
+
+    double seconds() const {
+        return elapsed.count() / 1e9;
+    }
+};
+
+struct BenchmarkOptions {
+    uint32_t repetitions = 5;
+    string filter;
+    string simulator = VMSIM_SIMULATOR_PATH;
+};
+
+// Run a benchmark several times and keep the fastest run. The body returns the operations it timed
+static void runBenchmark(vector<BenchmarkResult>& results, const BenchmarkOptions& options, const string& name,
+                         const string& unit, const function<uint64_t(Stopwatch&)>& body) {
+    if (!options.filter.empty() && name.find(options.filter) == string::npos) {
+        return;
+    }
+    double best = 0;
+    for (uint32_t i = 0; i < options.repetitions; i++) {
+        Stopwatch stopwatch;
+        uint64_t operations = body(stopwatch);
+        if (stopwatch.seconds() > 0) {
+            best = max(best, operations / stopwatch.seconds());
+        }
+    }
+    cout << left << setw(44) << name << right << setw(16) << fixed << setprecision(0) << best << " " << unit << endl;
+    results.push_back({name, best, unit});
+}
+
+// Random VPNs in a 32-bit address space of 4 KB pages, the same sequence on every run
+static vector<uint32_t> randomVpns(uint32_t count, uint32_t seed) {
+    mt19937 rng(seed);
+    uniform_int_distribution<uint32_t> vpn(0, (1u << 20) - 1);
+    vector<uint32_t> vpns(count);
+    for (uint32_t& value : vpns) {
+        value = vpn(rng);
+    }
+    return vpns;
+}
+
+static void benchmarkTlb(vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+    const uint32_t tlbSize = 64;
+    const uint32_t operations = 200000;
+
+    runBenchmark(results, options, "tlb_lookup_hit", "lookups/s", [&](Stopwatch& stopwatch) {
+        TLB tlb(tlbSize);
+        for (uint32_t vpn = 0; vpn < tlbSize; vpn++) {
+            tlb.updateTLB(vpn, vpn, true, true, false);
+        }
+        vector<uint32_t> vpns = randomVpns(operations, 1);
+        stopwatch.start();
+        for (uint32_t vpn : vpns) {
+            sink += tlb.lookupTLB(vpn % tlbSize);
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(operations);
+    });
+
+    runBenchmark(results, options, "tlb_lookup_miss", "lookups/s", [&](Stopwatch& stopwatch) {
+        TLB tlb(tlbSize);
+        for (uint32_t vpn = 0; vpn < tlbSize; vpn++) {
+            tlb.updateTLB(vpn, vpn, true, true, false);
+        }
+        vector<uint32_t> vpns = randomVpns(operations, 2);
+        stopwatch.start();
+        for (uint32_t vpn : vpns) {
+            sink += tlb.lookupTLB(vpn | tlbSize);
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(operations);
+    });
+
+    // Every update of a full TLB evicts its least recently used entry first
+    runBenchmark(results, options, "tlb_update_evict", "updates/s", [&](Stopwatch& stopwatch) {
+        TLB tlb(tlbSize);
+        for (uint32_t vpn = 0; vpn < tlbSize; vpn++) {
+            tlb.updateTLB(vpn, vpn, true, true, false);
+        }
+        const uint32_t updates = operations / 10;
+        stopwatch.start();
+        for (uint32_t i = 0; i < updates; i++) {
+            tlb.updateTLB(tlbSize + i, i, true, true, false);
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(updates);
+    });
+}
+
+static void benchmarkPageTable(vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+    const uint32_t pages = 65536;
+    vector<uint32_t> vpns = randomVpns(pages, 3);
+
+    runBenchmark(results, options, "page_table_update", "updates/s", [&](Stopwatch& stopwatch) {
+        PageTable pageTable(32, 4096);
+        stopwatch.start();
+        for (uint32_t i = 0; i < pages; i++) {
+            pageTable.updatePageTable(vpns[i], i, true, false, true, true, false, 0);
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(pages);
+    });
+
+    runBenchmark(results, options, "page_table_lookup", "lookups/s", [&](Stopwatch& stopwatch) {
+        PageTable pageTable(32, 4096);
+        for (uint32_t i = 0; i < pages; i++) {
+            pageTable.updatePageTable(vpns[i], i, true, false, true, true, false, 0);
+        }
+        vector<uint32_t> order = randomVpns(pages * 4, 4);
+        stopwatch.start();
+        for (uint32_t index : order) {
+            sink += pageTable.lookupPageTable(vpns[index % pages]);
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(order.size());
+    });
+
+    // The walk alone, without the reference and clock updates of a lookup
+    runBenchmark(results, options, "page_table_walk", "walks/s", [&](Stopwatch& stopwatch) {
+        PageTable pageTable(32, 4096);
+        for (uint32_t i = 0; i < pages; i++) {
+            pageTable.updatePageTable(vpns[i], i, true, false, true, true, false, 0);
+        }
+        vector<uint32_t> order = randomVpns(pages * 16, 4);
+        stopwatch.start();
+        for (uint32_t index : order) {
+            sink += pageTable.getPageTableEntry(vpns[index % pages]) != nullptr;
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(order.size());
+    });
+
+    runBenchmark(results, options, "page_table_remove", "removals/s", [&](Stopwatch& stopwatch) {
+        PageTable pageTable(32, 4096);
+        for (uint32_t i = 0; i < pages; i++) {
+            pageTable.updatePageTable(vpns[i], i, true, false, true, true, false, 0);
+        }
+        // Random VPNs may repeat, remove distinct ones
+        vector<uint32_t> distinct = vpns;
+        sort(distinct.begin(), distinct.end());
+        distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+        shuffle(distinct.begin(), distinct.end(), mt19937(4));
+        stopwatch.start();
+        for (uint32_t vpn : distinct) {
+            sink += pageTable.removeAddressForOneEntry(vpn);
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(distinct.size());
+    });
+
+    // The same pages in a hashed inverted table sized for them, as --page-table=hashed sizes it to memory
+    runBenchmark(results, options, "hashed_page_table_update", "updates/s", [&](Stopwatch& stopwatch) {
+        PageTable pageTable(32, 4096, nullptr, make_shared<InvertedPageTable>(pages));
+        stopwatch.start();
+        for (uint32_t i = 0; i < pages; i++) {
+            pageTable.updatePageTable(vpns[i], i, true, false, true, true, false, 0);
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(pages);
+    });
+
+    runBenchmark(results, options, "hashed_page_table_lookup", "lookups/s", [&](Stopwatch& stopwatch) {
+        PageTable pageTable(32, 4096, nullptr, make_shared<InvertedPageTable>(pages));
+        for (uint32_t i = 0; i < pages; i++) {
+            pageTable.updatePageTable(vpns[i], i, true, false, true, true, false, 0);
+        }
+        vector<uint32_t> order = randomVpns(pages * 4, 4);
+        stopwatch.start();
+        for (uint32_t index : order) {
+            sink += pageTable.lookupPageTable(vpns[index % pages]);
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(order.size());
+    });
+}
+
+// Evict a victim and map a new page in its frame, keeping the resident set at a fixed size
+static void benchmarkClock(vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+    for (uint32_t residentPages : {256u, 4096u, 65536u}) {
+        runBenchmark(results, options, "clock_select_" + to_string(residentPages) + "_pages", "evictions/s",
+                     [&](Stopwatch& stopwatch) {
+            mt19937 rng(5);
+            PageTable pageTable(32, 4096);
+            for (uint32_t vpn = 0; vpn < residentPages; vpn++) {
+                pageTable.updatePageTable(vpn, vpn, true, false, true, true, false, rng() % 4);
+            }
+            const uint32_t evictions = 2000;
+            uint32_t nextVpn = residentPages;
+            stopwatch.start();
+            for (uint32_t i = 0; i < evictions; i++) {
+                uint32_t victim;
+                int frame = pageTable.evictPageUsingClockAlgo(victim);
+                pageTable.updatePageTable(nextVpn++, frame, true, false, true, true, false, rng() % 4);
+            }
+            stopwatch.stop();
+            return static_cast<uint64_t>(evictions);
+        });
+    }
+}
+
+static void benchmarkFrames(vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+    const uint32_t frames = 65536;
+    runBenchmark(results, options, "frame_allocate_free", "frames/s", [&](Stopwatch& stopwatch) {
+        PhysicalFrameManager manager(frames);
+        vector<uint32_t> allocated(frames);
+        stopwatch.start();
+        for (uint32_t round = 0; round < 4; round++) {
+            for (uint32_t i = 0; i < frames; i++) {
+                allocated[i] = manager.allocateFrame();
+            }
+            for (uint32_t frame : allocated) {
+                manager.freeAFrame(frame);
+            }
+        }
+        stopwatch.stop();
+        return static_cast<uint64_t>(4) * frames;
+    });
+}
+
+// Lookups from several threads at once over a shared, fully populated table
+static void benchmarkConcurrentPageTable(vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+    const uint32_t pages = 65536;
+    const uint32_t lookupsPerThread = 200000;
+    vector<uint32_t> vpns = randomVpns(pages, 6);
+    for (uint32_t threads : {1u, 2u, 4u}) {
+        runBenchmark(results, options, "concurrent_lookup_" + to_string(threads) + "_threads", "lookups/s",
+                     [&](Stopwatch& stopwatch) {
+            ConcurrentPageTable pageTable(32, 4096);
+            for (uint32_t i = 0; i < pages; i++) {
+                pageTable.updatePageTable(vpns[i], i, true, false, true, true, false, 0);
+            }
+            vector<thread> workers;
+            stopwatch.start();
+            for (uint32_t t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    uint64_t found = 0;
+                    uint32_t index = t * 7919;
+                    for (uint32_t i = 0; i < lookupsPerThread; i++) {
+                        index = (index + 40503) % pages;
+                        found += pageTable.lookupPageTable(vpns[index]) >= 0;
+                    }
+                    sink += found;
+                });
+            }
+            for (thread& worker : workers) {
+                worker.join();
+            }
+            stopwatch.stop();
+            return static_cast<uint64_t>(threads) * lookupsPerThread;
+        });
+    }
+}
+
+// Write a trace in generator.py's format from a fixed seed: processes take turns for a few hundred
+// instructions, code runs sequentially with jumps, the stack stays near its top and heap accesses
+// step to a neighbour with the given locality or jump anywhere in the heap. Returns the access count
+static uint64_t writeTrace(const string& path, uint32_t processes, uint32_t instructions, double locality,
+                           uint32_t heapBytes, uint32_t seed) {
+    ofstream out(path);
+    mt19937 rng(seed);
+    uniform_real_distribution<double> chance(0.0, 1.0);
+    const uint32_t codeSize = 4 * 1024 * 1024;
+    const uint32_t stackTop = 0xffffffff;
+    vector<uint32_t> codePointer(processes, 0);
+    vector<uint32_t> heapPointer(processes, codeSize);
+    vector<uint32_t> stackPointer(processes, stackTop);
+
+    for (uint32_t pid = 0; pid < processes; pid++) {
+        out << pid << "\tswitch\t\n" << pid << "\talloc\t\t0x" << hex << heapBytes << dec << "\n";
+    }
+    uint64_t accesses = 0;
+    uint32_t pid = 0;
+    for (uint32_t i = 0; i < instructions; i++) {
+        if (i % 500 == 499) {
+            pid = (pid + 1) % processes;
+            out << pid << "\tswitch\t\n";
+        }
+        double kind = chance(rng);
+        out << hex;
+        if (kind < 0.35) {
+            codePointer[pid] = chance(rng) < 0.95 ? codePointer[pid] + 1 : rng() % codeSize;
+            out << pid << "\taccess_code\t0x" << codePointer[pid] << "\n";
+        } else if (kind < 0.65) {
+            uint32_t offset = rng() % (64 * 1024);
+            stackPointer[pid] = stackTop - offset;
+            out << pid << "\taccess_stak\t0x" << stackPointer[pid] << "\t" << (chance(rng) < 0.5 ? "w" : "r") << "\n";
+        } else {
+            uint32_t& pointer = heapPointer[pid];
+            if (chance(rng) < locality) {
+                uint32_t step = static_cast<uint32_t>(rng() % 129);
+                pointer = min(max(pointer + step, codeSize + 64) - 64, codeSize + heapBytes - 1);
+            } else {
+                pointer = codeSize + static_cast<uint32_t>(rng() % heapBytes);
+            }
+            out << pid << "\taccess_heap\t0x" << pointer << "\t" << (chance(rng) < 0.3 ? "w" : "r") << "\n";
+        }
+        out << dec;
+        accesses++;
+    }
+    return accesses;
+}
+
+// Replay generated traces with the simulator binary, its output discarded, and report accesses per second
+static void benchmarkReplay(vector<BenchmarkResult>& results, const BenchmarkOptions& options) {
+    struct ReplayCase {
+        string name;
+        uint32_t processes;
+        uint32_t instructions;
+        double locality;
+        uint32_t heapBytes;
+        uint32_t processBytes;
+        uint32_t physicalBytes;
+    };
+    const vector<ReplayCase> cases = {
+        {"replay_local_no_pressure", 4, 200000, 0.9, 2 * 1024 * 1024, 8 * 1024 * 1024, 64 * 1024 * 1024},
+        {"replay_random_pressure", 4, 200000, 0.3, 2 * 1024 * 1024, 4 * 1024 * 1024, 4 * 1024 * 1024},
+    };
+    if (system(("test -x " + options.simulator).c_str()) != 0) {
+        cerr << "Skipping replay benchmarks, no simulator binary at " << options.simulator << endl;
+        return;
+    }
+
+    for (const ReplayCase& replay : cases) {
+        string trace = "benchmark_" + replay.name + ".txt";
+        uint64_t accesses = writeTrace(trace, replay.processes, replay.instructions, replay.locality, replay.heapBytes, 7);
+        ostringstream command;
+        command << options.simulator << " 4096 32 " << replay.physicalBytes << " 16";
+        for (uint32_t pid = 0; pid < replay.processes; pid++) {
+            command << " " << replay.processBytes;
+        }
+        command << " " << trace << " > /dev/null 2>&1";
+        runBenchmark(results, options, replay.name, "accesses/s", [&](Stopwatch& stopwatch) {
+            stopwatch.start();
+            int status = system(command.str().c_str());
+            stopwatch.stop();
+            if (status != 0) {
+                throw runtime_error("Simulator failed on " + replay.name + ": " + command.str());
+            }
+            return accesses;
+        });
+        remove(trace.c_str());
+    }
+}
+
+static map<string, double> loadBaseline(const string& path) {
+    ifstream in(path);
+    if (!in) {
+        throw runtime_error("Cannot open baseline file " + path);
+    }
+    map<string, double> baseline;
+    string name;
+    double rate;
+    while (in >> name >> rate) {
+        baseline[name] = rate;
+    }
+    return baseline;
+}
+
+static void saveBaseline(const string& path, const vector<BenchmarkResult>& results) {
+    ofstream out(path);
+    if (!out) {
+        throw runtime_error("Cannot write baseline file " + path);
+    }
+    for (const BenchmarkResult& result : results) {
+        out << result.name << " " << fixed << setprecision(1) << result.rate << "\n";
+    }
+}
+
+// Compare the results with a saved baseline, returns the number of benchmarks that got slower than the threshold allows
+static uint32_t compareWithBaseline(const map<string, double>& baseline, const vector<BenchmarkResult>& results,
+                                    double thresholdPercent) {
+    uint32_t regressions = 0;
+    cout << "\n--- Comparison with baseline (threshold " << thresholdPercent << "%) ---" << endl;
+    for (const BenchmarkResult& result : results) {
+        auto saved = baseline.find(result.name);
+        if (saved == baseline.end() || saved->second <= 0) {
+            cout << left << setw(44) << result.name << " not in baseline" << endl;
+            continue;
+        }
+        double change = (result.rate / saved->second - 1) * 100;
+        bool regressed = change < -thresholdPercent;
+        regressions += regressed;
+        cout << left << setw(44) << result.name << right << setw(8) << showpos << setprecision(1) << change << "%"
+             << noshowpos << (regressed ? "  REGRESSION" : "") << endl;
+    }
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    string baselinePath;
+    string savePath;
+    double threshold = 10;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string name = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--repetitions") {
+            options.repetitions = max(1ul, stoul(value));
+        } else if (name == "--filter") {
+            options.filter = value;
+        } else if (name == "--simulator") {
+            options.simulator = value;
+        } else if (name == "--baseline") {
+            baselinePath = value;
+        } else if (name == "--save-baseline") {
+            savePath = value;
+        } else if (name == "--threshold") {
+            threshold = stod(value);
+        } else {
+            cerr << "Usage: " << argv[0] << " [options]" << endl;
+            cerr << "Options:" << endl;
+            cerr << "  --repetitions=<n>        Runs per benchmark, the fastest one counts (default 5)" << endl;
+            cerr << "  --filter=<text>          Only run benchmarks whose name contains the text" << endl;
+            cerr << "  --simulator=<path>       Simulator binary for the replay benchmarks (default " << VMSIM_SIMULATOR_PATH << ")" << endl;
+            cerr << "  --save-baseline=<file>   Save the results as a baseline" << endl;
+            cerr << "  --baseline=<file>        Compare with a saved baseline, exit with 1 on regressions" << endl;
+            cerr << "  --threshold=<percent>    Slowdown that counts as a regression (default 10)" << endl;
+            return 1;
+        }
+    }
+
+    logStream = &nullStream;
+    errorStream = &nullStream;
+    try {
+        vector<BenchmarkResult> results;
+        benchmarkTlb(results, options);
+        benchmarkPageTable(results, options);
+        benchmarkClock(results, options);
+        benchmarkFrames(results, options);
+        benchmarkConcurrentPageTable(results, options);
+        benchmarkReplay(results, options);
+
+        if (!savePath.empty()) {
+            saveBaseline(savePath, results);
+        }
+        if (!baselinePath.empty() && compareWithBaseline(loadBaseline(baselinePath), results, threshold) > 0) {
+            return 1;
+        }
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
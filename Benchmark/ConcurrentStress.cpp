@@ -0,0 +1,194 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include "../PageTable/ConcurrentPageTable.h"
+#include "../Log/Log.h"
+
+using namespace std;
+
+// Stress check of ConcurrentPageTable and its EpochReclaimer: readers look up pages while writers map and
+// unmap them and an evictor takes victims, so second-level nodes are emptied, retired and freed under the
+// readers. Build it with TSAN=1 (make) or -DVMSIM_TSAN=ON (CMake) to run it under ThreadSanitizer
+
+// Components log every step, the check sends that output nowhere. The log streams are per thread
+static ostream nullStream(nullptr);
+
+// Writers own disjoint ranges of a few second-level nodes each and keep them sparse, so nodes empty often
+static const uint32_t L2_PAGES = 1024; // Pages per second-level node with 32-bit addresses and 4 KB pages
+static const uint32_t NODES_PER_WRITER = 4;
+static const uint32_t PAGES_PER_NODE = 8;
+
+struct StressOptions {
+    uint32_t readers = 4;
+    uint32_t writers = 2;
+    uint32_t operations = 1000000;
+};
+
+// Every VPN is always mapped to the same frame, so any other frame a reader sees is a torn or freed entry
+static uint32_t frameOf(uint32_t vpn) {
+    return (vpn * 2654435761u) >> 4;
+}
+
+// The VPNs writer w maps, spread over its nodes
+static uint32_t vpnOf(uint32_t writer, uint32_t page) {
+    uint32_t node = writer * NODES_PER_WRITER + page / PAGES_PER_NODE;
+    return node * L2_PAGES + (page % PAGES_PER_NODE) * (L2_PAGES / PAGES_PER_NODE);
+}
+
+static int runStress(const StressOptions& options) {
+    ConcurrentPageTable pageTable(32, 4096);
+    const uint32_t pagesPerWriter = NODES_PER_WRITER * PAGES_PER_NODE;
+    atomic<bool> writing(true);
+    atomic<uint64_t> failures(0);
+    atomic<uint64_t> found(0);
+    atomic<uint64_t> evicted(0);
+
+    auto fail = [&](const string& message) {
+        if (failures.fetch_add(1) < 10) {
+            cerr << "FAIL: " << message << endl;
+        }
+    };
+
+    vector<thread> threads;
+    for (uint32_t w = 0; w < options.writers; w++) {
+        threads.emplace_back([&, w]() {
+            errorStream = &nullStream;
+            mt19937 rng(w + 1);
+            uniform_int_distribution<uint32_t> page(0, pagesPerWriter - 1);
+            for (uint32_t i = 0; i < options.operations; i++) {
+                uint32_t vpn = vpnOf(w, page(rng));
+                if (rng() % 2) {
+                    pageTable.updatePageTable(vpn, frameOf(vpn), true, false, true, true, false, 0);
+                    continue;
+                }
+                // The evictor may have taken the page already
+                int frame = pageTable.removeAddressForOneEntry(vpn);
+                if (frame != -1 && static_cast<uint32_t>(frame) != frameOf(vpn)) {
+                    fail("removed VPN " + to_string(vpn) + " had frame " + to_string(frame));
+                }
+            }
+        });
+    }
+
+    for (uint32_t r = 0; r < options.readers; r++) {
+        threads.emplace_back([&, r]() {
+            mt19937 rng(100 + r);
+            uniform_int_distribution<uint32_t> writer(0, options.writers - 1);
+            uniform_int_distribution<uint32_t> page(0, pagesPerWriter - 1);
+            uint64_t hits = 0;
+            while (writing.load(memory_order_relaxed)) {
+                uint32_t vpn = vpnOf(writer(rng), page(rng));
+                PageTableEntry entry;
+                if (!pageTable.lookupPageTableEntry(vpn, entry)) {
+                    continue;
+                }
+                hits++;
+                if (!entry.isValid() || entry.getFrameNumber() != frameOf(vpn)) {
+                    fail("looked up VPN " + to_string(vpn) + " with frame " + to_string(entry.getFrameNumber()));
+                }
+            }
+            found += hits;
+        });
+    }
+
+    // Evict only while more than a quarter of the pages are mapped, like a kernel under memory pressure
+    threads.emplace_back([&]() {
+        errorStream = &nullStream;
+        while (writing.load(memory_order_relaxed)) {
+            if (pageTable.getResidentPages() <= options.writers * pagesPerWriter / 4) {
+                this_thread::yield();
+                continue;
+            }
+            uint32_t vpn;
+            int frame = pageTable.evictPageUsingClockAlgo(vpn);
+            if (frame == -1) {
+                this_thread::yield();
+                continue;
+            }
+            evicted++;
+            if (static_cast<uint32_t>(frame) != frameOf(vpn)) {
+                fail("evicted VPN " + to_string(vpn) + " had frame " + to_string(frame));
+            }
+        }
+    });
+
+    for (uint32_t w = 0; w < options.writers; w++) {
+        threads[w].join();
+    }
+    writing = false;
+    for (uint32_t i = options.writers; i < threads.size(); i++) {
+        threads[i].join();
+    }
+
+    // Quiescent now: what is still mapped must match the resident count
+    uint32_t mapped = 0;
+    for (uint32_t w = 0; w < options.writers; w++) {
+        for (uint32_t p = 0; p < pagesPerWriter; p++) {
+            uint32_t vpn = vpnOf(w, p);
+            int32_t frame = pageTable.lookupPageTable(vpn);
+            if (frame == -1) {
+                continue;
+            }
+            mapped++;
+            if (static_cast<uint32_t>(frame) != frameOf(vpn)) {
+                fail("VPN " + to_string(vpn) + " was left with frame " + to_string(frame));
+            }
+        }
+    }
+    if (mapped != pageTable.getResidentPages()) {
+        fail(to_string(pageTable.getResidentPages()) + " resident pages, " + to_string(mapped) + " mapped");
+    }
+
+    cout << options.writers << " writers, " << options.readers << " readers: " << found << " pages found, "
+         << evicted << " evicted, " << mapped << " left mapped" << endl;
+    pageTable.displayStatistics();
+    if (failures > 0) {
+        cerr << failures << " failures" << endl;
+        return 1;
+    }
+    cout << "OK" << endl;
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    StressOptions options;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        size_t eq = arg.find('=');
+        string name = arg.substr(0, eq);
+        string value = eq == string::npos ? "" : arg.substr(eq + 1);
+        if (name == "--readers") {
+            options.readers = max(1ul, stoul(value));
+        } else if (name == "--writers") {
+            options.writers = max(1ul, stoul(value));
+        } else if (name == "--operations") {
+            options.operations = stoul(value);
+        } else {
+            cerr << "Usage: " << argv[0] << " [options]" << endl;
+            cerr << "Options:" << endl;
+            cerr << "  --readers=<n>            Threads looking pages up (default 4)" << endl;
+            cerr << "  --writers=<n>            Threads mapping and unmapping pages (default 2)" << endl;
+            cerr << "  --operations=<n>         Maps and unmaps per writer (default 1000000)" << endl;
+            return 1;
+        }
+    }
+    if (options.readers + options.writers + 2 > EpochReclaimer::MAX_READERS) {
+        cerr << "Error: at most " << EpochReclaimer::MAX_READERS - 2 << " readers and writers" << endl;
+        return 1;
+    }
+
+    errorStream = &nullStream;
+    try {
+        return runStress(options);
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,105 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdio>
+#include "../Simulator/Simulator.h"
+#include "../Simulator/Instruction.h"
+#include "../Log/Log.h"
+
+using namespace std;
+
+// Check of the copy-on-write frame accounting: a parent maps code and heap pages and forks, then both
+// write the shared heap pages and keep faulting new pages in. After every instruction each process must
+// have exactly its mapped pages and its held frames charged to its quota
+
+static ostream nullStream(nullptr);
+
+static const uint32_t PAGE_SIZE = 4096;
+static const uint32_t PROCESS_PAGES = 16;
+static const uint32_t CODE_PAGES = 8;
+static const uint32_t HEAP_PAGES = 4;
+static const uint32_t STACK_PAGES = 6;
+static const uint32_t HEAP_BASE = 0x400000; // Where generator.py places the heap, after the code segment
+
+static string accessLine(uint32_t pid, const char* command, uint32_t address) {
+    char line[64];
+    snprintf(line, sizeof(line), "%u\t%s\t0x%x", pid, command, address);
+    return line;
+}
+
+// Write every shared heap page, then push the stack down until the process fills its quota
+static void addWrites(vector<string>& trace, uint32_t pid) {
+    trace.push_back(to_string(pid) + "\tswitch\t");
+    for (uint32_t page = 0; page < HEAP_PAGES; page++) {
+        trace.push_back(accessLine(pid, "access_heap", HEAP_BASE + page * PAGE_SIZE));
+    }
+    for (uint32_t page = 0; page < STACK_PAGES; page++) {
+        trace.push_back(accessLine(pid, "access_stak", UINT32_MAX - page * PAGE_SIZE));
+    }
+}
+
+static vector<string> buildTrace() {
+    vector<string> trace;
+    trace.push_back("0\tswitch\t");
+    for (uint32_t page = 0; page < CODE_PAGES; page++) {
+        trace.push_back(accessLine(0, "access_code", page * PAGE_SIZE));
+    }
+    char alloc[64];
+    snprintf(alloc, sizeof(alloc), "0\talloc\t\t0x%x", HEAP_PAGES * PAGE_SIZE);
+    trace.push_back(alloc);
+    for (uint32_t page = 0; page < HEAP_PAGES; page++) {
+        trace.push_back(accessLine(0, "access_heap", HEAP_BASE + page * PAGE_SIZE));
+    }
+    trace.push_back("0\tfork\t\t1");
+    addWrites(trace, 1);
+    addWrites(trace, 0);
+    return trace;
+}
+
+static bool checkQuota(Simulator& simulator, const string& after) {
+    bool ok = true;
+    for (const auto& entry : simulator.getProcessTable()) {
+        const Process& process = entry.second;
+        PageTable* pageTable = process.findPageTable();
+        uint32_t held = pageTable ? pageTable->getResidentPages() : 0;
+        held += process.getAvailableFrames().size();
+        if (process.getAllocatedFrames() != held) {
+            cerr << "FAIL: after \"" << after << "\" process " << entry.first << " is charged "
+                 << process.getAllocatedFrames() << " frames and holds " << held << endl;
+            ok = false;
+        }
+    }
+    return ok;
+}
+
+int main() {
+    logStream = &nullStream;
+    errorStream = &nullStream;
+    try {
+        // Plenty of physical memory, only the quotas make the processes evict
+        Simulator simulator(32, PAGE_SIZE, 4 * PROCESS_PAGES, 8);
+        simulator.createProcess(0, PROCESS_PAGES);
+        uint32_t failures = 0;
+        for (const string& line : buildTrace()) {
+            executeInstruction(simulator, line);
+            if (!checkQuota(simulator, line)) {
+                failures++;
+            }
+        }
+        if (simulator.getProcessTable().find(1) == nullptr) {
+            cerr << "FAIL: the fork did not create process 1" << endl;
+            failures++;
+        }
+        if (failures > 0) {
+            cerr << failures << " failures" << endl;
+            return 1;
+        }
+        cout << "OK" << endl;
+        return 0;
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+}
@@ -0,0 +1,137 @@
+#include "CacheHierarchy.h"
+#include <iostream>
+#include <stdexcept>
+#include "../Log/Log.h"
+
+using namespace std;
+
+CacheHierarchy::CacheHierarchy(const vector<pair<uint64_t, uint32_t>> &levelGeometry, uint32_t lineSize, CacheInclusion inclusion)
+    : lineSize(lineSize), inclusion(inclusion)
+{
+    if (levelGeometry.empty())
+    {
+        throw invalid_argument("Cache hierarchy needs at least one level");
+    }
+    for (const auto &[size, ways] : levelGeometry)
+    {
+        levels.emplace_back(size, ways, lineSize);
+    }
+}
+
+CacheInclusion CacheHierarchy::parseInclusion(const string &name)
+{
+    if (name == "non-inclusive")
+    {
+        return CacheInclusion::NonInclusive;
+    }
+    if (name == "inclusive")
+    {
+        return CacheInclusion::Inclusive;
+    }
+    if (name == "exclusive")
+    {
+        return CacheInclusion::Exclusive;
+    }
+    throw invalid_argument("Unknown cache inclusion policy: " + name);
+}
+
+string CacheHierarchy::getInclusionName(CacheInclusion inclusion)
+{
+    switch (inclusion)
+    {
+    case CacheInclusion::Inclusive:
+        return "inclusive";
+    case CacheInclusion::Exclusive:
+        return "exclusive";
+    default:
+        return "non-inclusive";
+    }
+}
+
+uint32_t CacheHierarchy::access(uint64_t address, CacheAccessKind kind)
+{
+    uint64_t line = address / lineSize;
+    uint32_t hitLevel = levels.size();
+    for (uint32_t level = 0; level < levels.size(); level++)
+    {
+        if (levels[level].access(line, kind))
+        {
+            hitLevel = level;
+            break;
+        }
+    }
+    if (hitLevel == levels.size())
+    {
+        memoryReferences[static_cast<uint32_t>(kind)]++;
+    }
+    fill(line, hitLevel);
+    return hitLevel;
+}
+
+void CacheHierarchy::fill(uint64_t line, uint32_t hitLevel)
+{
+    uint64_t victim;
+    if (inclusion == CacheInclusion::Exclusive)
+    {
+        if (hitLevel == 0)
+        {
+            return;
+        }
+        // The line moves into L1, every level passes its victim on to the next one
+        if (hitLevel < levels.size())
+        {
+            levels[hitLevel].invalidate(line);
+        }
+        uint64_t moving = line;
+        for (CacheLevel &level : levels)
+        {
+            if (!level.insert(moving, victim))
+            {
+                break;
+            }
+            moving = victim;
+        }
+        return;
+    }
+
+    // Outer levels first, so an inclusive eviction never drops the line being filled
+    for (uint32_t level = hitLevel; level-- > 0;)
+    {
+        if (levels[level].insert(line, victim) && inclusion == CacheInclusion::Inclusive)
+        {
+            for (uint32_t inner = 0; inner < level; inner++)
+            {
+                if (levels[inner].invalidate(victim))
+                {
+                    backInvalidations++;
+                }
+            }
+        }
+    }
+}
+
+uint32_t CacheHierarchy::getPageColors(uint32_t pageSize) const
+{
+    const CacheLevel &lastLevel = levels.back();
+    uint64_t wayBytes = static_cast<uint64_t>(lastLevel.getSets()) * lineSize;
+    return wayBytes > pageSize ? static_cast<uint32_t>(wayBytes / pageSize) : 1;
+}
+
+void CacheHierarchy::displayStatistics(uint64_t pageTableBase, uint32_t pageColors, bool pageColoring) const
+{
+    *logStream << "--- Cache Statistics ---" << endl;
+    *logStream << "  Line Size: " << lineSize << " bytes, inclusion: " << getInclusionName(inclusion) << ", page colors: "
+               << pageColors << (pageColoring ? " (page coloring on)" : "") << endl;
+    for (uint32_t level = 0; level < levels.size(); level++)
+    {
+        string name = level + 1 == levels.size() && levels.size() > 1 ? "LLC" : "L" + to_string(level + 1);
+        levels[level].displayStatistics(name.c_str(), pageTableBase / lineSize);
+    }
+    *logStream << "  Memory References: " << memoryReferences[0] + memoryReferences[1] << " (data " << memoryReferences[0]
+               << ", page table " << memoryReferences[1] << ")" << endl;
+    if (inclusion == CacheInclusion::Inclusive)
+    {
+        *logStream << "  Back-Invalidations: " << backInvalidations << endl;
+    }
+    *logStream << endl;
+}
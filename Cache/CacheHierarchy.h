@@ -0,0 +1,46 @@
+#ifndef CACHEHIERARCHY_H
+#define CACHEHIERARCHY_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "helperFiles/CacheLevel.h"
+
+// How lines are kept across levels: non-inclusive fills every level on a miss and evicts independently,
+// inclusive also drops a line from the inner levels when an outer level evicts it, and exclusive keeps
+// every line in one level only, with inner victims moving out to the next level
+enum class CacheInclusion { NonInclusive, Inclusive, Exclusive };
+
+// Physically indexed cache hierarchy, L1 first and the last-level cache last, with one line size
+class CacheHierarchy
+{
+private:
+    std::vector<CacheLevel> levels;
+    uint32_t lineSize;
+    CacheInclusion inclusion;
+
+    uint64_t memoryReferences[2] = {0, 0}; // Accesses that missed every level, by CacheAccessKind
+    uint64_t backInvalidations = 0;
+
+    // Fill a line into the levels inside the one it was found in
+    void fill(uint64_t line, uint32_t hitLevel);
+
+public:
+    // Levels as (size in bytes, associativity), L1 first
+    CacheHierarchy(const std::vector<std::pair<uint64_t, uint32_t>> &levelGeometry, uint32_t lineSize, CacheInclusion inclusion);
+
+    static CacheInclusion parseInclusion(const std::string &name);
+    static std::string getInclusionName(CacheInclusion inclusion);
+
+    // Run one physical address through the hierarchy, returns the level that hit or the level count for memory
+    uint32_t access(uint64_t address, CacheAccessKind kind);
+
+    // Page-sized bins of the last-level cache: frames whose numbers differ by a multiple of this map to the same sets
+    uint32_t getPageColors(uint32_t pageSize) const;
+
+    // Statistics, pageTableBase is the physical address the page tables are placed at
+    void displayStatistics(uint64_t pageTableBase, uint32_t pageColors, bool pageColoring) const;
+};
+
+#endif // CACHEHIERARCHY_H
@@ -0,0 +1,140 @@
+#include "CacheLevel.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "../../Log/Log.h"
+
+using namespace std;
+
+CacheLevel::CacheLevel(uint64_t sizeBytes, uint32_t ways, uint32_t lineSize)
+    : sizeBytes(sizeBytes), ways(ways)
+{
+    if (ways == 0 || lineSize == 0 || sizeBytes % (static_cast<uint64_t>(ways) * lineSize) != 0 || sizeBytes < static_cast<uint64_t>(ways) * lineSize)
+    {
+        throw invalid_argument("Cache size " + to_string(sizeBytes) + " must be a multiple of " + to_string(ways) + " ways of "
+                               + to_string(lineSize) + "-byte lines");
+    }
+    sets = static_cast<uint32_t>(sizeBytes / (static_cast<uint64_t>(ways) * lineSize));
+    tags.assign(static_cast<size_t>(sets) * ways, 0);
+}
+
+uint64_t *CacheLevel::getSet(uint64_t line)
+{
+    return &tags[(line % sets) * ways];
+}
+
+void CacheLevel::recordAccess(uint64_t line, CacheAccessKind kind, bool hit)
+{
+    // A fully associative cache of the same size would have hit if the line is among its most recent lines
+    auto shadow = shadowLines.find(line);
+    bool shadowHit = shadow != shadowLines.end();
+    if (shadowHit)
+    {
+        shadowLru.splice(shadowLru.begin(), shadowLru, shadow->second);
+    }
+    else
+    {
+        shadowLru.push_front(line);
+        shadowLines[line] = shadowLru.begin();
+        if (shadowLru.size() > static_cast<size_t>(sets) * ways)
+        {
+            shadowLines.erase(shadowLru.back());
+            shadowLru.pop_back();
+        }
+    }
+
+    uint32_t index = static_cast<uint32_t>(kind);
+    if (hit)
+    {
+        hits[index]++;
+        return;
+    }
+    misses[index]++;
+    if (seenLines.insert(line).second)
+    {
+        compulsoryMisses++;
+    }
+    else if (shadowHit)
+    {
+        conflictMisses++;
+    }
+    else
+    {
+        capacityMisses++;
+    }
+}
+
+bool CacheLevel::access(uint64_t line, CacheAccessKind kind)
+{
+    uint64_t *set = getSet(line);
+    uint64_t *end = set + ways;
+    uint64_t *way = find(set, end, line + 1);
+    bool hit = way != end;
+    if (hit)
+    {
+        rotate(set, way, way + 1);
+    }
+    recordAccess(line, kind, hit);
+    return hit;
+}
+
+bool CacheLevel::insert(uint64_t line, uint64_t &victim)
+{
+    uint64_t *set = getSet(line);
+    uint64_t evicted = set[ways - 1];
+    copy_backward(set, set + ways - 1, set + ways);
+    set[0] = line + 1;
+    if (evicted == 0)
+    {
+        return false;
+    }
+    victim = evicted - 1;
+    return true;
+}
+
+bool CacheLevel::invalidate(uint64_t line)
+{
+    uint64_t *set = getSet(line);
+    uint64_t *end = set + ways;
+    uint64_t *way = find(set, end, line + 1);
+    if (way == end)
+    {
+        return false;
+    }
+    copy(way + 1, end, way);
+    set[ways - 1] = 0;
+    return true;
+}
+
+uint64_t CacheLevel::getSizeBytes() const
+{
+    return sizeBytes;
+}
+
+uint32_t CacheLevel::getWays() const
+{
+    return ways;
+}
+
+uint32_t CacheLevel::getSets() const
+{
+    return sets;
+}
+
+uint64_t CacheLevel::countLinesFrom(uint64_t firstLine) const
+{
+    return count_if(tags.begin(), tags.end(), [firstLine](uint64_t tag) { return tag != 0 && tag - 1 >= firstLine; });
+}
+
+void CacheLevel::displayStatistics(const char *name, uint64_t firstPageTableLine) const
+{
+    auto missRate = [](uint64_t hitCount, uint64_t missCount) {
+        return hitCount + missCount > 0 ? static_cast<double>(missCount) / (hitCount + missCount) * 100 : 0.0;
+    };
+    *logStream << "  " << name << ": " << sizeBytes << " bytes, " << ways << "-way, " << sets << " sets" << endl;
+    *logStream << "    Data: " << hits[0] << " hits, " << misses[0] << " misses (" << missRate(hits[0], misses[0]) << "% miss rate)" << endl;
+    *logStream << "    Page Table: " << hits[1] << " hits, " << misses[1] << " misses (" << missRate(hits[1], misses[1]) << "% miss rate)" << endl;
+    *logStream << "    Misses: compulsory " << compulsoryMisses << ", capacity " << capacityMisses << ", conflict " << conflictMisses << endl;
+    *logStream << "    Page Table Lines Resident: " << countLinesFrom(firstPageTableLine) << " of " << tags.size() << endl;
+}
@@ -0,0 +1,61 @@
+#ifndef CACHELEVEL_H
+#define CACHELEVEL_H
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Kind of reference reaching the caches: translated data accesses or PTE fetches of a page walk
+enum class CacheAccessKind { Data, PageTable };
+
+// One set-associative cache level with LRU replacement. The tag array is a flat vector holding the
+// line address plus one of every way (0 for an empty way), each set ordered most recently used first.
+// A fully associative LRU shadow of the same capacity classifies misses as compulsory, capacity or conflict
+class CacheLevel
+{
+private:
+    uint64_t sizeBytes;
+    uint32_t ways;
+    uint32_t sets;
+    std::vector<uint64_t> tags;
+
+    // Shadow cache for the miss classification
+    std::list<uint64_t> shadowLru;
+    std::unordered_map<uint64_t, std::list<uint64_t>::iterator> shadowLines;
+    std::unordered_set<uint64_t> seenLines;
+
+    uint64_t hits[2] = {0, 0};   // By CacheAccessKind
+    uint64_t misses[2] = {0, 0};
+    uint64_t compulsoryMisses = 0;
+    uint64_t capacityMisses = 0;
+    uint64_t conflictMisses = 0;
+
+    uint64_t *getSet(uint64_t line);
+    // Run the access through the shadow cache and classify it if it missed here
+    void recordAccess(uint64_t line, CacheAccessKind kind, bool hit);
+
+public:
+    CacheLevel(uint64_t sizeBytes, uint32_t ways, uint32_t lineSize);
+
+    // Look a line up and make it the most recently used of its set, returns true on a hit
+    bool access(uint64_t line, CacheAccessKind kind);
+
+    // Insert a line that is not cached, returns true and sets victim if a valid line was evicted
+    bool insert(uint64_t line, uint64_t &victim);
+
+    // Drop a line, returns true if it was cached
+    bool invalidate(uint64_t line);
+
+    uint64_t getSizeBytes() const;
+    uint32_t getWays() const;
+    uint32_t getSets() const;
+
+    // Number of cached lines at or above a line address, e.g. the page table region
+    uint64_t countLinesFrom(uint64_t firstLine) const;
+
+    void displayStatistics(const char *name, uint64_t firstPageTableLine) const;
+};
+
+#endif // CACHELEVEL_H
@@ -0,0 +1,111 @@
+#include "Checkpoint.h"
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char CHECKPOINT_MAGIC[8] = {'V', 'M', 'S', 'I', 'M', 'C', 'K', 'P'};
+static const uint32_t CHECKPOINT_VERSION = 4;
+static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+static const uint32_t SECTION_COUNT = static_cast<uint32_t>(CheckpointSection::Count);
+
+static uint64_t alignSection(uint64_t offset)
+{
+    return (offset + 7) & ~static_cast<uint64_t>(7);
+}
+
+CheckpointWriter::CheckpointWriter()
+    : sections(SECTION_COUNT), counts(SECTION_COUNT, 0), recordSizes(SECTION_COUNT, 0)
+{
+}
+
+void CheckpointWriter::write(const string &path, CheckpointHeader header) const
+{
+    memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    header.version = CHECKPOINT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    uint64_t offset = alignSection(sizeof(CheckpointHeader));
+    for (uint32_t i = 0; i < SECTION_COUNT; i++)
+    {
+        header.sections[i] = {offset, counts[i], recordSizes[i], 0};
+        offset = alignSection(offset + sections[i].size());
+    }
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out)
+    {
+        throw runtime_error("Cannot open checkpoint file " + path);
+    }
+    static const char padding[8] = {};
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    out.write(padding, alignSection(sizeof(header)) - sizeof(header));
+    for (const vector<char> &section : sections)
+    {
+        out.write(section.data(), section.size());
+        out.write(padding, alignSection(section.size()) - section.size());
+    }
+    if (!out)
+    {
+        throw runtime_error("Cannot write checkpoint file " + path);
+    }
+}
+
+CheckpointReader::CheckpointReader(const string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("Cannot open checkpoint file " + path);
+    }
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(CheckpointHeader))
+    {
+        close(fd);
+        throw runtime_error("Checkpoint file " + path + " is too short");
+    }
+    size = status.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        throw runtime_error("Cannot map checkpoint file " + path);
+    }
+    data = static_cast<const char *>(mapping);
+    header = reinterpret_cast<const CheckpointHeader *>(data);
+
+    string problem;
+    if (memcmp(header->magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0)
+    {
+        problem = "is not a checkpoint";
+    }
+    else if (header->version != CHECKPOINT_VERSION || header->byteOrder != BYTE_ORDER_MARK)
+    {
+        problem = "was written by another version or on a machine with another byte order";
+    }
+    for (uint32_t i = 0; problem.empty() && i < SECTION_COUNT; i++)
+    {
+        const CheckpointSectionEntry &entry = header->sections[i];
+        if (entry.offset > size || entry.count * entry.recordSize > size - entry.offset)
+        {
+            problem = "is truncated";
+        }
+    }
+    if (!problem.empty())
+    {
+        munmap(const_cast<char *>(data), size);
+        throw runtime_error("Checkpoint file " + path + " " + problem);
+    }
+}
+
+CheckpointReader::~CheckpointReader()
+{
+    munmap(const_cast<char *>(data), size);
+}
+
+const CheckpointHeader &CheckpointReader::getHeader() const
+{
+    return *header;
+}
@@ -0,0 +1,208 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Snapshot file layout: a fixed header with a table of sections, then the sections, each an array of
+// fixed-size records starting at an 8-byte boundary. Restoring maps the file and reads the records in
+// place, without parsing. Records are in host byte order, the header's byte order mark rejects others
+enum class CheckpointSection : uint32_t
+{
+    Simulator,         // One SimulatorRecord
+    Processes,         // ProcessRecord per process, by pid
+    PageTableEntries,  // Every process's stored entries, valid or not
+    ClockPages,        // Every process's resident VPNs in clock order
+    ProcessFrames,     // Frames every process holds but has not mapped, in allocation order
+    FreePools,         // FreePoolRecord per frame pool
+    FreeFrames,        // Every pool's free frames in allocation order
+    FrameOwners,       // Owner keys of every mapped frame, first owner first
+    TlbEntries,        // Entries of the TLB
+    SwapPages,         // Keys of the pages in the swap file
+    CodePages,         // Shared code page cache
+    Count
+};
+
+struct CheckpointSectionEntry
+{
+    uint64_t offset;
+    uint64_t count;
+    uint32_t recordSize;
+    uint32_t reserved;
+};
+
+struct CheckpointHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t instruction; // Trace instructions replayed when the snapshot was taken
+    uint32_t pageSize;
+    uint32_t addressBits;
+    uint32_t physicalFrames;
+    uint32_t tlbSize;
+    uint64_t traceHash; // Of the trace lines replayed, to check a restore replays the same trace
+    CheckpointSectionEntry sections[static_cast<uint32_t>(CheckpointSection::Count)];
+};
+
+struct SimulatorRecord
+{
+    uint32_t currentProcessId;
+    uint32_t forks;
+    uint32_t accessesSinceKswapd;
+    uint32_t reclaimCursor;
+    uint32_t directReclaimStalls;
+    uint32_t directReclaimedPages;
+    uint32_t localReplacements;
+    uint32_t backgroundReclaimRuns;
+    uint32_t backgroundReclaimedPages;
+    uint32_t exits; // Reserved and zero before exits existed, which reads the same
+    uint64_t minorFaults;
+    uint64_t poolFaults;
+    uint64_t majorFaults;
+    uint64_t cowCopies;
+    uint64_t cowReuses;
+    uint64_t sharedCodeFaults;
+    uint64_t protectionFaults;
+    uint64_t swapPagesWritten;
+    uint64_t swapPagesRead;
+    uint64_t rangeFrees;
+    uint64_t unmappedPages;
+    uint64_t rangeFlushes;
+    // Counters of the processes that have exited
+    uint64_t exitedAccesses;
+    uint64_t exitedTlbHits;
+    uint64_t exitedTlbMisses;
+    uint64_t exitedPageTableHits;
+    uint64_t exitedPageFaults;
+    uint64_t exitedEvictions;
+};
+
+struct ProcessRecord
+{
+    uint32_t pid;
+    uint32_t maxFrames;
+    uint32_t allocatedFrames;
+    uint32_t tlbHits;
+    uint32_t tlbMisses;
+    uint32_t pageTableHits;
+    uint32_t pageTableMisses;
+    uint32_t memoryAccessAttempts;
+    uint32_t directReclaimStalls;
+    uint32_t evictions;
+    uint32_t level1Entries;
+    uint32_t level2Entries;
+    uint32_t clockHand; // Index of the hand in the clock list
+    uint32_t entryCount;
+    uint32_t clockPageCount;
+    uint32_t frameCount;
+    uint32_t heapSize;
+    uint32_t reserved;
+};
+
+struct PageTableEntryRecord
+{
+    uint32_t vpn;
+    uint32_t reserved;
+    uint64_t bits; // The packed PageTableEntry
+};
+
+// Permission flags of a TLB entry record
+const uint8_t PTE_VALID = 1;
+const uint8_t PTE_READ = 2;
+const uint8_t PTE_WRITE = 4;
+const uint8_t PTE_EXECUTE = 8;
+
+struct FreePoolRecord
+{
+    uint32_t firstFrame;
+    uint32_t freeCount;
+};
+
+struct FrameOwnerRecord
+{
+    uint32_t frame;
+    uint32_t reserved;
+    uint64_t owner;
+};
+
+struct TlbEntryRecord
+{
+    uint32_t vpn;
+    uint32_t pfn;
+    uint8_t flags; // PTE_VALID, PTE_READ, PTE_WRITE and PTE_EXECUTE
+    uint8_t reserved[7];
+    int64_t lastAccessTime;
+};
+
+struct CodePageRecord
+{
+    uint32_t vpn;
+    uint32_t frame;
+};
+
+// Collects the sections of a snapshot and writes them out in one go
+class CheckpointWriter
+{
+private:
+    std::vector<std::vector<char>> sections;
+    std::vector<uint64_t> counts;
+    std::vector<uint32_t> recordSizes;
+
+public:
+    CheckpointWriter();
+
+    template <typename Record>
+    void add(CheckpointSection section, const std::vector<Record> &records)
+    {
+        uint32_t index = static_cast<uint32_t>(section);
+        sections[index].resize(records.size() * sizeof(Record));
+        if (!records.empty())
+        {
+            std::memcpy(sections[index].data(), records.data(), sections[index].size());
+        }
+        counts[index] = records.size();
+        recordSizes[index] = sizeof(Record);
+    }
+
+    // Fill in the magic, version and section table of the header and write the file
+    void write(const std::string &path, CheckpointHeader header) const;
+};
+
+// A snapshot file mapped read-only into memory
+class CheckpointReader
+{
+private:
+    const char *data = nullptr;
+    std::size_t size = 0;
+    const CheckpointHeader *header = nullptr;
+
+public:
+    explicit CheckpointReader(const std::string &path);
+    ~CheckpointReader();
+
+    CheckpointReader(const CheckpointReader &) = delete;
+    CheckpointReader &operator=(const CheckpointReader &) = delete;
+
+    const CheckpointHeader &getHeader() const;
+
+    // The records of a section, checked against the record size they were written with
+    template <typename Record>
+    const Record *get(CheckpointSection section, std::size_t &count) const
+    {
+        const CheckpointSectionEntry &entry = header->sections[static_cast<uint32_t>(section)];
+        if (entry.count > 0 && entry.recordSize != sizeof(Record))
+        {
+            throw std::runtime_error("Checkpoint section " + std::to_string(static_cast<uint32_t>(section)) + " has records of " +
+                                     std::to_string(entry.recordSize) + " bytes, expected " + std::to_string(sizeof(Record)));
+        }
+        count = entry.count;
+        return reinterpret_cast<const Record *>(data + entry.offset);
+    }
+};
+
+#endif // CHECKPOINT_H
@@ -0,0 +1,199 @@
+#include "CostModel.h"
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include "../Log/Log.h"
+
+using namespace std;
+
+static const char *const EVENT_NAMES[] = {"TLB lookup", "walk reference", "memory", "minor fault",
+                                          "compressed pool", "major fault", "write-back"};
+
+CostModel::CostModel(const vector<uint32_t> &eventCosts)
+{
+    if (eventCosts.size() != EVENT_COUNT)
+    {
+        throw invalid_argument("Cycle costs must be given as <tlb_lookup>:<walk_reference>:<memory>:<minor_fault>:"
+                               "<compressed_pool>:<major_fault>:<write_back>");
+    }
+    for (uint32_t event = 0; event < EVENT_COUNT; event++)
+    {
+        costs[event] = eventCosts[event];
+    }
+}
+
+vector<uint32_t> CostModel::getDefaultCosts()
+{
+    return {1, 100, 100, 2000, 10000, 300000, 300000};
+}
+
+void CostModel::beginAccess()
+{
+    inAccess = true;
+    accessCycles = 0;
+    accessOverhead = 0;
+}
+
+void CostModel::charge(CostEvent event, uint32_t count)
+{
+    if (!inAccess)
+    {
+        return;
+    }
+    uint32_t index = static_cast<uint32_t>(event);
+    uint64_t cycles = costs[index] * count;
+    eventCounts[index] += count;
+    accessCycles += cycles;
+    if (event != CostEvent::MemoryAccess)
+    {
+        accessOverhead += cycles;
+    }
+}
+
+void CostModel::endAccess(uint32_t pid, uint32_t accessType)
+{
+    ProcessCosts &process = processCosts[pid];
+    process.accessTypes[accessType].record(accessCycles);
+    process.overheadCycles += accessOverhead;
+    totalCycles += accessCycles;
+    inAccess = false;
+}
+
+void CostModel::cancelAccess()
+{
+    inAccess = false;
+}
+
+void CostModel::removeProcess(uint32_t pid)
+{
+    auto process = processCosts.find(pid);
+    if (process == processCosts.end())
+    {
+        return;
+    }
+    add(exitedCosts, process->second);
+    exitedProcesses++;
+    processCosts.erase(process);
+}
+
+void CostModel::add(ProcessCosts &into, const ProcessCosts &from)
+{
+    for (uint32_t type = 0; type < ACCESS_TYPES; type++)
+    {
+        into.accessTypes[type].merge(from.accessTypes[type]);
+    }
+    into.overheadCycles += from.overheadCycles;
+}
+
+void CostModel::merge(const CostModel &other)
+{
+    for (uint32_t event = 0; event < EVENT_COUNT; event++)
+    {
+        eventCounts[event] += other.eventCounts[event];
+    }
+    totalCycles += other.totalCycles;
+    for (const auto &[pid, costsOfOther] : other.processCosts)
+    {
+        add(processCosts[pid], costsOfOther);
+    }
+    add(exitedCosts, other.exitedCosts);
+    exitedProcesses += other.exitedProcesses;
+}
+
+uint64_t CostModel::getTotalCycles() const
+{
+    return totalCycles;
+}
+
+uint64_t CostModel::getProcessCycles(uint32_t pid) const
+{
+    auto process = processCosts.find(pid);
+    if (process == processCosts.end())
+    {
+        return 0;
+    }
+    uint64_t cycles = 0;
+    for (const LatencyHistogram &histogram : process->second.accessTypes)
+    {
+        cycles += histogram.getTotal();
+    }
+    return cycles;
+}
+
+string CostModel::describe(const LatencyHistogram &histogram)
+{
+    ostringstream oss;
+    oss << histogram.getCount() << " accesses, AMAT " << histogram.getMean() << " cycles (p50 " << histogram.getPercentile(0.5)
+        << ", p90 " << histogram.getPercentile(0.9) << ", p99 " << histogram.getPercentile(0.99) << ", p99.9 "
+        << histogram.getPercentile(0.999) << ", max " << histogram.getMax() << ")";
+    return oss.str();
+}
+
+void CostModel::displayStatistics(const vector<string> &accessTypeNames) const
+{
+    ProcessCosts total = exitedCosts;
+    for (const auto &[pid, process] : processCosts)
+    {
+        add(total, process);
+    }
+    LatencyHistogram all;
+    for (const LatencyHistogram &histogram : total.accessTypes)
+    {
+        all.merge(histogram);
+    }
+    const array<LatencyHistogram, ACCESS_TYPES> &byType = total.accessTypes;
+    uint64_t overhead = total.overheadCycles;
+
+    *logStream << "--- Access Cost Statistics ---" << endl;
+    *logStream << "  Cycle Costs:";
+    for (uint32_t event = 0; event < EVENT_COUNT; event++)
+    {
+        *logStream << (event > 0 ? ", " : " ") << EVENT_NAMES[event] << " " << costs[event];
+    }
+    *logStream << endl;
+    *logStream << "  Events:";
+    for (uint32_t event = 0; event < EVENT_COUNT; event++)
+    {
+        *logStream << (event > 0 ? ", " : " ") << EVENT_NAMES[event] << " " << eventCounts[event];
+    }
+    *logStream << endl;
+    *logStream << "  All: " << describe(all) << endl;
+    *logStream << "  Translation Overhead: " << overhead << " cycles, "
+               << (all.getTotal() > 0 ? static_cast<double>(overhead) / all.getTotal() * 100 : 0.0) << "% of all cycles" << endl;
+    for (uint32_t type = 0; type < ACCESS_TYPES; type++)
+    {
+        if (byType[type].getCount() > 0)
+        {
+            *logStream << "  " << accessTypeNames[type] << ": " << describe(byType[type]) << endl;
+        }
+    }
+
+    for (const auto &[pid, process] : processCosts)
+    {
+        LatencyHistogram processAll;
+        for (const LatencyHistogram &histogram : process.accessTypes)
+        {
+            processAll.merge(histogram);
+        }
+        *logStream << "  Process " << pid << ": " << describe(processAll) << ", translation overhead " << process.overheadCycles
+                   << " cycles" << endl;
+        for (uint32_t type = 0; type < ACCESS_TYPES; type++)
+        {
+            if (process.accessTypes[type].getCount() > 0)
+            {
+                *logStream << "    " << accessTypeNames[type] << ": " << describe(process.accessTypes[type]) << endl;
+            }
+        }
+    }
+    if (exitedProcesses > 0)
+    {
+        LatencyHistogram exitedAll;
+        for (const LatencyHistogram &histogram : exitedCosts.accessTypes)
+        {
+            exitedAll.merge(histogram);
+        }
+        *logStream << "  Exited Processes (" << exitedProcesses << "): " << describe(exitedAll) << ", translation overhead "
+                   << exitedCosts.overheadCycles << " cycles" << endl;
+    }
+    *logStream << endl;
+}
@@ -0,0 +1,67 @@
+#ifndef COSTMODEL_H
+#define COSTMODEL_H
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "helperFiles/LatencyHistogram.h"
+
+// Events on the path of a memory access that cost cycles
+enum class CostEvent { TlbLookup, WalkReference, MemoryAccess, MinorFault, CompressedPool, MajorFault, WriteBack };
+
+// Cycle cost model: every access adds up the cycles of the events on its path, and the totals are kept
+// per process and per access type to report the average memory access time and its tail
+class CostModel
+{
+public:
+    static const uint32_t EVENT_COUNT = 7;
+    static const uint32_t ACCESS_TYPES = 3;
+
+private:
+    std::array<uint64_t, EVENT_COUNT> costs;
+    std::array<uint64_t, EVENT_COUNT> eventCounts{};
+
+    // The access being translated, events outside an access (e.g. background reclaim) cost nothing
+    bool inAccess = false;
+    uint64_t accessCycles = 0;
+    uint64_t accessOverhead = 0; // Everything but the data reference itself
+    uint64_t totalCycles = 0;    // Cycles of all recorded accesses, the simulated time
+
+    struct ProcessCosts
+    {
+        std::array<LatencyHistogram, ACCESS_TYPES> accessTypes;
+        uint64_t overheadCycles = 0;
+    };
+    std::map<uint32_t, ProcessCosts> processCosts;
+    ProcessCosts exitedCosts; // Of the processes that have exited, added up
+    uint32_t exitedProcesses = 0;
+
+    static void add(ProcessCosts &into, const ProcessCosts &from);
+    static std::string describe(const LatencyHistogram &histogram);
+
+public:
+    // Costs in cycles, in CostEvent order
+    explicit CostModel(const std::vector<uint32_t> &costs);
+
+    static std::vector<uint32_t> getDefaultCosts();
+
+    void beginAccess();
+    void charge(CostEvent event, uint32_t count = 1);
+    // Record the access for a process and access type, an access that failed is dropped instead
+    void endAccess(uint32_t pid, uint32_t accessType);
+    void cancelAccess();
+    // Move the costs of a process that exits to those of the exited processes
+    void removeProcess(uint32_t pid);
+
+    // Add the accesses recorded by another model, e.g. a parallel replay worker
+    void merge(const CostModel &other);
+
+    uint64_t getTotalCycles() const;
+    uint64_t getProcessCycles(uint32_t pid) const;
+
+    void displayStatistics(const std::vector<std::string> &accessTypeNames) const;
+};
+
+#endif // COSTMODEL_H
@@ -0,0 +1,95 @@
+#include "LatencyHistogram.h"
+#include <algorithm>
+
+using namespace std;
+
+uint32_t LatencyHistogram::bucketIndex(uint64_t value)
+{
+    if (value < SUB_BUCKETS)
+    {
+        return static_cast<uint32_t>(value);
+    }
+    int highestBit = 63 - __builtin_clzll(value);
+    int shift = highestBit - SUB_BUCKET_BITS;
+    uint64_t subBucket = (value >> shift) & (SUB_BUCKETS - 1);
+    return static_cast<uint32_t>((shift + 1) * SUB_BUCKETS + subBucket);
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(uint32_t index)
+{
+    if (index < SUB_BUCKETS)
+    {
+        return index;
+    }
+    int shift = static_cast<int>(index / SUB_BUCKETS) - 1;
+    uint64_t subBucket = index % SUB_BUCKETS;
+    uint64_t lowerBound = (SUB_BUCKETS | subBucket) << shift;
+    return lowerBound + ((1ULL << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t value)
+{
+    uint32_t index = bucketIndex(value);
+    if (index >= buckets.size())
+    {
+        buckets.resize(index + 1, 0);
+    }
+    buckets[index]++;
+    count++;
+    total += value;
+    maxValue = max(maxValue, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    if (other.buckets.size() > buckets.size())
+    {
+        buckets.resize(other.buckets.size(), 0);
+    }
+    for (size_t i = 0; i < other.buckets.size(); i++)
+    {
+        buckets[i] += other.buckets[i];
+    }
+    count += other.count;
+    total += other.total;
+    maxValue = max(maxValue, other.maxValue);
+}
+
+uint64_t LatencyHistogram::getCount() const
+{
+    return count;
+}
+
+uint64_t LatencyHistogram::getTotal() const
+{
+    return total;
+}
+
+uint64_t LatencyHistogram::getMax() const
+{
+    return maxValue;
+}
+
+double LatencyHistogram::getMean() const
+{
+    return count > 0 ? static_cast<double>(total) / count : 0.0;
+}
+
+uint64_t LatencyHistogram::getPercentile(double p) const
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    uint64_t rank = max<uint64_t>(1, static_cast<uint64_t>(p * count + 0.5));
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < buckets.size(); i++)
+    {
+        seen += buckets[i];
+        if (seen >= rank)
+        {
+            return min(bucketUpperBound(i), maxValue);
+        }
+    }
+    return maxValue;
+}
@@ -0,0 +1,36 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+// Log-linear histogram of latencies: values below 16 are counted exactly, larger values in 16 buckets
+// per power of two, so percentiles are accurate to about 6% over the full 64-bit range
+class LatencyHistogram
+{
+private:
+    static const int SUB_BUCKET_BITS = 4;
+    static const uint64_t SUB_BUCKETS = 1ULL << SUB_BUCKET_BITS;
+
+    std::vector<uint64_t> buckets;
+    uint64_t count = 0;
+    uint64_t total = 0;
+    uint64_t maxValue = 0;
+
+    static uint32_t bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(uint32_t index);
+
+public:
+    void record(uint64_t value);
+    void merge(const LatencyHistogram &other);
+
+    uint64_t getCount() const;
+    uint64_t getTotal() const;
+    uint64_t getMax() const;
+    double getMean() const;
+
+    // Smallest bucket bound at or below which a share p (0 to 1) of the values fall
+    uint64_t getPercentile(double p) const;
+};
+
+#endif // LATENCYHISTOGRAM_H
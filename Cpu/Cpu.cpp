@@ -0,0 +1,102 @@
+#include "Cpu.h"
+#include <iostream>
+#include "../Log/Log.h"
+
+using namespace std;
+
+Cpu::Cpu(uint32_t id, uint32_t tlbSize, shared_ptr<NodeArena> arena) : id(id), tlb(tlbSize, arena), currentProcessId(-1)
+{
+}
+
+uint32_t Cpu::getId() const
+{
+    return id;
+}
+
+TLB &Cpu::getTLB()
+{
+    return tlb;
+}
+
+uint32_t Cpu::getCurrentProcess() const
+{
+    return currentProcessId;
+}
+
+void Cpu::switchProcess(uint32_t pid)
+{
+    currentProcessId = pid;
+    tlb.flush();
+}
+
+void Cpu::recordInstruction()
+{
+    instructions++;
+}
+
+void Cpu::queueInvalidation(uint32_t pid, uint32_t vpn, uint32_t ceiling)
+{
+    if (pendingFlush)
+    {
+        return;
+    }
+    pendingInvalidations.emplace_back(pid, vpn);
+    if (pendingInvalidations.size() > ceiling)
+    {
+        queueFlush();
+    }
+}
+
+void Cpu::queueFlush()
+{
+    pendingFlush = true;
+    pendingInvalidations.clear();
+}
+
+bool Cpu::hasPendingInvalidations() const
+{
+    return pendingFlush || !pendingInvalidations.empty();
+}
+
+uint32_t Cpu::handleShootdown(uint32_t handlerCost)
+{
+    uint32_t dropped = 0;
+    ipisReceived++;
+    handlerCycles += handlerCost;
+    if (pendingFlush)
+    {
+        dropped = tlb.entries.size();
+        tlb.flush();
+        fullFlushes++;
+    }
+    else
+    {
+        for (const auto &[pid, vpn] : pendingInvalidations)
+        {
+            // The core may have been told about a process it no longer runs, then there is nothing to drop
+            if (pid == currentProcessId && tlb.entries.count(vpn) > 0)
+            {
+                tlb.deleteTLB(vpn);
+                dropped++;
+            }
+        }
+    }
+    entriesInvalidated += dropped;
+    pendingInvalidations.clear();
+    pendingFlush = false;
+    return dropped;
+}
+
+void Cpu::recordIpiSent(uint32_t initiatorCost)
+{
+    ipisSent++;
+    initiatorCycles += initiatorCost;
+}
+
+void Cpu::displayStatistics() const
+{
+    *logStream << "  CPU " << id << ": " << instructions << " instructions, " << ipisSent << " shootdown IPIs sent, "
+         << ipisReceived << " received, " << entriesInvalidated << " entries invalidated, " << fullFlushes << " full flushes" << endl;
+    *logStream << "    Shootdown Cycles: " << initiatorCycles + handlerCycles << " (initiator: " << initiatorCycles
+         << ", handler: " << handlerCycles << ")" << endl;
+}
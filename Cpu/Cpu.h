@@ -0,0 +1,53 @@
+#ifndef CPU_H
+#define CPU_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include "../TLB/TLB.h"
+
+// A simulated core: its own TLB, the process it runs and its share of TLB shootdown work
+class Cpu
+{
+private:
+    uint32_t id;
+    TLB tlb;
+    uint32_t currentProcessId;
+
+    // Invalidations waiting for the next batched shootdown IPI, as (pid, VPN) pairs
+    std::vector<std::pair<uint32_t, uint32_t>> pendingInvalidations;
+    bool pendingFlush = false; // Too many pending pages, the whole TLB is flushed instead
+
+    uint64_t instructions = 0;
+    uint64_t ipisSent = 0;
+    uint64_t ipisReceived = 0;
+    uint64_t entriesInvalidated = 0; // TLB entries dropped on behalf of other cores
+    uint64_t fullFlushes = 0;
+    uint64_t initiatorCycles = 0;    // Cycles spent sending IPIs and waiting for their acknowledgement
+    uint64_t handlerCycles = 0;      // Cycles spent in the shootdown interrupt handler
+
+public:
+    // The TLB's entries come from arena, or from the heap without one
+    Cpu(uint32_t id, uint32_t tlbSize, std::shared_ptr<NodeArena> arena = nullptr);
+
+    uint32_t getId() const;
+    TLB &getTLB();
+    uint32_t getCurrentProcess() const;
+
+    // Run another process, its translations are not in the TLB yet
+    void switchProcess(uint32_t pid);
+    void recordInstruction();
+
+    // Queue an invalidation, falling back to a full flush once more than ceiling pages are pending
+    void queueInvalidation(uint32_t pid, uint32_t vpn, uint32_t ceiling);
+    void queueFlush();
+    bool hasPendingInvalidations() const;
+
+    // Shootdown IPI: drop the pending entries of the running process and return the number dropped
+    uint32_t handleShootdown(uint32_t handlerCost);
+    void recordIpiSent(uint32_t initiatorCost);
+
+    void displayStatistics() const;
+};
+
+#endif // CPU_H
@@ -0,0 +1,165 @@
+#include "TlbShootdown.h"
+#include <iostream>
+#include "../Log/Log.h"
+
+using namespace std;
+
+TlbShootdown::TlbShootdown(uint32_t batchCeiling, bool lazy, uint32_t initiatorCost, uint32_t handlerCost)
+    : batchCeiling(batchCeiling), lazy(lazy), initiatorCost(initiatorCost), handlerCost(handlerCost)
+{
+}
+
+void TlbShootdown::recordSwitch(uint32_t cpu, uint32_t pid)
+{
+    processCpuMasks[pid] |= 1ull << cpu;
+}
+
+void TlbShootdown::removeProcess(uint32_t pid)
+{
+    processCpuMasks.erase(pid);
+}
+
+// Cores other than the initiator that need an IPI for a process
+vector<uint32_t> TlbShootdown::getRemoteCpus(const vector<Cpu> &cpus, uint32_t initiator, uint32_t pid)
+{
+    vector<uint32_t> remote;
+    uint64_t &mask = processCpuMasks[pid];
+    for (uint32_t cpu = 0; cpu < cpus.size(); cpu++)
+    {
+        if (cpu == initiator || (mask & (1ull << cpu)) == 0)
+        {
+            continue;
+        }
+        if (lazy && cpus[cpu].getCurrentProcess() != pid)
+        {
+            // Nothing of this process is left in that TLB, the core leaves the mask until it runs the process again
+            mask &= ~(1ull << cpu);
+            skippedLazyCpus++;
+            continue;
+        }
+        remote.push_back(cpu);
+    }
+    return remote;
+}
+
+void TlbShootdown::sendIpi(Cpu &initiator, Cpu &target)
+{
+    initiator.recordIpiSent(initiatorCost);
+    target.handleShootdown(handlerCost);
+}
+
+bool TlbShootdown::invalidatePage(vector<Cpu> &cpus, uint32_t initiator, uint32_t pid, uint32_t vpn)
+{
+    invalidations++;
+    bool running = false;
+    if (cpus[initiator].getCurrentProcess() == pid)
+    {
+        cpus[initiator].getTLB().deleteTLB(vpn);
+        running = true;
+    }
+    for (uint32_t cpu : getRemoteCpus(cpus, initiator, pid))
+    {
+        running = running || cpus[cpu].getCurrentProcess() == pid;
+        if (batchCeiling == 0)
+        {
+            cpus[cpu].queueInvalidation(pid, vpn, UINT32_MAX);
+            sendIpi(cpus[initiator], cpus[cpu]);
+        }
+        else
+        {
+            cpus[cpu].queueInvalidation(pid, vpn, batchCeiling);
+        }
+    }
+    return running;
+}
+
+void TlbShootdown::invalidateProcess(vector<Cpu> &cpus, uint32_t initiator, uint32_t pid)
+{
+    invalidations++;
+    if (cpus[initiator].getCurrentProcess() == pid)
+    {
+        cpus[initiator].getTLB().flush();
+    }
+    for (uint32_t cpu : getRemoteCpus(cpus, initiator, pid))
+    {
+        cpus[cpu].queueFlush();
+        if (batchCeiling == 0)
+        {
+            sendIpi(cpus[initiator], cpus[cpu]);
+        }
+    }
+}
+
+void TlbShootdown::invalidateRange(vector<Cpu> &cpus, uint32_t initiator, uint32_t pid, const vector<uint32_t> &vpns,
+                                   uint32_t flushCeiling)
+{
+    if (vpns.empty())
+    {
+        return;
+    }
+    invalidations += vpns.size();
+    bool flush = vpns.size() > flushCeiling;
+    if (cpus[initiator].getCurrentProcess() == pid)
+    {
+        TLB &tlb = cpus[initiator].getTLB();
+        if (flush)
+        {
+            tlb.flush();
+        }
+        else
+        {
+            for (uint32_t vpn : vpns)
+            {
+                tlb.deleteTLB(vpn);
+            }
+        }
+    }
+    for (uint32_t cpu : getRemoteCpus(cpus, initiator, pid))
+    {
+        if (flush)
+        {
+            cpus[cpu].queueFlush();
+        }
+        else
+        {
+            for (uint32_t vpn : vpns)
+            {
+                cpus[cpu].queueInvalidation(pid, vpn, batchCeiling == 0 ? UINT32_MAX : batchCeiling);
+            }
+        }
+        // Unbatched, the whole range still takes a single IPI
+        if (batchCeiling == 0)
+        {
+            sendIpi(cpus[initiator], cpus[cpu]);
+        }
+    }
+}
+
+void TlbShootdown::flushBatches(vector<Cpu> &cpus, uint32_t initiator)
+{
+    for (Cpu &cpu : cpus)
+    {
+        if (cpu.hasPendingInvalidations())
+        {
+            sendIpi(cpus[initiator], cpu);
+        }
+    }
+}
+
+void TlbShootdown::displayStatistics(const vector<Cpu> &cpus) const
+{
+    *logStream << "--- CPU Statistics ---" << endl;
+    *logStream << "  TLB Shootdown Mode: " << (batchCeiling == 0 ? "one IPI per page" : "batched, full flush above " + to_string(batchCeiling) + " pages")
+         << (lazy ? ", lazy" : "") << endl;
+    *logStream << "  Shootdown Cost: " << initiatorCost << " cycles to send, " << handlerCost << " cycles to handle" << endl;
+    for (const Cpu &cpu : cpus)
+    {
+        cpu.displayStatistics();
+    }
+    *logStream << "  Translations Invalidated: " << invalidations << endl;
+    if (lazy)
+    {
+        *logStream << "  IPIs Skipped by Lazy Invalidation: " << skippedLazyCpus << endl;
+    }
+    *logStream << endl;
+}
@@ -0,0 +1,56 @@
+#ifndef TLBSHOOTDOWN_H
+#define TLBSHOOTDOWN_H
+
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "Cpu.h"
+
+// Keeps the TLBs of all cores coherent when a translation is removed or changed.
+// Every process has a mask of the cores that may cache its translations, set when a core switches to it.
+// Remote cores are reached by IPI, either one per invalidation or one per core and operation when batching.
+class TlbShootdown
+{
+private:
+    uint32_t batchCeiling; // 0 sends one IPI per invalidation, otherwise pages per batch before a full flush
+    bool lazy;             // Skip cores that switched away from the process, their TLB was flushed on the switch
+    uint32_t initiatorCost; // Cycles to send an IPI and wait for the acknowledgement
+    uint32_t handlerCost;   // Cycles the target core spends in the interrupt handler
+
+    std::unordered_map<uint32_t, uint64_t> processCpuMasks; // Bit per core, by pid
+
+    uint64_t invalidations = 0;   // Translations removed or changed
+    uint64_t skippedLazyCpus = 0; // IPIs avoided by lazy invalidation
+
+    std::vector<uint32_t> getRemoteCpus(const std::vector<Cpu> &cpus, uint32_t initiator, uint32_t pid);
+    void sendIpi(Cpu &initiator, Cpu &target);
+
+public:
+    static const uint32_t MAX_CPUS = 64;
+
+    TlbShootdown(uint32_t batchCeiling, bool lazy, uint32_t initiatorCost, uint32_t handlerCost);
+
+    void recordSwitch(uint32_t cpu, uint32_t pid);
+
+    // Invalidate one page of a process on every core that may cache it,
+    // returns true if the initiator or a remote core was running the process
+    bool invalidatePage(std::vector<Cpu> &cpus, uint32_t initiator, uint32_t pid, uint32_t vpn);
+
+    // Invalidate every translation of a process, e.g. after fork write-protects its pages
+    void invalidateProcess(std::vector<Cpu> &cpus, uint32_t initiator, uint32_t pid);
+
+    // Forget the cores of a process that exited, once its translations are invalidated
+    void removeProcess(uint32_t pid);
+
+    // Invalidate the pages of an unmapped range as one operation, with at most one IPI per core.
+    // Above flushCeiling pages the TLBs are flushed instead of dropping every page
+    void invalidateRange(std::vector<Cpu> &cpus, uint32_t initiator, uint32_t pid, const std::vector<uint32_t> &vpns,
+                         uint32_t flushCeiling);
+
+    // Send the IPIs batched during the initiator's current operation
+    void flushBatches(std::vector<Cpu> &cpus, uint32_t initiator);
+
+    void displayStatistics(const std::vector<Cpu> &cpus) const;
+};
+
+#endif // TLBSHOOTDOWN_H
@@ -0,0 +1,148 @@
+// vmsimd: the simulator as a long-running service. Trace text streams in on stdin or over a Unix domain
+// socket and is replayed as it arrives; once the input ends, the statistics are written back. Over a
+// socket every connection is a fresh simulation with the configuration given on the command line
+#include <iostream>
+#include <functional>
+#include <stdexcept>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <csignal>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "../Library/VmSim.h"
+#include "../Simulator/SimulatorOptions.h"
+
+using namespace std;
+
+static void writeAll(int fd, const string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t n = write(fd, data.data() + written, data.size() - written);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw runtime_error(string("Write failed: ") + strerror(errno));
+        }
+        written += n;
+    }
+}
+
+// Replay everything read from fd until end of input. out collects the log and the report, flushing
+// them to the client after every read lets a client follow a long replay
+static void serve(const VmSimConfig& config, int fd, ostream& out, bool log, const function<void()>& flush) {
+    VmSim sim(config);
+    if (log) {
+        sim.setLog(&out);
+    }
+    vector<char> buffer(1 << 16);
+    while (true) {
+        ssize_t n = read(fd, buffer.data(), buffer.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw runtime_error(string("Read failed: ") + strerror(errno));
+        }
+        if (n == 0) {
+            break;
+        }
+        sim.feedText(buffer.data(), n);
+        flush();
+    }
+    sim.finishText();
+    sim.writeReport(out);
+    flush();
+}
+
+static int listenOn(const string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw runtime_error("Socket path " + path + " is too long");
+    }
+    strcpy(address.sun_path, path.c_str());
+
+    // A socket left behind by an earlier run is replaced, any other file is not
+    struct stat existing;
+    if (stat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) {
+        unlink(path.c_str());
+    }
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        throw runtime_error("Cannot listen on " + path + ": " + strerror(errno));
+    }
+    return listener;
+}
+
+int main(int argc, char* argv[]) {
+    vector<string> arguments(argv + 1, argv + argc);
+    try {
+        VmSimConfig config = VmSimConfig::fromArguments(arguments);
+        string socketPath = takeOption(config.options, "socket", "");
+        uint64_t connections = stoull(takeOption(config.options, "connections", "0"));
+        bool log = takeFlag(config.options, "log");
+
+        if (socketPath.empty()) {
+            serve(config, STDIN_FILENO, cout, log, []() { cout.flush(); });
+            return 0;
+        }
+
+        // Fail on a configuration every client would get an error for before listening
+        VmSim check(config);
+
+        // A client that goes away before its report is written must not end the daemon
+        signal(SIGPIPE, SIG_IGN);
+        int listener = listenOn(socketPath);
+        cerr << "vmsimd listening on " << socketPath << endl;
+        for (uint64_t served = 0; connections == 0 || served < connections; served++) {
+            int client = accept(listener, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR) {
+                    served--;
+                    continue;
+                }
+                throw runtime_error(string("Accept failed: ") + strerror(errno));
+            }
+            ostringstream out;
+            auto flush = [&]() {
+                writeAll(client, out.str());
+                out.str("");
+            };
+            try {
+                serve(config, client, out, log, flush);
+            } catch (const exception& e) {
+                // One failed simulation is reported to its client, the daemon goes on serving
+                cerr << "Error: " << e.what() << endl;
+                out << "Error: " << e.what() << endl;
+                try {
+                    flush();
+                } catch (const exception&) {
+                }
+            }
+            close(client);
+        }
+        close(listener);
+        unlink(socketPath.c_str());
+    }
+    catch (const invalid_argument& e) {
+        cerr << "Error: " << e.what() << endl;
+        cerr << "Usage: " << argv[0] << " [--socket=<path>] [--connections=<n>] [--log] [options] <page_size> <virtual_address_len> <physical_memory> <tlb_size> <process_memory_sizes>" << endl;
+        cerr << "Replays trace instructions read from stdin, or from every client of a Unix domain socket, and writes back the statistics" << endl;
+        cerr << "  --socket=<path>                  Serve clients on a Unix domain socket instead of reading stdin" << endl;
+        cerr << "  --connections=<n>                Exit after serving n clients (default 0, never)" << endl;
+        cerr << "  --log                            Also write back the per-instruction output of vmsimulator" << endl;
+        cerr << "Other options are vmsimulator's simulator options, replay-mode options are not supported" << endl;
+        return 1;
+    }
+    catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
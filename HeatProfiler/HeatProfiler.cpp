@@ -0,0 +1,203 @@
+#include "HeatProfiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include "../Log/Log.h"
+
+using namespace std;
+
+static const uint32_t MAX_REGIONS = 1U << 16;
+static const uint32_t COLD_PAGES_SHOWN = 8;
+static const uint32_t REGIONS_SHOWN = 16;
+static const uint32_t HEAT_BAR_WIDTH = 40;
+
+HeatProfiler::ProcessHeat::ProcessHeat(uint32_t width, uint32_t depth, uint32_t topK, uint32_t regionCount)
+    : sketch(width, depth), top(topK), regions(regionCount, 0)
+{
+}
+
+HeatProfiler::HeatProfiler(uint32_t sketchWidth, uint32_t sketchDepth, uint32_t topK, uint32_t decayInterval,
+                           uint32_t regionPages, uint32_t addressBits, uint32_t pageSize)
+    : sketchWidth(sketchWidth), sketchDepth(sketchDepth), topK(topK), decayInterval(decayInterval),
+      regionPages(regionPages), pageSize(pageSize)
+{
+    if (regionPages == 0)
+    {
+        throw invalid_argument("Heat map regions need at least one page");
+    }
+    uint64_t pages = (1ULL << addressBits) / pageSize;
+    uint64_t regions = (pages + regionPages - 1) / regionPages;
+    if (regions > MAX_REGIONS)
+    {
+        throw invalid_argument("Heat map regions are too small, the address space would need " + to_string(regions) +
+                               " of them (at most " + to_string(MAX_REGIONS) + ")");
+    }
+    regionCount = static_cast<uint32_t>(regions);
+}
+
+HeatProfiler::ProcessHeat &HeatProfiler::getProcess(uint32_t pid)
+{
+    auto it = processes.find(pid);
+    if (it == processes.end())
+    {
+        it = processes.emplace(piecewise_construct, forward_as_tuple(pid),
+                               forward_as_tuple(sketchWidth, sketchDepth, topK, regionCount)).first;
+    }
+    return it->second;
+}
+
+void HeatProfiler::recordAccess(uint32_t pid, uint32_t vpn)
+{
+    ProcessHeat &process = getProcess(pid);
+    process.sketch.add(vpn);
+    process.top.add(vpn);
+    process.regions[vpn / regionPages]++;
+    process.accesses++;
+
+    if (decayInterval > 0 && ++process.sinceDecay == decayInterval)
+    {
+        process.sketch.decay();
+        process.top.decay();
+        for (uint64_t &region : process.regions)
+        {
+            region >>= 1;
+        }
+        process.sinceDecay = 0;
+    }
+}
+
+uint32_t HeatProfiler::estimate(uint32_t pid, uint32_t vpn) const
+{
+    auto it = processes.find(pid);
+    return it == processes.end() ? 0 : it->second.sketch.estimate(vpn);
+}
+
+void HeatProfiler::removeProcess(uint32_t pid)
+{
+    auto it = processes.find(pid);
+    if (it == processes.end())
+    {
+        return;
+    }
+    exitedProcesses++;
+    exitedAccesses += it->second.accesses;
+    processes.erase(it);
+}
+
+void HeatProfiler::merge(HeatProfiler &other)
+{
+    for (auto &[pid, heat] : other.processes)
+    {
+        processes.erase(pid);
+        processes.emplace(pid, move(heat));
+    }
+    other.processes.clear();
+    exitedProcesses += other.exitedProcesses;
+    exitedAccesses += other.exitedAccesses;
+}
+
+void HeatProfiler::displayStatistics(const map<uint32_t, vector<uint32_t>> &residentPages) const
+{
+    *logStream << "--- Heat Profile ---" << endl;
+    *logStream << "  Sketch: " << sketchWidth << " x " << sketchDepth << " counters, top " << topK << " pages, regions of "
+               << regionPages << " pages, decay ";
+    if (decayInterval > 0)
+    {
+        *logStream << "every " << decayInterval << " accesses" << endl;
+    }
+    else
+    {
+        *logStream << "off" << endl;
+    }
+
+    for (const auto &[pid, heat] : processes)
+    {
+        size_t memory = heat.sketch.getMemoryUsage() + heat.top.getMemoryUsage() + heat.regions.size() * sizeof(uint64_t);
+        *logStream << "  Process " << pid << ": " << heat.accesses << " accesses, " << memory << " bytes of heat state" << endl;
+        // Shares are of the decayed weight when decay is on, the recent accesses
+        uint64_t weight = 0;
+        for (uint64_t region : heat.regions)
+        {
+            weight += region;
+        }
+        auto share = [weight](uint64_t count) { return weight > 0 ? static_cast<double>(count) / weight * 100 : 0.0; };
+
+        // Both structures only overcount, so the sketch can tighten the top-K's upper bound. The top-K's
+        // count minus its error is a lower bound
+        vector<SpaceSaving::Entry> hot = heat.top.getTop();
+        for (SpaceSaving::Entry &entry : hot)
+        {
+            uint32_t upper = min(entry.count, heat.sketch.estimate(entry.key));
+            entry.error = upper - min(upper, entry.count - entry.error);
+            entry.count = upper;
+        }
+        stable_sort(hot.begin(), hot.end(), [](const SpaceSaving::Entry &a, const SpaceSaving::Entry &b) {
+            return a.count > b.count;
+        });
+        *logStream << "    Hot pages:" << endl;
+        for (const SpaceSaving::Entry &entry : hot)
+        {
+            *logStream << "      VPN 0x" << hex << entry.key << dec << ": " << entry.count << " accesses ("
+                       << fixed << setprecision(1) << share(entry.count) << "%)";
+            if (entry.error > 0)
+            {
+                *logStream << ", at least " << entry.count - entry.error;
+            }
+            *logStream << endl;
+        }
+
+        auto resident = residentPages.find(pid);
+        if (resident != residentPages.end() && !resident->second.empty())
+        {
+            vector<pair<uint32_t, uint32_t>> cold; // (estimate, VPN)
+            for (uint32_t vpn : resident->second)
+            {
+                cold.emplace_back(heat.sketch.estimate(vpn), vpn);
+            }
+            size_t shown = min<size_t>(COLD_PAGES_SHOWN, cold.size());
+            partial_sort(cold.begin(), cold.begin() + shown, cold.end());
+            *logStream << "    Coldest resident pages:" << endl;
+            for (size_t i = 0; i < shown; i++)
+            {
+                *logStream << "      VPN 0x" << hex << cold[i].second << dec << ": at most " << cold[i].first << " accesses" << endl;
+            }
+        }
+
+        // The hottest regions, listed by address
+        vector<uint32_t> hottest;
+        for (uint32_t region = 0; region < heat.regions.size(); region++)
+        {
+            if (heat.regions[region] > 0)
+            {
+                hottest.push_back(region);
+            }
+        }
+        size_t shown = min<size_t>(REGIONS_SHOWN, hottest.size());
+        partial_sort(hottest.begin(), hottest.begin() + shown, hottest.end(), [&heat](uint32_t a, uint32_t b) {
+            return heat.regions[a] != heat.regions[b] ? heat.regions[a] > heat.regions[b] : a < b;
+        });
+        hottest.resize(shown);
+        sort(hottest.begin(), hottest.end());
+        uint64_t peak = 0;
+        for (uint32_t region : hottest)
+        {
+            peak = max(peak, heat.regions[region]);
+        }
+        *logStream << "    Region heat map (" << shown << " hottest regions):" << endl;
+        uint64_t regionBytes = static_cast<uint64_t>(regionPages) * pageSize;
+        for (uint32_t region : hottest)
+        {
+            uint64_t count = heat.regions[region];
+            *logStream << "      0x" << hex << setfill('0') << setw(8) << region * regionBytes << "-0x" << setw(8)
+                       << (region + 1) * regionBytes - 1 << setfill(' ') << dec << " " << setw(8) << count << " "
+                       << setw(5) << share(count) << "% " << string(peak > 0 ? count * HEAT_BAR_WIDTH / peak : 0, '#') << endl;
+        }
+        *logStream << defaultfloat << setprecision(6);
+    }
+    if (exitedProcesses > 0)
+    {
+        *logStream << "  Exited Processes (" << exitedProcesses << "): " << exitedAccesses << " accesses" << endl;
+    }
+    *logStream << endl;
+}
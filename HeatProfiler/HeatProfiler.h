@@ -0,0 +1,61 @@
+#ifndef HEATPROFILER_H
+#define HEATPROFILER_H
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "helperFiles/CountMinSketch.h"
+#include "helperFiles/SpaceSaving.h"
+
+// Streaming per-page heat of every process: a count-min sketch estimates the accesses of any VPN,
+// a space-saving top-K keeps the hottest VPNs and a fixed array counts accesses per region of
+// consecutive pages. Memory per process is fixed, however long the trace runs
+class HeatProfiler
+{
+private:
+    struct ProcessHeat
+    {
+        CountMinSketch sketch;
+        SpaceSaving top;
+        std::vector<uint64_t> regions; // Accesses per region
+        uint64_t accesses = 0;
+        uint64_t sinceDecay = 0;
+
+        ProcessHeat(uint32_t width, uint32_t depth, uint32_t topK, uint32_t regionCount);
+    };
+
+    uint32_t sketchWidth;
+    uint32_t sketchDepth;
+    uint32_t topK;
+    uint32_t decayInterval; // Accesses of a process between halvings, 0 keeps every access at full weight
+    uint32_t regionPages;
+    uint32_t regionCount;
+    uint32_t pageSize;
+
+    std::map<uint32_t, ProcessHeat> processes;
+    // Processes that have exited only leave their access count behind
+    uint32_t exitedProcesses = 0;
+    uint64_t exitedAccesses = 0;
+
+    ProcessHeat &getProcess(uint32_t pid);
+
+public:
+    HeatProfiler(uint32_t sketchWidth, uint32_t sketchDepth, uint32_t topK, uint32_t decayInterval,
+                 uint32_t regionPages, uint32_t addressBits, uint32_t pageSize);
+
+    void recordAccess(uint32_t pid, uint32_t vpn);
+
+    // Estimated accesses of a page, possibly too high but never too low
+    uint32_t estimate(uint32_t pid, uint32_t vpn) const;
+
+    // Drop the heat of a process that exits
+    void removeProcess(uint32_t pid);
+
+    // Take over the processes another profiler saw, e.g. a parallel replay worker's
+    void merge(HeatProfiler &other);
+
+    // Hot pages from the top-K, cold pages among each process's resident pages, and the region heat map
+    void displayStatistics(const std::map<uint32_t, std::vector<uint32_t>> &residentPages) const;
+};
+
+#endif // HEATPROFILER_H
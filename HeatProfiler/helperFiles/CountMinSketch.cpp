@@ -0,0 +1,71 @@
+#include "CountMinSketch.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+CountMinSketch::CountMinSketch(uint32_t width, uint32_t depth)
+    : width(width), depth(depth), counters(static_cast<size_t>(width) * depth, 0)
+{
+    if (width == 0 || depth == 0)
+    {
+        throw invalid_argument("Count-min sketch needs a width and depth of at least 1");
+    }
+    // Fixed seeds so that every run estimates the same counts
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (uint32_t row = 0; row < depth; row++)
+    {
+        // splitmix64 step
+        state += 0x9E3779B97F4A7C15ULL;
+        uint64_t seed = state;
+        seed = (seed ^ (seed >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        seed = (seed ^ (seed >> 27)) * 0x94D049BB133111EBULL;
+        seeds.push_back((seed ^ (seed >> 31)) | 1);
+    }
+}
+
+uint32_t CountMinSketch::slot(uint32_t row, uint64_t key) const
+{
+    uint64_t hash = (key + 1) * seeds[row];
+    hash ^= hash >> 32;
+    return row * width + static_cast<uint32_t>(hash % width);
+}
+
+uint32_t CountMinSketch::add(uint64_t key)
+{
+    uint32_t minimum = UINT32_MAX;
+    for (uint32_t row = 0; row < depth; row++)
+    {
+        minimum = min(minimum, counters[slot(row, key)]);
+    }
+    uint32_t updated = minimum == UINT32_MAX ? minimum : minimum + 1;
+    for (uint32_t row = 0; row < depth; row++)
+    {
+        uint32_t &counter = counters[slot(row, key)];
+        counter = max(counter, updated);
+    }
+    return updated;
+}
+
+uint32_t CountMinSketch::estimate(uint64_t key) const
+{
+    uint32_t minimum = UINT32_MAX;
+    for (uint32_t row = 0; row < depth; row++)
+    {
+        minimum = min(minimum, counters[slot(row, key)]);
+    }
+    return minimum;
+}
+
+void CountMinSketch::decay()
+{
+    for (uint32_t &counter : counters)
+    {
+        counter >>= 1;
+    }
+}
+
+size_t CountMinSketch::getMemoryUsage() const
+{
+    return counters.size() * sizeof(uint32_t) + seeds.size() * sizeof(uint64_t);
+}
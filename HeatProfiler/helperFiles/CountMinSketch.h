@@ -0,0 +1,35 @@
+#ifndef COUNTMINSKETCH_H
+#define COUNTMINSKETCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Count-min sketch of access counts by key: depth rows of width counters, each row with its own hash.
+// Estimates never undercount, and with conservative updates overcount by at most about e/width of
+// all counted accesses with probability 1 - e^-depth. Memory is fixed at width * depth counters
+class CountMinSketch
+{
+private:
+    uint32_t width;
+    uint32_t depth;
+    std::vector<uint32_t> counters; // Row after row
+    std::vector<uint64_t> seeds;    // Odd multiplier of each row's hash
+
+    uint32_t slot(uint32_t row, uint64_t key) const;
+
+public:
+    CountMinSketch(uint32_t width, uint32_t depth);
+
+    // Count one access and return the key's new estimate. Conservative update: only the counters
+    // at the current minimum are raised, which keeps the overcount of other keys down
+    uint32_t add(uint64_t key);
+    uint32_t estimate(uint64_t key) const;
+
+    // Halve every counter, so older accesses weigh less than recent ones
+    void decay();
+
+    std::size_t getMemoryUsage() const;
+};
+
+#endif // COUNTMINSKETCH_H
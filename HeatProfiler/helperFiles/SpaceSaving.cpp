@@ -0,0 +1,105 @@
+#include "SpaceSaving.h"
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+SpaceSaving::SpaceSaving(uint32_t capacity) : capacity(capacity)
+{
+    if (capacity == 0)
+    {
+        throw invalid_argument("Top-K tracking needs room for at least one key");
+    }
+    heap.reserve(capacity);
+    positions.reserve(capacity);
+}
+
+void SpaceSaving::place(uint32_t index, const Entry &entry)
+{
+    heap[index] = entry;
+    positions[entry.key] = index;
+}
+
+// Counts only grow, so a changed entry can only move down the min-heap
+void SpaceSaving::siftDown(uint32_t index)
+{
+    Entry entry = heap[index];
+    uint32_t size = static_cast<uint32_t>(heap.size());
+    while (true)
+    {
+        uint32_t child = 2 * index + 1;
+        if (child >= size)
+        {
+            break;
+        }
+        if (child + 1 < size && heap[child + 1].count < heap[child].count)
+        {
+            child++;
+        }
+        if (heap[child].count >= entry.count)
+        {
+            break;
+        }
+        place(index, heap[child]);
+        index = child;
+    }
+    place(index, entry);
+}
+
+void SpaceSaving::add(uint64_t key)
+{
+    auto position = positions.find(key);
+    if (position != positions.end())
+    {
+        heap[position->second].count++;
+        siftDown(position->second);
+        return;
+    }
+    if (heap.size() < capacity)
+    {
+        // A new key has the lowest possible count, move it up past every higher parent
+        heap.push_back({key, 1, 0});
+        uint32_t index = static_cast<uint32_t>(heap.size() - 1);
+        while (index > 0 && heap[(index - 1) / 2].count > heap[index].count)
+        {
+            Entry child = heap[index];
+            place(index, heap[(index - 1) / 2]);
+            index = (index - 1) / 2;
+            place(index, child);
+        }
+        positions[key] = index;
+        return;
+    }
+    // Replace the key with the lowest count
+    Entry &victim = heap[0];
+    positions.erase(victim.key);
+    uint32_t minimum = victim.count;
+    place(0, {key, minimum + 1, minimum});
+    siftDown(0);
+}
+
+// Halving keeps the order of the counts, so the heap stays valid
+void SpaceSaving::decay()
+{
+    for (Entry &entry : heap)
+    {
+        entry.count = max<uint32_t>(entry.count >> 1, 1);
+        entry.error >>= 1;
+    }
+}
+
+vector<SpaceSaving::Entry> SpaceSaving::getTop() const
+{
+    vector<Entry> top = heap;
+    sort(top.begin(), top.end(), [](const Entry &a, const Entry &b) {
+        return a.count != b.count ? a.count > b.count : a.key < b.key;
+    });
+    return top;
+}
+
+size_t SpaceSaving::getMemoryUsage() const
+{
+    // Entries plus a rough size of the hash map's nodes and buckets
+    return heap.capacity() * sizeof(Entry) + positions.size() * (sizeof(uint64_t) + sizeof(uint32_t) + 2 * sizeof(void *))
+         + positions.bucket_count() * sizeof(void *);
+}
@@ -0,0 +1,44 @@
+#ifndef SPACESAVING_H
+#define SPACESAVING_H
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Space-saving top-K: tracks at most capacity keys. A key that is not tracked replaces the one with
+// the lowest count and inherits that count as its possible overcount, so any key counted more than
+// total/capacity times is guaranteed to be tracked. The tracked keys form a min-heap on their count
+class SpaceSaving
+{
+public:
+    struct Entry
+    {
+        uint64_t key;
+        uint32_t count;
+        uint32_t error; // The count may be this much too high
+    };
+
+private:
+    uint32_t capacity;
+    std::vector<Entry> heap;
+    std::unordered_map<uint64_t, uint32_t> positions; // Key to its index in the heap
+
+    void siftDown(uint32_t index);
+    void place(uint32_t index, const Entry &entry);
+
+public:
+    explicit SpaceSaving(uint32_t capacity);
+
+    void add(uint64_t key);
+
+    // Halve every count and error, keeping older accesses in line with a decayed sketch
+    void decay();
+
+    // Tracked keys, highest count first
+    std::vector<Entry> getTop() const;
+
+    std::size_t getMemoryUsage() const;
+};
+
+#endif // SPACESAVING_H
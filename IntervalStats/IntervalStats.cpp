@@ -0,0 +1,113 @@
+#include "IntervalStats.h"
+#include <stdexcept>
+
+using namespace std;
+
+static const char *const CSV_HEADER = "window,instructions,cycles,pid,accesses,access_cycles,tlb_hits,tlb_misses,"
+                                      "faults,evictions,resident_pages,page_table_bytes,free_frames";
+
+IntervalStats::IntervalStats(const string &path, size_t capacity)
+    : out(path), ring(capacity)
+{
+    if (!out)
+    {
+        throw runtime_error("Cannot open interval statistics file " + path);
+    }
+    if (capacity == 0)
+    {
+        throw invalid_argument("Interval statistics buffer needs room for at least one sample");
+    }
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    format = json ? IntervalFormat::Json : IntervalFormat::Csv;
+    if (format == IntervalFormat::Json)
+    {
+        out << "[";
+    }
+    else
+    {
+        out << CSV_HEADER << "\n";
+    }
+}
+
+IntervalStats::~IntervalStats()
+{
+    flush();
+    if (format == IntervalFormat::Json)
+    {
+        out << (samplesWritten > 0 ? "\n]" : "]") << endl;
+    }
+}
+
+void IntervalStats::beginWindow()
+{
+    windows++;
+}
+
+void IntervalStats::record(const IntervalSample &cumulative)
+{
+    IntervalSample &last = previous[cumulative.pid];
+    IntervalSample sample = cumulative;
+    sample.window = windows;
+    sample.accesses -= last.accesses;
+    sample.accessCycles -= last.accessCycles;
+    sample.tlbHits -= last.tlbHits;
+    sample.tlbMisses -= last.tlbMisses;
+    sample.faults -= last.faults;
+    sample.evictions -= last.evictions;
+    last = cumulative;
+
+    if (count == ring.size())
+    {
+        flush();
+    }
+    ring[(head + count) % ring.size()] = sample;
+    count++;
+}
+
+void IntervalStats::removeProcess(uint32_t pid)
+{
+    previous.erase(pid);
+}
+
+void IntervalStats::flush()
+{
+    for (; count > 0; count--)
+    {
+        writeSample(ring[head]);
+        head = (head + 1) % ring.size();
+    }
+    out.flush();
+}
+
+void IntervalStats::writeSample(const IntervalSample &sample)
+{
+    if (format == IntervalFormat::Csv)
+    {
+        out << sample.window << ',' << sample.instructions << ',' << sample.cycles << ',' << sample.pid << ','
+            << sample.accesses << ',' << sample.accessCycles << ',' << sample.tlbHits << ',' << sample.tlbMisses << ','
+            << sample.faults << ',' << sample.evictions << ',' << sample.residentPages << ','
+            << sample.pageTableBytes << ',' << sample.freeFrames << '\n';
+    }
+    else
+    {
+        out << (samplesWritten > 0 ? ",\n" : "\n")
+            << "  {\"window\": " << sample.window << ", \"instructions\": " << sample.instructions
+            << ", \"cycles\": " << sample.cycles << ", \"pid\": " << sample.pid
+            << ", \"accesses\": " << sample.accesses << ", \"access_cycles\": " << sample.accessCycles
+            << ", \"tlb_hits\": " << sample.tlbHits << ", \"tlb_misses\": " << sample.tlbMisses
+            << ", \"faults\": " << sample.faults << ", \"evictions\": " << sample.evictions
+            << ", \"resident_pages\": " << sample.residentPages << ", \"page_table_bytes\": " << sample.pageTableBytes
+            << ", \"free_frames\": " << sample.freeFrames << "}";
+    }
+    samplesWritten++;
+}
+
+uint64_t IntervalStats::getWindows() const
+{
+    return windows;
+}
+
+uint64_t IntervalStats::getSamples() const
+{
+    return samplesWritten + count;
+}
@@ -0,0 +1,73 @@
+#ifndef INTERVALSTATS_H
+#define INTERVALSTATS_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Counters of one process at the end of a window. Gauges (resident pages, page table memory, free
+// frames) are the value at that point, the other counters what happened during the window
+struct IntervalSample
+{
+    uint64_t window = 0;
+    uint64_t instructions = 0; // Instructions replayed since the start, at the end of the window
+    uint64_t cycles = 0;       // Simulated cycles since the start, at the end of the window
+    uint32_t pid = 0;
+    uint64_t accesses = 0;
+    uint64_t accessCycles = 0;
+    uint64_t tlbHits = 0;
+    uint64_t tlbMisses = 0;
+    uint64_t faults = 0;
+    uint64_t evictions = 0;
+    uint32_t residentPages = 0;
+    uint64_t pageTableBytes = 0;
+    uint32_t freeFrames = 0;
+};
+
+enum class IntervalFormat { Csv, Json };
+
+// Time series of per-process counters, one sample per process and window. Samples are kept in a
+// preallocated ring buffer that is streamed to the output file whenever it fills up and at the end
+class IntervalStats
+{
+private:
+    std::ofstream out;
+    IntervalFormat format;
+    std::vector<IntervalSample> ring;
+    size_t head = 0;  // Oldest sample not written yet
+    size_t count = 0; // Samples waiting to be written
+    uint64_t samplesWritten = 0;
+    uint64_t windows = 0;
+
+    // Cumulative counters of each process at the end of its previous window
+    std::unordered_map<uint32_t, IntervalSample> previous;
+
+    void writeSample(const IntervalSample &sample);
+
+public:
+    // The format follows the file extension: .json writes a JSON array, anything else CSV
+    IntervalStats(const std::string &path, size_t capacity);
+    ~IntervalStats();
+
+    IntervalStats(const IntervalStats &) = delete;
+    IntervalStats &operator=(const IntervalStats &) = delete;
+
+    // Start a new window, the samples recorded next belong to it
+    void beginWindow();
+
+    // Add one process's cumulative counters, stored as the change since its previous window
+    void record(const IntervalSample &cumulative);
+
+    // Forget a process that exits, a new process with its pid starts from zero
+    void removeProcess(uint32_t pid);
+
+    // Write the buffered samples to the output file
+    void flush();
+
+    uint64_t getWindows() const;
+    uint64_t getSamples() const;
+};
+
+#endif // INTERVALSTATS_H
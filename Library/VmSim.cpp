@@ -0,0 +1,217 @@
+#include "VmSim.h"
+#include <cstring>
+#include <stdexcept>
+#include "../Simulator/Simulator.h"
+#include "../Simulator/SimulatorOptions.h"
+#include "../Simulator/Instruction.h"
+#include "../Log/Log.h"
+
+using namespace std;
+
+namespace
+{
+// Point the calling thread's log at an instance's stream for the duration of a call
+class LogRedirect
+{
+private:
+    ostream *saved;
+
+public:
+    explicit LogRedirect(ostream *stream) : saved(logStream) { logStream = stream; }
+    ~LogRedirect() { logStream = saved; }
+};
+
+TraceOp toTraceOp(const vmsim_op &op)
+{
+    TraceOp traceOp;
+    traceOp.pid = op.pid;
+    traceOp.operand = op.operand;
+    switch (op.command)
+    {
+    case VMSIM_ACCESS_CODE:
+    case VMSIM_ACCESS_STACK:
+    case VMSIM_ACCESS_HEAP:
+        traceOp.command = TraceCommand::Access;
+        traceOp.type = op.command == VMSIM_ACCESS_CODE ? AccessType::Code
+                     : op.command == VMSIM_ACCESS_STACK ? AccessType::Stack : AccessType::Heap;
+        traceOp.isWrite = traceOp.type != AccessType::Code && op.write != 0;
+        break;
+    case VMSIM_ALLOC:
+        traceOp.command = TraceCommand::Alloc;
+        break;
+    case VMSIM_FREE:
+        traceOp.command = TraceCommand::Free;
+        break;
+    case VMSIM_SWITCH:
+        traceOp.command = TraceCommand::Switch;
+        break;
+    case VMSIM_FORK:
+        traceOp.command = TraceCommand::Fork;
+        break;
+    case VMSIM_SPAWN:
+        traceOp.command = TraceCommand::Spawn;
+        break;
+    case VMSIM_EXIT:
+        traceOp.command = TraceCommand::Exit;
+        break;
+    default:
+        throw invalid_argument("Unknown operation command " + to_string(op.command));
+    }
+    return traceOp;
+}
+}
+
+VmSimConfig VmSimConfig::fromArguments(const vector<string> &arguments)
+{
+    VmSimConfig config;
+    vector<string> positional;
+    for (const string &argument : arguments)
+    {
+        if (argument.rfind("--", 0) == 0)
+        {
+            size_t eq = argument.find('=');
+            config.options[argument.substr(2, eq == string::npos ? string::npos : eq - 2)] = eq == string::npos ? "" : argument.substr(eq + 1);
+        }
+        else
+        {
+            positional.push_back(argument);
+        }
+    }
+    if (positional.size() < 5)
+    {
+        throw invalid_argument("Expected <page_size> <virtual_address_len> <physical_memory> <tlb_size> <process_memory_sizes>");
+    }
+    config.pageSize = stoul(positional[0]);
+    config.addressBits = stoul(positional[1]);
+    config.physicalMemory = stoull(positional[2]);
+    config.tlbSize = stoul(positional[3]);
+    config.processMemory.clear();
+    for (size_t i = 4; i < positional.size(); i++)
+    {
+        config.processMemory.push_back(stoul(positional[i]));
+    }
+    return config;
+}
+
+VmSim::VmSim(const VmSimConfig &config) : discard(nullptr)
+{
+    if (config.processMemory.empty())
+    {
+        throw invalid_argument("The simulator needs at least one process");
+    }
+    LogRedirect redirect(&discard);
+
+    // The CPU and frame options vmsimulator handles itself, the rest are simulator-wide
+    map<string, string> options = config.options;
+    vector<uint32_t> shootdownCost = parseColonList(takeOption(options, "shootdown-cost", "2000:1000"));
+    if (shootdownCost.size() != 2)
+    {
+        throw runtime_error("Shootdown cost must be given as <send_cycles>:<handle_cycles>");
+    }
+    uint32_t shootdownBatch = stoul(takeOption(options, "shootdown-batch", "0"));
+    bool lazyTlb = takeFlag(options, "lazy-tlb");
+    bool partitionFrames = takeFlag(options, "partition-frames");
+
+    simulator.reset(new Simulator(config.addressBits, config.pageSize, config.physicalMemory / config.pageSize, config.tlbSize));
+    simulator->setCpuCount(1, shootdownBatch, lazyTlb, shootdownCost[0], shootdownCost[1]);
+    configureSimulator(*simulator, options);
+    vector<uint32_t> processPages;
+    for (uint32_t size : config.processMemory)
+    {
+        processPages.push_back(static_cast<uint32_t>((static_cast<uint64_t>(size) + config.pageSize - 1) / config.pageSize));
+    }
+    if (partitionFrames)
+    {
+        simulator->setFramePartitions(processPages);
+    }
+    for (uint32_t pid = 0; pid < processPages.size(); pid++)
+    {
+        simulator->createProcess(pid, processPages[pid]);
+    }
+}
+
+VmSim::~VmSim() = default;
+
+void VmSim::feed(const vmsim_op *ops, size_t count)
+{
+    LogRedirect redirect(log ? log : &discard);
+    for (size_t i = 0; i < count; i++)
+    {
+        executeOperation(*simulator, toTraceOp(ops[i]));
+        simulator->completeInstruction();
+    }
+}
+
+void VmSim::executeLine()
+{
+    if (log)
+    {
+        *log << "Execute instruction: " << line << endl;
+    }
+    executeInstruction(*simulator, line);
+    if (log)
+    {
+        *log << "----------" << endl;
+    }
+}
+
+void VmSim::feedText(const char *text, size_t length)
+{
+    LogRedirect redirect(log ? log : &discard);
+    const char *end = text + length;
+    while (text < end)
+    {
+        const char *newline = static_cast<const char *>(memchr(text, '\n', end - text));
+        if (!newline)
+        {
+            pendingLine.append(text, end);
+            return;
+        }
+        if (pendingLine.empty())
+        {
+            line.assign(text, newline);
+        }
+        else
+        {
+            line.swap(pendingLine.append(text, newline));
+            pendingLine.clear();
+        }
+        text = newline + 1;
+        executeLine();
+    }
+}
+
+void VmSim::finishText()
+{
+    if (pendingLine.empty())
+    {
+        return;
+    }
+    LogRedirect redirect(log ? log : &discard);
+    line.swap(pendingLine);
+    pendingLine.clear();
+    executeLine();
+}
+
+vmsim_stats VmSim::getStats() const
+{
+    vmsim_stats stats = {};
+    stats.instructions = simulator->getInstructionsReplayed();
+    ProcessCounters counters = simulator->getProcessCounters();
+    stats.accesses = counters.memoryAccesses;
+    stats.tlb_hits = counters.tlbHits;
+    stats.tlb_misses = counters.tlbMisses;
+    stats.page_faults = counters.pageFaults;
+    stats.evictions = counters.evictions;
+    stats.minor_faults = simulator->getMinorFaults();
+    stats.pool_faults = simulator->getPoolFaults();
+    stats.major_faults = simulator->getMajorFaults();
+    stats.cycles = simulator->getTotalCycles();
+    return stats;
+}
+
+void VmSim::writeReport(ostream &out) const
+{
+    LogRedirect redirect(&out);
+    simulator->displayStatistics();
+}
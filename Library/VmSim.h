@@ -0,0 +1,66 @@
+#ifndef VMSIM_H
+#define VMSIM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "VmSimC.h"
+
+class Simulator;
+
+// Machine and options of an embedded simulator, the same as vmsimulator's arguments
+struct VmSimConfig
+{
+    uint32_t pageSize = 4096;
+    uint32_t addressBits = 32;
+    uint64_t physicalMemory = 128 * 1024 * 1024;
+    uint32_t tlbSize = 8;
+    std::vector<uint32_t> processMemory;        // Bytes of every process, by pid
+    std::map<std::string, std::string> options; // "--name=value" options by name, e.g. {"zswap-frames", "64"}
+
+    // Split "--name=value" options from the positional arguments <page_size> <virtual_address_len>
+    // <physical_memory> <tlb_size> <process_memory_sizes>, throws invalid_argument if some are missing
+    static VmSimConfig fromArguments(const std::vector<std::string> &arguments);
+};
+
+// The simulator as a library: created from a config, fed batches of trace operations or trace text and
+// queried for statistics. One CPU replays everything serially, so the replay-mode options of vmsimulator
+// (threads, sampling, event-driven scheduling, checkpoints, interval statistics) are not available.
+// Per-instruction output goes to the log stream if one is set. Calls on one instance must not overlap
+class VmSim
+{
+private:
+    std::unique_ptr<Simulator> simulator;
+    std::ostream *log = nullptr;
+    std::ostream discard;
+    std::string pendingLine; // Text after the last newline of the last batch
+    std::string line;
+
+    void executeLine();
+
+public:
+    // Throws invalid_argument or runtime_error for a config vmsimulator would reject
+    explicit VmSim(const VmSimConfig &config);
+    ~VmSim();
+    VmSim(const VmSim &) = delete;
+    VmSim &operator=(const VmSim &) = delete;
+
+    void setLog(std::ostream *stream) { log = stream; }
+
+    // Run operations in order, throws at the first that fails
+    void feed(const vmsim_op *ops, size_t count);
+    // Run every complete line of trace text, keeping a cut-off last line for the next call
+    void feedText(const char *text, size_t length);
+    // Run the kept line, for text that does not end with a newline
+    void finishText();
+
+    vmsim_stats getStats() const;
+    // The statistics vmsimulator prints at the end of a replay
+    void writeReport(std::ostream &out) const;
+};
+
+#endif // VMSIM_H
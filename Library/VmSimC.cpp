@@ -0,0 +1,113 @@
+#include "VmSimC.h"
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "VmSim.h"
+
+using namespace std;
+
+// The handle C callers see is the C++ instance
+struct vmsim
+{
+    VmSim sim;
+    explicit vmsim(const VmSimConfig &config) : sim(config) {}
+};
+
+namespace
+{
+thread_local string lastError;
+
+// Run a call, turning an exception into -1 and the thread's last error, nothing may unwind into C
+template <typename Call>
+int guard(Call call)
+{
+    try
+    {
+        lastError.clear();
+        call();
+        return 0;
+    }
+    catch (const exception &e)
+    {
+        lastError = e.what();
+    }
+    catch (...)
+    {
+        lastError = "Unknown error";
+    }
+    return -1;
+}
+}
+
+extern "C" {
+
+uint32_t vmsim_abi_version(void)
+{
+    return VMSIM_ABI_VERSION;
+}
+
+vmsim *vmsim_create(int argc, const char *const *argv)
+{
+    vmsim *sim = nullptr;
+    guard([&]() {
+        vector<string> arguments(argv, argv + max(argc, 0));
+        sim = new vmsim(VmSimConfig::fromArguments(arguments));
+    });
+    return sim;
+}
+
+void vmsim_destroy(vmsim *sim)
+{
+    delete sim;
+}
+
+int vmsim_feed_ops(vmsim *sim, const vmsim_op *ops, size_t count)
+{
+    return guard([&]() { sim->sim.feed(ops, count); });
+}
+
+int vmsim_feed_text(vmsim *sim, const char *text, size_t length)
+{
+    return guard([&]() { sim->sim.feedText(text, length); });
+}
+
+int vmsim_finish_text(vmsim *sim)
+{
+    return guard([&]() { sim->sim.finishText(); });
+}
+
+int vmsim_get_stats(const vmsim *sim, vmsim_stats *stats)
+{
+    return guard([&]() { *stats = sim->sim.getStats(); });
+}
+
+size_t vmsim_report(const vmsim *sim, char *buffer, size_t size)
+{
+    string report;
+    if (guard([&]() {
+            ostringstream out;
+            sim->sim.writeReport(out);
+            report = out.str();
+        }) != 0)
+    {
+        return 0;
+    }
+    if (size > 0)
+    {
+        size_t copied = min(report.size(), size - 1);
+        memcpy(buffer, report.data(), copied);
+        buffer[copied] = '\0';
+    }
+    return report.size();
+}
+
+const char *vmsim_last_error(void)
+{
+    return lastError.c_str();
+}
+
+}
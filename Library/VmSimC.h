@@ -0,0 +1,89 @@
+#ifndef VMSIMC_H
+#define VMSIMC_H
+
+/* C interface of the simulator library. Only opaque handles and plain structs cross it, so programs in
+ * other languages can load libvmsim directly. Functions that can fail return 0 on success and -1 on
+ * error, with the message in vmsim_last_error() */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a struct or function below changes */
+#define VMSIM_ABI_VERSION 1
+
+/* Commands of a trace operation, the instructions of the trace format */
+enum vmsim_command
+{
+    VMSIM_ACCESS_CODE = 0,
+    VMSIM_ACCESS_STACK = 1,
+    VMSIM_ACCESS_HEAP = 2,
+    VMSIM_ALLOC = 3,
+    VMSIM_FREE = 4,
+    VMSIM_SWITCH = 5,
+    VMSIM_FORK = 6,
+    VMSIM_SPAWN = 7,
+    VMSIM_EXIT = 8
+};
+
+/* One trace operation. operand is the virtual address of an access, the size in bytes of an alloc or
+ * free and the pid of a fork's or spawn's child. write only applies to stack and heap accesses */
+typedef struct vmsim_op
+{
+    uint32_t pid;
+    uint32_t command;
+    uint32_t write;
+    uint32_t operand;
+} vmsim_op;
+
+/* Totals of a simulation so far */
+typedef struct vmsim_stats
+{
+    uint64_t instructions;
+    uint64_t accesses;
+    uint64_t tlb_hits;
+    uint64_t tlb_misses;
+    uint64_t page_faults;
+    uint64_t minor_faults; /* First touches, zero-filled */
+    uint64_t pool_faults;  /* Refaults served by the compressed pool */
+    uint64_t major_faults; /* Refaults read back from swap */
+    uint64_t evictions;
+    uint64_t cycles;
+} vmsim_stats;
+
+typedef struct vmsim vmsim;
+
+uint32_t vmsim_abi_version(void);
+
+/* Create a simulator from vmsimulator's arguments without the instruction file: any "--name=value"
+ * options, then <page_size> <virtual_address_len> <physical_memory> <tlb_size> <process_memory_sizes>.
+ * Returns NULL on error */
+vmsim *vmsim_create(int argc, const char *const *argv);
+void vmsim_destroy(vmsim *sim);
+
+/* Run a batch of operations, stopping at the first that fails. As in a trace, accesses and allocations
+ * apply to the current process, so the first operation switches to one */
+int vmsim_feed_ops(vmsim *sim, const vmsim_op *ops, size_t count);
+
+/* Run trace text in generator.py's format. A line cut off at the end of one batch is completed by the
+ * next, vmsim_finish_text runs a last line without newline */
+int vmsim_feed_text(vmsim *sim, const char *text, size_t length);
+int vmsim_finish_text(vmsim *sim);
+
+int vmsim_get_stats(const vmsim *sim, vmsim_stats *stats);
+
+/* Copy the statistics vmsimulator prints at the end of a replay into buffer, truncated and always
+ * terminated if it is too small. Returns the length of the whole report, like snprintf */
+size_t vmsim_report(const vmsim *sim, char *buffer, size_t size);
+
+/* Message of the last error on the calling thread, empty if there was none */
+const char *vmsim_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* VMSIMC_H */
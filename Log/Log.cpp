@@ -0,0 +1,5 @@
+#include "Log.h"
+#include <iostream>
+
+thread_local std::ostream *logStream = &std::cout;
+thread_local std::ostream *errorStream = &std::cerr;
@@ -0,0 +1,11 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <ostream>
+
+// All simulator output goes through these streams instead of cout and cerr. Parallel replay points
+// them at per-line buffers on each worker thread and writes the buffers back in trace order
+extern thread_local std::ostream *logStream;
+extern thread_local std::ostream *errorStream;
+
+#endif // LOG_H
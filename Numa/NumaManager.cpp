@@ -0,0 +1,252 @@
+#include "NumaManager.h"
+#include <iostream>
+#include "../Log/Log.h"
+#include <stdexcept>
+
+using namespace std;
+
+NumaManager::NumaManager(uint32_t nodeCount, uint32_t totalFrames, uint32_t localLatency, uint32_t remoteLatency, uint32_t balanceThreshold)
+    : nodeCount(nodeCount),
+      localLatency(localLatency),
+      remoteLatency(remoteLatency),
+      balanceThreshold(balanceThreshold),
+      defaultPlacement{0, NumaPolicy::FirstTouch, 0, 0, 0, 0, 0},
+      frameRemoteAccesses(totalFrames, 0),
+      nodeLocalAccesses(nodeCount, 0),
+      nodeRemoteAccesses(nodeCount, 0)
+{
+}
+
+void NumaManager::parsePolicy(const string &value, NumaPolicy &policy, uint32_t &policyNode)
+{
+    size_t colon = value.find(':');
+    string name = value.substr(0, colon);
+    policyNode = colon == string::npos ? 0 : stoul(value.substr(colon + 1));
+    if (name == "first-touch")
+    {
+        policy = NumaPolicy::FirstTouch;
+    }
+    else if (name == "interleave")
+    {
+        policy = NumaPolicy::Interleave;
+    }
+    else if (name == "preferred" && colon != string::npos)
+    {
+        policy = NumaPolicy::Preferred;
+    }
+    else if (name == "bind" && colon != string::npos)
+    {
+        policy = NumaPolicy::Bind;
+    }
+    else
+    {
+        throw invalid_argument("Invalid NUMA policy: " + value + " (expected first-touch, interleave, preferred:<node> or bind:<node>)");
+    }
+}
+
+string NumaManager::getPolicyName(NumaPolicy policy)
+{
+    switch (policy)
+    {
+    case NumaPolicy::FirstTouch:
+        return "first-touch";
+    case NumaPolicy::Interleave:
+        return "interleave";
+    case NumaPolicy::Preferred:
+        return "preferred";
+    case NumaPolicy::Bind:
+        return "bind";
+    }
+    return "unknown";
+}
+
+// placements are created on first use, processes without a configured home node run on node pid % nodes
+NumaManager::ProcessPlacement &NumaManager::getPlacement(uint32_t pid)
+{
+    while (placements.size() <= pid)
+    {
+        uint32_t newPid = placements.size();
+        placements.push_back(defaultPlacement);
+        placements.back().homeNode = newPid % nodeCount;
+    }
+    return placements[pid];
+}
+
+void NumaManager::setDefaultPolicy(NumaPolicy policy, uint32_t policyNode)
+{
+    if (policyNode >= nodeCount)
+    {
+        throw invalid_argument("Invalid NUMA node: " + to_string(policyNode));
+    }
+    defaultPlacement.policy = policy;
+    defaultPlacement.policyNode = policyNode;
+    for (ProcessPlacement &placement : placements)
+    {
+        placement.policy = policy;
+        placement.policyNode = policyNode;
+    }
+}
+
+void NumaManager::setPolicy(uint32_t pid, NumaPolicy policy, uint32_t policyNode)
+{
+    if (policyNode >= nodeCount)
+    {
+        throw invalid_argument("Invalid NUMA node: " + to_string(policyNode));
+    }
+    ProcessPlacement &placement = getPlacement(pid);
+    placement.policy = policy;
+    placement.policyNode = policyNode;
+}
+
+void NumaManager::setHomeNode(uint32_t pid, uint32_t node)
+{
+    if (node >= nodeCount)
+    {
+        throw invalid_argument("Invalid NUMA node: " + to_string(node));
+    }
+    getPlacement(pid).homeNode = node;
+}
+
+uint32_t NumaManager::getHomeNode(uint32_t pid)
+{
+    return getPlacement(pid).homeNode;
+}
+
+// the first node is where the policy wants the page, the others are fallbacks in order of node distance
+vector<uint32_t> NumaManager::getPlacementNodes(uint32_t pid)
+{
+    ProcessPlacement &placement = getPlacement(pid);
+    uint32_t firstNode = placement.homeNode;
+    switch (placement.policy)
+    {
+    case NumaPolicy::FirstTouch:
+        firstNode = placement.homeNode;
+        break;
+    case NumaPolicy::Interleave:
+        firstNode = placement.interleaveCursor;
+        placement.interleaveCursor = (placement.interleaveCursor + 1) % nodeCount;
+        break;
+    case NumaPolicy::Preferred:
+        firstNode = placement.policyNode;
+        break;
+    case NumaPolicy::Bind:
+        return vector<uint32_t>(1, placement.policyNode);
+    }
+
+    vector<uint32_t> nodes;
+    for (uint32_t i = 0; i < nodeCount; i++)
+    {
+        nodes.push_back((firstNode + i) % nodeCount);
+    }
+    return nodes;
+}
+
+bool NumaManager::recordAccess(uint32_t pid, uint32_t frame, uint32_t frameNode)
+{
+    ProcessPlacement &placement = getPlacement(pid);
+    if (frameNode == placement.homeNode)
+    {
+        placement.localAccesses++;
+        nodeLocalAccesses[frameNode]++;
+        return false;
+    }
+    placement.remoteAccesses++;
+    nodeRemoteAccesses[frameNode]++;
+
+    // Balancing only moves pages whose placement the policy leaves open, like NUMA hinting faults do
+    if (balanceThreshold == 0 || placement.policy == NumaPolicy::Interleave || placement.policy == NumaPolicy::Bind)
+    {
+        return false;
+    }
+    if (frameRemoteAccesses[frame] < UINT16_MAX)
+    {
+        frameRemoteAccesses[frame]++;
+    }
+    return frameRemoteAccesses[frame] >= balanceThreshold;
+}
+
+void NumaManager::resetFrame(uint32_t frame)
+{
+    frameRemoteAccesses[frame] = 0;
+}
+
+void NumaManager::recordMigration(uint32_t pid)
+{
+    getPlacement(pid).migrations++;
+}
+
+void NumaManager::removeProcess(uint32_t pid)
+{
+    if (pid >= placements.size())
+    {
+        return;
+    }
+    ProcessPlacement &placement = placements[pid];
+    exitedPlacements.localAccesses += placement.localAccesses;
+    exitedPlacements.remoteAccesses += placement.remoteAccesses;
+    exitedPlacements.migrations += placement.migrations;
+    exitedProcesses++;
+    placement.localAccesses = 0;
+    placement.remoteAccesses = 0;
+    placement.migrations = 0;
+}
+
+void NumaManager::recordMigrationFailure()
+{
+    migrationFailures++;
+}
+
+void NumaManager::recordTLBInvalidation()
+{
+    tlbInvalidations++;
+}
+
+void NumaManager::displayStatistics(const vector<uint32_t> &nodeFrames, const vector<uint32_t> &nodeFreeFrames) const
+{
+    uint64_t totalLocal = 0;
+    uint64_t totalRemote = 0;
+    uint64_t totalMigrations = 0;
+
+    *logStream << "--- NUMA Statistics ---" << endl;
+    for (uint32_t node = 0; node < nodeCount; node++)
+    {
+        *logStream << "  Node " << node << ": " << nodeFrames[node] << " frames (" << nodeFreeFrames[node] << " free), "
+             << nodeLocalAccesses[node] << " local accesses, " << nodeRemoteAccesses[node] << " remote accesses" << endl;
+    }
+    for (uint32_t pid = 0; pid < placements.size(); pid++)
+    {
+        const ProcessPlacement &placement = placements[pid];
+        uint64_t accesses = placement.localAccesses + placement.remoteAccesses;
+        *logStream << "  Process " << pid << ": home node " << placement.homeNode << ", policy " << getPolicyName(placement.policy);
+        if (placement.policy == NumaPolicy::Preferred || placement.policy == NumaPolicy::Bind)
+        {
+            *logStream << ":" << placement.policyNode;
+        }
+        *logStream << ", local " << placement.localAccesses << ", remote " << placement.remoteAccesses << " ("
+             << (accesses > 0 ? static_cast<double>(placement.remoteAccesses) / accesses * 100 : 0.0) << "% remote), "
+             << placement.migrations << " pages migrated" << endl;
+        totalLocal += placement.localAccesses;
+        totalRemote += placement.remoteAccesses;
+        totalMigrations += placement.migrations;
+    }
+    if (exitedProcesses > 0)
+    {
+        uint64_t accesses = exitedPlacements.localAccesses + exitedPlacements.remoteAccesses;
+        *logStream << "  Exited Processes (" << exitedProcesses << "): local " << exitedPlacements.localAccesses << ", remote "
+             << exitedPlacements.remoteAccesses << " ("
+             << (accesses > 0 ? static_cast<double>(exitedPlacements.remoteAccesses) / accesses * 100 : 0.0) << "% remote), "
+             << exitedPlacements.migrations << " pages migrated" << endl;
+        totalLocal += exitedPlacements.localAccesses;
+        totalRemote += exitedPlacements.remoteAccesses;
+        totalMigrations += exitedPlacements.migrations;
+    }
+
+    uint64_t totalAccesses = totalLocal + totalRemote;
+    *logStream << "  Remote Access Ratio: " << (totalAccesses > 0 ? static_cast<double>(totalRemote) / totalAccesses * 100 : 0.0) << "%" << endl;
+    *logStream << "  Average NUMA Access Latency: "
+         << (totalAccesses > 0 ? static_cast<double>(totalLocal * localLatency + totalRemote * remoteLatency) / totalAccesses : 0.0)
+         << " ns" << endl;
+    *logStream << "  Balancing Migrations: " << totalMigrations << " (skipped, target node full: " << migrationFailures << ")" << endl;
+    *logStream << "  TLB Invalidations from Migration: " << tlbInvalidations << endl;
+    *logStream << endl;
+}
@@ -0,0 +1,82 @@
+#ifndef NUMAMANAGER_H
+#define NUMAMANAGER_H
+
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Placement policies, named after their Linux mempolicy counterparts
+enum class NumaPolicy
+{
+    FirstTouch, // Allocate on the node the process runs on, fall back to the other nodes
+    Interleave, // Allocate round-robin across all nodes
+    Preferred,  // Allocate on the policy node, fall back to the other nodes
+    Bind        // Allocate on the policy node only
+};
+
+// Tracks where processes run and which node their pages should come from,
+// counts local and remote accesses and decides when a page should follow its accessor
+class NumaManager
+{
+private:
+    struct ProcessPlacement
+    {
+        uint32_t homeNode;          // Node the process runs on
+        NumaPolicy policy;
+        uint32_t policyNode;        // Node used by the preferred and bind policies
+        uint32_t interleaveCursor;  // Next node for the interleave policy
+        uint64_t localAccesses;
+        uint64_t remoteAccesses;
+        uint64_t migrations;        // Pages migrated toward the home node
+    };
+
+    uint32_t nodeCount;
+    uint32_t localLatency;     // Access cost to the local node in ns
+    uint32_t remoteLatency;    // Access cost to a remote node in ns
+    uint32_t balanceThreshold; // Remote accesses before a page is migrated, 0 disables balancing
+
+    ProcessPlacement defaultPlacement;
+    std::vector<ProcessPlacement> placements;   // Indexed by pid, grown on demand
+    std::vector<uint16_t> frameRemoteAccesses;  // Remote accesses to each frame since it was mapped
+    std::vector<uint64_t> nodeLocalAccesses;    // Accesses served by each node to processes running on it
+    std::vector<uint64_t> nodeRemoteAccesses;   // Accesses served by each node to processes running elsewhere
+
+    ProcessPlacement exitedPlacements{}; // Access and migration counts of the processes that have exited
+    uint32_t exitedProcesses = 0;
+
+    uint64_t migrationFailures = 0; // Migrations skipped because the target node was full
+    uint64_t tlbInvalidations = 0;
+
+    ProcessPlacement &getPlacement(uint32_t pid);
+
+public:
+    NumaManager(uint32_t nodeCount, uint32_t totalFrames, uint32_t localLatency, uint32_t remoteLatency, uint32_t balanceThreshold);
+
+    // Parse "first-touch", "interleave", "preferred:<node>" or "bind:<node>"
+    static void parsePolicy(const std::string &value, NumaPolicy &policy, uint32_t &policyNode);
+    static std::string getPolicyName(NumaPolicy policy);
+
+    void setDefaultPolicy(NumaPolicy policy, uint32_t policyNode);
+    void setPolicy(uint32_t pid, NumaPolicy policy, uint32_t policyNode);
+    void setHomeNode(uint32_t pid, uint32_t node);
+    uint32_t getHomeNode(uint32_t pid);
+
+    // Nodes to allocate a new page of the process from, in order of preference
+    std::vector<uint32_t> getPlacementNodes(uint32_t pid);
+
+    // Count an access from a process to a frame on frameNode; returns true if the page should migrate to the home node
+    bool recordAccess(uint32_t pid, uint32_t frame, uint32_t frameNode);
+
+    // A frame got a new page, forget its remote access history
+    void resetFrame(uint32_t frame);
+
+    void recordMigration(uint32_t pid);
+    // Move the counts of a process that exits to the exited processes', a new process with its pid starts from zero
+    void removeProcess(uint32_t pid);
+    void recordMigrationFailure();
+    void recordTLBInvalidation();
+
+    void displayStatistics(const std::vector<uint32_t> &nodeFrames, const std::vector<uint32_t> &nodeFreeFrames) const;
+};
+
+#endif // NUMAMANAGER_H
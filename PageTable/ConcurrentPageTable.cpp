@@ -0,0 +1,285 @@
+#include "ConcurrentPageTable.h"
+#include <iostream>
+#include <stdexcept>
+#include "PageGeometry.h"
+#include "../Log/Log.h"
+
+using namespace std;
+
+ConcurrentPageTable::Level2Node::Level2Node(uint32_t size)
+    : entries(new atomic<uint64_t>[size]())
+{
+}
+
+ConcurrentPageTable::ConcurrentPageTable(uint32_t addressBits, uint32_t pageSize)
+    : addressBits(addressBits),
+      addressSpaceSize(1ULL << addressBits),
+      pageSize(pageSize),
+      residentPages(0),
+      level2NodesAllocated(0),
+      referenceUpdatesDropped(0)
+{
+    if (pageSize == 0 || addressSpaceSize % pageSize != 0)
+    {
+        throw invalid_argument("Address space size must be a multiple of page size");
+    }
+    int vpnBits = addressBits - static_cast<int>(getPageShift(pageSize));
+    l1Bits = vpnBits / 2;
+    l2Bits = vpnBits - l1Bits;
+    level1.reset(new atomic<Level2Node *>[1ULL << l1Bits]());
+}
+
+ConcurrentPageTable::~ConcurrentPageTable()
+{
+    for (uint64_t i = 0; i < (1ULL << l1Bits); i++)
+    {
+        delete level1[i].load(memory_order_relaxed);
+    }
+}
+
+uint32_t ConcurrentPageTable::getL1Index(uint32_t VPN) const
+{
+    return VPN >> l2Bits;
+}
+
+uint32_t ConcurrentPageTable::getL2Index(uint32_t VPN) const
+{
+    return VPN & ((1U << l2Bits) - 1);
+}
+
+bool ConcurrentPageTable::isValidRange(uint32_t VPN) const
+{
+    return VPN < addressSpaceSize / pageSize;
+}
+
+// Lookup without locks: two acquire loads and at most one relaxed CAS for the reference level
+int32_t ConcurrentPageTable::lookupPageTable(uint32_t VPN)
+{
+    PageTableEntry entry;
+    return lookupPageTableEntry(VPN, entry) ? static_cast<int32_t>(entry.getFrameNumber()) : -1;
+}
+
+bool ConcurrentPageTable::lookupPageTableEntry(uint32_t VPN, PageTableEntry &entry)
+{
+    if (!isValidRange(VPN))
+    {
+        *errorStream << "Invalid VPN: " << VPN << " Out of range" << endl;
+        return false;
+    }
+
+    EpochReclaimer::Guard guard(reclaimer);
+    Level2Node *node = level1[getL1Index(VPN)].load(memory_order_acquire);
+    if (!node)
+    {
+        return false;
+    }
+    atomic<uint64_t> &slot = node->entries[getL2Index(VPN)];
+    uint64_t packed = slot.load(memory_order_acquire);
+    if (!(packed & VALID_BIT))
+    {
+        return false;
+    }
+
+    // The reference level is only a replacement hint, so a single relaxed attempt is enough. If another
+    // thread changed the entry meanwhile the increment is dropped instead of retried
+    if ((packed & REFERENCE_MASK) != REFERENCE_MASK)
+    {
+        uint64_t expected = packed;
+        if (!slot.compare_exchange_strong(expected, packed + (1ULL << REFERENCE_SHIFT), memory_order_relaxed))
+        {
+            referenceUpdatesDropped.fetch_add(1, memory_order_relaxed);
+        }
+    }
+    entry = PageTableEntry::fromBits(packed);
+    return true;
+}
+
+ConcurrentPageTable::Level2Node *ConcurrentPageTable::acquireNode(uint32_t l1Index, bool create)
+{
+    Level2Node *node = level1[l1Index].load(memory_order_acquire);
+    if (node || !create)
+    {
+        return node;
+    }
+
+    // Install a fresh node, a thread that loses the race uses the winner's node
+    Level2Node *fresh = new Level2Node(1U << l2Bits);
+    if (level1[l1Index].compare_exchange_strong(node, fresh, memory_order_acq_rel))
+    {
+        level2NodesAllocated.fetch_add(1, memory_order_relaxed);
+        return fresh;
+    }
+    delete fresh;
+    return node;
+}
+
+bool ConcurrentPageTable::storeEntry(Level2Node *node, uint32_t l1Index, uint32_t l2Index, uint64_t packed, uint64_t &previous)
+{
+    lock_guard<mutex> lock(node->lock);
+    if (node->detached)
+    {
+        return false;
+    }
+
+    previous = node->entries[l2Index].load(memory_order_relaxed);
+    node->entries[l2Index].store(packed, memory_order_release);
+
+    bool wasValid = (previous & VALID_BIT) != 0;
+    bool isValid = (packed & VALID_BIT) != 0;
+    if (isValid && !wasValid)
+    {
+        node->validEntries++;
+        residentPages.fetch_add(1, memory_order_relaxed);
+    }
+    else if (wasValid && !isValid)
+    {
+        node->validEntries--;
+        residentPages.fetch_sub(1, memory_order_relaxed);
+    }
+
+    if (node->validEntries == 0)
+    {
+        detachNode(node, l1Index);
+    }
+    return true;
+}
+
+void ConcurrentPageTable::detachNode(Level2Node *node, uint32_t l1Index)
+{
+    node->detached = true;
+    level1[l1Index].store(nullptr, memory_order_release);
+    level2NodesAllocated.fetch_sub(1, memory_order_relaxed);
+    reclaimer.retire(node, deleteNode);
+    reclaimer.reclaim();
+}
+
+void ConcurrentPageTable::deleteNode(void *node)
+{
+    delete static_cast<Level2Node *>(node);
+}
+
+void ConcurrentPageTable::updatePageTable(uint32_t VPN, uint32_t frameNumber, bool valid, bool dirty, bool read, bool write, bool execute, uint8_t reference)
+{
+    if (!isValidRange(VPN))
+    {
+        *errorStream << "Invalid VPN: " << VPN << " Out of range" << endl;
+        return;
+    }
+
+    uint64_t packed = PageTableEntry(frameNumber, valid, dirty, read, write, execute, reference).getBits();
+    uint32_t l1Index = getL1Index(VPN);
+    uint32_t l2Index = getL2Index(VPN);
+
+    EpochReclaimer::Guard guard(reclaimer);
+    while (true)
+    {
+        // An invalid entry in a missing node is already what the caller asked for
+        Level2Node *node = acquireNode(l1Index, valid);
+        if (!node)
+        {
+            return;
+        }
+        uint64_t previous;
+        if (storeEntry(node, l1Index, l2Index, packed, previous))
+        {
+            return;
+        }
+        // The node was emptied and unlinked while we waited for its lock, retry with a new one
+    }
+}
+
+int ConcurrentPageTable::removeAddressForOneEntry(uint32_t VPN)
+{
+    if (!isValidRange(VPN))
+    {
+        *errorStream << "Invalid VPN: " << VPN << " Out of range" << endl;
+        return -1;
+    }
+
+    uint32_t l1Index = getL1Index(VPN);
+    uint32_t l2Index = getL2Index(VPN);
+
+    EpochReclaimer::Guard guard(reclaimer);
+    Level2Node *node = acquireNode(l1Index, false);
+    uint64_t previous = 0;
+    if (!node || !storeEntry(node, l1Index, l2Index, 0, previous) || !(previous & VALID_BIT))
+    {
+        // An unlinked node had no valid entries left, so the VPN was not mapped either way
+        *errorStream << "Error: VPN " << VPN << " not found in the page table" << endl;
+        return -1;
+    }
+    return static_cast<int>(static_cast<uint32_t>(previous));
+}
+
+// Sweep the VPN space like the clock hand over a circular list. Pages with a reference level lose one
+// step per pass, the first page found at level 0 is evicted. Missing nodes are skipped as a whole
+int ConcurrentPageTable::evictPageUsingClockAlgo(uint32_t &victimVPN)
+{
+    lock_guard<mutex> clock(clockLock);
+    EpochReclaimer::Guard guard(reclaimer);
+
+    uint64_t totalVPNs = addressSpaceSize / pageSize;
+    // Four passes clear the highest reference level, one more finds the victim
+    uint64_t budget = 5 * totalVPNs;
+    while (budget > 0 && residentPages.load(memory_order_relaxed) > 0)
+    {
+        uint32_t VPN = clockHand;
+        uint32_t l1Index = getL1Index(VPN);
+        Level2Node *node = level1[l1Index].load(memory_order_acquire);
+        if (!node)
+        {
+            uint64_t next = static_cast<uint64_t>(l1Index + 1) << l2Bits;
+            budget -= min<uint64_t>(budget, next - VPN);
+            clockHand = static_cast<uint32_t>(next % totalVPNs);
+            continue;
+        }
+        clockHand = static_cast<uint32_t>((VPN + 1ULL) % totalVPNs);
+        budget--;
+
+        atomic<uint64_t> &slot = node->entries[getL2Index(VPN)];
+        uint64_t packed = slot.load(memory_order_acquire);
+        if (!(packed & VALID_BIT))
+        {
+            continue;
+        }
+        if (packed & REFERENCE_MASK)
+        {
+            // Losing the race to a reader only means the page stays referenced for another pass
+            slot.compare_exchange_strong(packed, packed - (1ULL << REFERENCE_SHIFT), memory_order_relaxed);
+            continue;
+        }
+
+        lock_guard<mutex> lock(node->lock);
+        // Readers raise the reference level without the lock, so the entry is only cleared if it is unchanged
+        if (node->detached || !slot.compare_exchange_strong(packed, 0, memory_order_acq_rel))
+        {
+            continue; // Remapped or referenced since we looked, move on
+        }
+        node->validEntries--;
+        residentPages.fetch_sub(1, memory_order_relaxed);
+        if (node->validEntries == 0)
+        {
+            detachNode(node, l1Index);
+        }
+        victimVPN = VPN;
+        return static_cast<int>(static_cast<uint32_t>(packed));
+    }
+    return -1;
+}
+
+uint32_t ConcurrentPageTable::getResidentPages() const
+{
+    return residentPages.load(memory_order_relaxed);
+}
+
+void ConcurrentPageTable::displayStatistics() const
+{
+    *logStream << "Concurrent Page Table Statistics:" << endl;
+    *logStream << "  Resident Pages: " << getResidentPages() << endl;
+    *logStream << "  L2 Nodes Allocated: " << level2NodesAllocated.load(memory_order_relaxed)
+               << " (" << (1U << l2Bits) * sizeof(uint64_t) << " bytes each)" << endl;
+    *logStream << "  Reference Updates Dropped: " << referenceUpdatesDropped.load(memory_order_relaxed) << endl;
+    *logStream << "  L2 Nodes Retired: " << reclaimer.getRetiredCount()
+               << ", reclaimed: " << reclaimer.getReclaimedCount() << endl;
+    *logStream << endl;
+}
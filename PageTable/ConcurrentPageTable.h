@@ -0,0 +1,95 @@
+#ifndef CONCURRENTPAGETABLE_H
+#define CONCURRENTPAGETABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include "PageTableEntry.h"
+#include "helperFiles/EpochReclaimer.h"
+
+// Two-level page table that several threads can translate through while others map and unmap pages.
+// The first level is an array of atomic pointers to second-level nodes and every entry is packed into
+// one atomic word, so lookups never lock or wait. Updates lock the node they change, empty nodes are
+// unlinked and freed through epoch-based reclamation once no reader can still hold them
+class ConcurrentPageTable
+{
+private:
+    // Second-level node covering 2^l2Bits consecutive VPNs
+    struct Level2Node
+    {
+        std::mutex lock;
+        bool detached = false; // Set under the lock once the node is unlinked from the first level
+        uint32_t validEntries = 0;
+        std::unique_ptr<std::atomic<uint64_t>[]> entries;
+
+        explicit Level2Node(uint32_t size);
+    };
+
+    // Entries are stored as PageTableEntry's packed word
+    static const uint64_t VALID_BIT = PageTableEntry::VALID_BIT;
+    static const int REFERENCE_SHIFT = PageTableEntry::REFERENCE_SHIFT;
+    static const uint64_t REFERENCE_MASK = PageTableEntry::REFERENCE_MASK;
+
+    uint32_t addressBits;
+    uint64_t addressSpaceSize;
+    uint32_t pageSize;
+    int l1Bits;
+    int l2Bits;
+
+    std::unique_ptr<std::atomic<Level2Node *>[]> level1;
+    EpochReclaimer reclaimer;
+
+    std::atomic<uint32_t> residentPages;
+    std::atomic<uint32_t> level2NodesAllocated;
+    std::atomic<uint64_t> referenceUpdatesDropped;
+
+    // Clock hand over the VPN space, eviction scans are serialized by clockLock
+    std::mutex clockLock;
+    uint32_t clockHand = 0;
+
+    uint32_t getL1Index(uint32_t VPN) const;
+    uint32_t getL2Index(uint32_t VPN) const;
+
+    // Get the node for a first-level index, installing a new one if create is set
+    Level2Node *acquireNode(uint32_t l1Index, bool create);
+
+    // Store a new packed value under the node lock, returns false if the node was unlinked meanwhile
+    bool storeEntry(Level2Node *node, uint32_t l1Index, uint32_t l2Index, uint64_t packed, uint64_t &previous);
+
+    // Unlink an empty node and hand it to the reclaimer, called with the node lock held
+    void detachNode(Level2Node *node, uint32_t l1Index);
+
+    static void deleteNode(void *node);
+
+public:
+    ConcurrentPageTable(uint32_t addressBits, uint32_t pageSize);
+    ~ConcurrentPageTable();
+
+    ConcurrentPageTable(const ConcurrentPageTable &) = delete;
+    ConcurrentPageTable &operator=(const ConcurrentPageTable &) = delete;
+
+    // Wait-free lookup returning the frame number or -1 if not found, raises the reference level
+    int32_t lookupPageTable(uint32_t VPN);
+
+    // Same lookup, copying the entry so callers can check its permissions, returns false if not found
+    bool lookupPageTableEntry(uint32_t VPN, PageTableEntry &entry);
+
+    // Update the page table with a new or existing entry
+    void updatePageTable(uint32_t VPN, uint32_t frameNumber, bool valid, bool dirty, bool read, bool write, bool execute, uint8_t reference);
+
+    // Remove the entry for one VPN, returning its frame number or -1 if it was not mapped
+    int removeAddressForOneEntry(uint32_t VPN);
+
+    // Evict a page selected by the clock algorithm, returning its frame number or -1 if no page can be evicted
+    int evictPageUsingClockAlgo(uint32_t &victimVPN);
+
+    // Get the number of pages currently resident in memory
+    uint32_t getResidentPages() const;
+
+    bool isValidRange(uint32_t VPN) const;
+
+    void displayStatistics() const;
+};
+
+#endif // CONCURRENTPAGETABLE_H
@@ -0,0 +1,234 @@
+#include "InvertedPageTable.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "../Log/Log.h"
+
+using namespace std;
+
+InvertedPageTable::InvertedPageTable(uint32_t physicalFrames)
+{
+    uint64_t neededBuckets = (static_cast<uint64_t>(physicalFrames) * 4 / 3 + SLOTS_PER_BUCKET - 1) / SLOTS_PER_BUCKET;
+    uint64_t buckets = 1;
+    while (buckets < neededBuckets)
+    {
+        buckets <<= 1;
+    }
+    slots.assign(buckets * SLOTS_PER_BUCKET, Slot{EMPTY_PID, 0, PageTableEntry()});
+    bucketMask = buckets - 1;
+}
+
+uint64_t InvertedPageTable::getHomeBucket(uint32_t pid, uint32_t vpn) const
+{
+    // 64-bit finalizer of MurmurHash3, neighbouring VPNs land in unrelated buckets
+    uint64_t key = static_cast<uint64_t>(pid) << 32 | vpn;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return key & bucketMask;
+}
+
+// Probe from the home bucket; a bucket with an empty slot ends the walk, inserts never skip one
+InvertedPageTable::Slot *InvertedPageTable::findSlot(uint32_t pid, uint32_t vpn)
+{
+    lastHomeBucket = getHomeBucket(pid, vpn);
+    lastProbes = 0;
+    for (uint64_t bucket = lastHomeBucket; lastProbes <= bucketMask; bucket = (bucket + 1) & bucketMask)
+    {
+        lastProbes++;
+        Slot *slot = &slots[bucket * SLOTS_PER_BUCKET];
+        bool hasEmptySlot = false;
+        for (uint32_t i = 0; i < SLOTS_PER_BUCKET; i++)
+        {
+            if (slot[i].pid == pid && slot[i].vpn == vpn)
+            {
+                return &slot[i];
+            }
+            hasEmptySlot = hasEmptySlot || slot[i].pid == EMPTY_PID;
+        }
+        if (hasEmptySlot)
+        {
+            break;
+        }
+    }
+    return nullptr;
+}
+
+PageTableEntry *InvertedPageTable::find(uint32_t pid, uint32_t vpn)
+{
+    Slot *slot = findSlot(pid, vpn);
+    return slot && slot->entry.isValid() ? &slot->entry : nullptr;
+}
+
+void InvertedPageTable::recordWalk()
+{
+    walks++;
+    probedBuckets += lastProbes;
+    longestWalk = max(longestWalk, lastProbes);
+}
+
+PageTableEntry &InvertedPageTable::insert(uint32_t pid, uint32_t vpn)
+{
+    if (pid >= TOMBSTONE_PID)
+    {
+        throw invalid_argument("Process ID " + to_string(pid) + " is reserved by the hashed page table");
+    }
+    Slot *existing = findSlot(pid, vpn);
+    if (existing)
+    {
+        return existing->entry;
+    }
+
+    // Keep at least an eighth of the slots empty so walks end. Past the load the table was sized for, e.g.
+    // with frames shared after fork, it grows, otherwise dropping the tombstones is enough
+    uint64_t capacity = slots.size();
+    if ((usedSlots + tombstones + 1) * 8ULL > capacity * 7)
+    {
+        if ((usedSlots + 1) * 4ULL > capacity * 3)
+        {
+            rehash((bucketMask + 1) * 2);
+            resizes++;
+        }
+        else
+        {
+            rehash(bucketMask + 1);
+            rehashes++;
+        }
+    }
+
+    for (uint64_t bucket = getHomeBucket(pid, vpn);; bucket = (bucket + 1) & bucketMask)
+    {
+        Slot *slot = &slots[bucket * SLOTS_PER_BUCKET];
+        for (uint32_t i = 0; i < SLOTS_PER_BUCKET; i++)
+        {
+            if (slot[i].pid == EMPTY_PID || slot[i].pid == TOMBSTONE_PID)
+            {
+                if (slot[i].pid == TOMBSTONE_PID)
+                {
+                    tombstones--;
+                }
+                slot[i] = Slot{pid, vpn, PageTableEntry()};
+                usedSlots++;
+                peakEntries = max(peakEntries, usedSlots);
+                return slot[i].entry;
+            }
+        }
+    }
+}
+
+void InvertedPageTable::rehash(uint64_t buckets)
+{
+    vector<Slot> old(buckets * SLOTS_PER_BUCKET, Slot{EMPTY_PID, 0, PageTableEntry()});
+    old.swap(slots);
+    bucketMask = buckets - 1;
+    tombstones = 0;
+    for (const Slot &slot : old)
+    {
+        if (slot.pid == EMPTY_PID || slot.pid == TOMBSTONE_PID)
+        {
+            continue;
+        }
+        for (uint64_t bucket = getHomeBucket(slot.pid, slot.vpn);; bucket = (bucket + 1) & bucketMask)
+        {
+            Slot *target = &slots[bucket * SLOTS_PER_BUCKET];
+            Slot *end = target + SLOTS_PER_BUCKET;
+            Slot *free = find_if(target, end, [](const Slot &candidate) { return candidate.pid == EMPTY_PID; });
+            if (free != end)
+            {
+                *free = slot;
+                break;
+            }
+        }
+    }
+}
+
+void InvertedPageTable::eraseSlot(Slot &slot)
+{
+    slot = Slot{TOMBSTONE_PID, 0, PageTableEntry()};
+    usedSlots--;
+    tombstones++;
+}
+
+bool InvertedPageTable::erase(uint32_t pid, uint32_t vpn)
+{
+    Slot *slot = findSlot(pid, vpn);
+    if (!slot)
+    {
+        return false;
+    }
+    eraseSlot(*slot);
+    return true;
+}
+
+// A range wider than the table holds entries is cheaper to find by scanning the table than VPN by VPN
+void InvertedPageTable::eraseRange(uint32_t pid, uint32_t firstVPN, uint64_t endVPN, vector<pair<uint32_t, uint32_t>> &removed)
+{
+    if (endVPN - firstVPN > usedSlots)
+    {
+        for (Slot &slot : slots)
+        {
+            if (slot.pid == pid && slot.vpn >= firstVPN && slot.vpn < endVPN && slot.entry.isValid())
+            {
+                removed.emplace_back(slot.vpn, slot.entry.getFrameNumber());
+                eraseSlot(slot);
+            }
+        }
+        return;
+    }
+    for (uint64_t vpn = firstVPN; vpn < endVPN; vpn++)
+    {
+        Slot *slot = findSlot(pid, static_cast<uint32_t>(vpn));
+        if (slot && slot->entry.isValid())
+        {
+            removed.emplace_back(slot->vpn, slot->entry.getFrameNumber());
+            eraseSlot(*slot);
+        }
+    }
+}
+
+void InvertedPageTable::eraseProcess(uint32_t pid, uint32_t entries)
+{
+    for (auto it = slots.begin(); entries > 0 && it != slots.end(); ++it)
+    {
+        if (it->pid == pid)
+        {
+            eraseSlot(*it);
+            entries--;
+        }
+    }
+}
+
+void InvertedPageTable::forEachEntry(uint32_t pid, const function<void(uint32_t vpn, const PageTableEntry &entry)> &visit) const
+{
+    for (const Slot &slot : slots)
+    {
+        if (slot.pid == pid && slot.entry.isValid())
+        {
+            visit(slot.vpn, slot.entry);
+        }
+    }
+}
+
+uint32_t InvertedPageTable::getEntries() const
+{
+    return usedSlots;
+}
+
+uint64_t InvertedPageTable::getMemoryUsage() const
+{
+    return slots.size() * sizeof(Slot);
+}
+
+void InvertedPageTable::displayStatistics() const
+{
+    *logStream << "--- Hashed Page Table ---" << endl;
+    *logStream << "  Buckets: " << bucketMask + 1 << " of " << BUCKET_BYTES << " bytes (" << SLOTS_PER_BUCKET
+               << " entries each), " << getMemoryUsage() << " bytes" << endl;
+    *logStream << "  Entries: " << usedSlots << " (peak " << peakEntries << "), load factor "
+               << static_cast<double>(usedSlots) / slots.size() * 100 << "%" << endl;
+    *logStream << "  Walks: " << walks << ", average buckets probed: "
+               << (walks > 0 ? static_cast<double>(probedBuckets) / walks : 0.0) << ", longest walk: " << longestWalk << endl;
+    *logStream << "  Resizes: " << resizes << ", tombstone rehashes: " << rehashes << endl;
+}
@@ -0,0 +1,89 @@
+#ifndef INVERTEDPAGETABLE_H
+#define INVERTEDPAGETABLE_H
+
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "PageTableEntry.h"
+
+// Hashed inverted page table shared by all processes: one open-addressing hash table keyed by (pid, VPN),
+// sized to physical memory instead of to the virtual address spaces. Slots are grouped into buckets of one
+// cache line, a walk probes buckets linearly from the key's home bucket until it finds the key or a bucket
+// with an empty slot. Removed keys leave tombstones, which the next rehash drops. Entries only move on a
+// rehash, which only an insert can trigger
+class InvertedPageTable
+{
+public:
+    static const uint32_t SLOTS_PER_BUCKET = 4;
+    static const uint32_t BUCKET_BYTES = 64;
+
+private:
+    static const uint32_t EMPTY_PID = UINT32_MAX;
+    static const uint32_t TOMBSTONE_PID = UINT32_MAX - 1;
+
+    struct Slot
+    {
+        uint32_t pid;
+        uint32_t vpn;
+        PageTableEntry entry;
+    };
+    static_assert(sizeof(Slot) * SLOTS_PER_BUCKET == BUCKET_BYTES, "A bucket is one cache line");
+
+    std::vector<Slot> slots;
+    uint64_t bucketMask;
+    uint32_t usedSlots = 0;
+    uint32_t tombstones = 0;
+
+    // The last walk, for the cache model
+    uint64_t lastHomeBucket = 0;
+    uint32_t lastProbes = 0;
+
+    // Statistics
+    uint64_t walks = 0;
+    uint64_t probedBuckets = 0;
+    uint32_t longestWalk = 0;
+    uint32_t peakEntries = 0;
+    uint32_t resizes = 0;
+    uint32_t rehashes = 0;
+
+    uint64_t getHomeBucket(uint32_t pid, uint32_t vpn) const;
+    Slot *findSlot(uint32_t pid, uint32_t vpn);
+    void rehash(uint64_t buckets);
+    void eraseSlot(Slot &slot);
+
+public:
+    // Enough buckets for the given frames at most three quarters full
+    explicit InvertedPageTable(uint32_t physicalFrames);
+
+    // The valid entry of a page, or nullptr
+    PageTableEntry *find(uint32_t pid, uint32_t vpn);
+
+    // Count the last find as a hardware walk of the table
+    void recordWalk();
+
+    // The entry of a page, inserted invalid if it is not there. May rehash, moving every entry
+    PageTableEntry &insert(uint32_t pid, uint32_t vpn);
+
+    // Returns false if the page had no entry
+    bool erase(uint32_t pid, uint32_t vpn);
+
+    // Remove the valid entries of a process in [firstVPN, endVPN), appending each VPN and its frame to removed
+    void eraseRange(uint32_t pid, uint32_t firstVPN, uint64_t endVPN, std::vector<std::pair<uint32_t, uint32_t>> &removed);
+
+    // Remove every entry of a process, given how many it has so the scan can stop early
+    void eraseProcess(uint32_t pid, uint32_t entries);
+
+    void forEachEntry(uint32_t pid, const std::function<void(uint32_t vpn, const PageTableEntry &entry)> &visit) const;
+
+    // The buckets the last walk probed, in order: the home bucket and the ones after it
+    uint64_t getLastHomeBucket() const { return lastHomeBucket; }
+    uint32_t getLastProbes() const { return lastProbes; }
+    uint64_t getBucketCount() const { return bucketMask + 1; }
+
+    uint32_t getEntries() const;
+    uint64_t getMemoryUsage() const;
+    void displayStatistics() const;
+};
+
+#endif // INVERTEDPAGETABLE_H
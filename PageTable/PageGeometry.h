@@ -0,0 +1,62 @@
+#ifndef PAGEGEOMETRY_H
+#define PAGEGEOMETRY_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+// Bits of the page offset, computed exactly instead of through floating-point logarithms
+inline uint32_t getPageShift(uint64_t pageSize)
+{
+    if (pageSize == 0 || (pageSize & (pageSize - 1)) != 0)
+    {
+        throw std::invalid_argument("Page size must be a power of two, not " + std::to_string(pageSize));
+    }
+    uint32_t shift = 0;
+    while ((1ULL << shift) < pageSize)
+    {
+        shift++;
+    }
+    return shift;
+}
+
+// Split of an address between page offset and the two page table levels, known at compile time. The walks
+// of the common geometries are instantiated with one, so their shifts, masks and range check are constants
+template <uint32_t PageShift, uint32_t AddressBits>
+struct FixedPageGeometry
+{
+    static const uint32_t VPN_BITS = AddressBits - PageShift;
+    static const uint32_t L2_BITS = VPN_BITS - VPN_BITS / 2;
+    static const uint32_t L2_MASK = (1U << L2_BITS) - 1;
+    static const uint64_t VPN_COUNT = 1ULL << VPN_BITS;
+};
+
+// Geometries with a specialized walk, anything else takes the generic one
+enum class WalkGeometry
+{
+    Generic,
+    Pages4K32,  // 4 KB pages, 32-bit addresses
+    Pages16K32, // 16 KB pages, 32-bit addresses
+    Pages64K32  // 64 KB pages, 32-bit addresses
+};
+
+inline WalkGeometry getWalkGeometry(uint32_t pageShift, uint32_t addressBits)
+{
+    if (addressBits != 32)
+    {
+        return WalkGeometry::Generic;
+    }
+    switch (pageShift)
+    {
+    case 12:
+        return WalkGeometry::Pages4K32;
+    case 14:
+        return WalkGeometry::Pages16K32;
+    case 16:
+        return WalkGeometry::Pages64K32;
+    default:
+        return WalkGeometry::Generic;
+    }
+}
+
+#endif // PAGEGEOMETRY_H
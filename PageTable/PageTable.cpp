@@ -1,6 +1,9 @@
-#include <unordered_map>
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
+#include <unordered_map>
+#include "../Log/Log.h"
+#include "../Profiler/Profiler.h"
 #include <list>
 #include <unordered_set>
 #include "helperFiles/ClockAlgorithm.h"
@@ -20,71 +23,489 @@ uint32_t PageTable::getL2Index(uint32_t VPN)
     return VPN & ((1 << l2Bits) - 1); // Get the last l2Bits
 }
 
-// Helper function to check and create a second-level map if necessary
-unordered_map<uint32_t, PageTableEntry> &PageTable::checkL2(uint32_t l1Index)
+uint32_t PageTable::getSparseLimit(int bits)
+{
+    uint32_t limit = (1U << bits) / 32;
+    return limit >= MIN_SPARSE_SLOTS ? limit : 0;
+}
+
+// Sparse levels grow by doubling, so adding to a full one costs amortized constant copies
+uint32_t PageTable::getSparseCapacity(uint32_t used, uint32_t limit)
+{
+    if (used > limit)
+    {
+        return 0;
+    }
+    uint32_t capacity = MIN_SPARSE_SLOTS;
+    while (capacity < used)
+    {
+        capacity *= 2;
+    }
+    return capacity;
+}
+
+// Binary search whose halving compiles to conditional moves, walks hit random slots and would mispredict
+// the branches of a plain one
+uint32_t PageTable::findSlot(const uint32_t *indices, uint32_t count, uint32_t index)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+    const uint32_t *base = indices;
+    while (count > 1)
+    {
+        uint32_t half = count / 2;
+        base = base[half] <= index ? base + half : base;
+        count -= half;
+    }
+    return *base == index ? base - indices : UINT32_MAX;
+}
+
+inline PageTable::Level2Table *PageTable::findL2(uint32_t l1Index) const
+{
+    if (pageTable)
+    {
+        return pageTable[l1Index];
+    }
+    uint32_t slot = findSlot(level1Indices, level2Tables, l1Index);
+    return slot < level2Tables ? level1Tables[slot] : nullptr;
+}
+
+// Visit the second-level tables in first-level order
+template <typename Visit>
+void PageTable::forEachL2(Visit visit) const
+{
+    if (pageTable)
+    {
+        for (uint32_t l1Index = 0; l1Index < 1U << l1Bits; l1Index++)
+        {
+            if (pageTable[l1Index])
+            {
+                visit(l1Index, pageTable[l1Index]);
+            }
+        }
+        return;
+    }
+    for (uint32_t slot = 0; slot < level2Tables; slot++)
+    {
+        visit(level1Indices[slot], level1Tables[slot]);
+    }
+}
+
+void PageTable::insertL2(uint32_t l1Index, Level2Table *l2Table)
+{
+    if (!pageTable && level2Tables == level1Capacity)
+    {
+        resizeL1(level2Tables + 1);
+    }
+    if (pageTable)
+    {
+        pageTable[l1Index] = l2Table;
+    }
+    else
+    {
+        uint32_t *end = level1Indices + level2Tables;
+        uint32_t *position = lower_bound(level1Indices, end, l1Index);
+        uint32_t slot = position - level1Indices;
+        move_backward(position, end, end + 1);
+        move_backward(level1Tables + slot, level1Tables + level2Tables, level1Tables + level2Tables + 1);
+        *position = l1Index;
+        level1Tables[slot] = l2Table;
+    }
+    level2Tables++;
+}
+
+void PageTable::replaceL2(uint32_t l1Index, Level2Table *l2Table)
+{
+    if (pageTable)
+    {
+        pageTable[l1Index] = l2Table;
+    }
+    else
+    {
+        level1Tables[findSlot(level1Indices, level2Tables, l1Index)] = l2Table;
+    }
+}
+
+void PageTable::removeL2(uint32_t l1Index)
+{
+    if (pageTable)
+    {
+        pageTable[l1Index] = nullptr;
+    }
+    else
+    {
+        uint32_t *end = level1Indices + level2Tables;
+        uint32_t *position = lower_bound(level1Indices, end, l1Index);
+        uint32_t slot = position - level1Indices;
+        move(position + 1, end, position);
+        move(level1Tables + slot + 1, level1Tables + level2Tables, level1Tables + slot);
+    }
+    resizeL1(--level2Tables);
+}
+
+// Move the level2Tables tables there are to the first level laid out for tables of them, if that is another
+// layout or size
+void PageTable::resizeL1(uint32_t tables)
+{
+    uint32_t capacity = tables == 0 ? 0 : getSparseCapacity(tables, level1SparseLimit);
+    bool dense = tables > 0 && capacity == 0;
+    if (dense ? pageTable != nullptr : !pageTable && capacity == level1Capacity)
+    {
+        return;
+    }
+    Level2Table **densePointers = nullptr;
+    uint32_t *indices = nullptr;
+    Level2Table **sparseTables = nullptr;
+    if (dense)
+    {
+        densePointers = level1Allocator.allocate(1ULL << l1Bits);
+        uninitialized_fill_n(densePointers, 1ULL << l1Bits, nullptr);
+    }
+    else if (capacity > 0)
+    {
+        indices = indexAllocator.allocate(capacity);
+        sparseTables = level1Allocator.allocate(capacity);
+    }
+    uint32_t slots = 0;
+    auto keep = [&](uint32_t l1Index, Level2Table *l2Table) {
+        if (dense)
+        {
+            densePointers[l1Index] = l2Table;
+            return;
+        }
+        indices[slots] = l1Index;
+        sparseTables[slots++] = l2Table;
+    };
+    if (pageTable)
+    {
+        for (uint32_t l1Index = 0; l1Index < 1U << l1Bits; l1Index++)
+        {
+            if (pageTable[l1Index])
+            {
+                keep(l1Index, pageTable[l1Index]);
+            }
+        }
+    }
+    else
+    {
+        for (uint32_t slot = 0; slot < level2Tables; slot++)
+        {
+            keep(level1Indices[slot], level1Tables[slot]);
+        }
+    }
+    freeLevel1();
+    pageTable = densePointers;
+    level1Indices = indices;
+    level1Tables = sparseTables;
+    level1Capacity = capacity;
+}
+
+void PageTable::freeLevel1()
+{
+    if (pageTable)
+    {
+        level1Allocator.deallocate(pageTable, 1ULL << l1Bits);
+        pageTable = nullptr;
+    }
+    else if (level1Capacity > 0)
+    {
+        indexAllocator.deallocate(level1Indices, level1Capacity);
+        level1Allocator.deallocate(level1Tables, level1Capacity);
+        level1Indices = nullptr;
+        level1Tables = nullptr;
+        level1Capacity = 0;
+    }
+}
+
+uint64_t PageTable::getLevel1Bytes(uint32_t tables) const
+{
+    uint32_t capacity = tables == 0 ? 0 : getSparseCapacity(tables, level1SparseLimit);
+    if (tables > 0 && capacity == 0)
+    {
+        return (1ULL << l1Bits) * sizeof(Level2Table *);
+    }
+    return static_cast<uint64_t>(capacity) * (sizeof(uint32_t) + sizeof(Level2Table *));
+}
+
+// Helper function to check and create a second-level table if necessary
+PageTable::Level2Table *PageTable::checkL2(uint32_t l1Index)
 {
-    if (pageTable.find(l1Index) == pageTable.end()) // If the first level map does not exist
+    Level2Table *l2Table = findL2(l1Index);
+    if (!l2Table) // If the second-level table does not exist
     {
-        pageTable[l1Index] = unordered_map<uint32_t, PageTableEntry>(); // Create a new second-level map
+        // Create a new second-level table, laid out for its first page
+        l2Table = allocateL2(getLevel2Capacity(1));
+        insertL2(l1Index, l2Table);
         level1EntriesAllocated++; // Increment L1 counter when a new L1 entry is allocated
     }
-    return pageTable[l1Index]; // Return the second-level map
+    return l2Table; // Return the second-level table
+}
+
+// Entries are trivially destructible, the table only goes back to the arena. Like the second-level
+// tables, the first level goes with the last mapped page
+void PageTable::freeL2(uint32_t l1Index)
+{
+    deallocateL2(findL2(l1Index));
+    removeL2(l1Index);
+}
+
+PageTable::Level2Table *PageTable::allocateL2(uint32_t capacity)
+{
+    uint64_t bytes = getLevel2Bytes(capacity);
+    Level2Table *l2Table = reinterpret_cast<Level2Table *>(tableAllocator.allocate(bytes / sizeof(PageTableEntry)));
+    l2Table->validEntries = 0;
+    l2Table->slots = 0;
+    l2Table->capacity = capacity;
+    if (capacity == 0)
+    {
+        uninitialized_fill_n(l2Table->getEntries(), 1U << l2Bits, PageTableEntry());
+    }
+    level2Bytes += bytes;
+    return l2Table;
+}
+
+void PageTable::deallocateL2(Level2Table *l2Table)
+{
+    uint64_t bytes = getLevel2Bytes(l2Table->capacity);
+    tableAllocator.deallocate(reinterpret_cast<PageTableEntry *>(l2Table), bytes / sizeof(PageTableEntry));
+    level2Bytes -= bytes;
+}
+
+uint32_t PageTable::getLevel2Capacity(uint32_t validEntries) const
+{
+    return getSparseCapacity(validEntries, sparseLimit);
+}
+
+uint64_t PageTable::getLevel2Bytes(uint32_t capacity) const
+{
+    if (capacity == 0)
+    {
+        return sizeof(Level2Table) + (1ULL << l2Bits) * sizeof(PageTableEntry);
+    }
+    return sizeof(Level2Table) + static_cast<uint64_t>(capacity) * (sizeof(uint32_t) + sizeof(PageTableEntry));
+}
+
+PageTable::Level2Table *PageTable::resizeL2(uint32_t l1Index, Level2Table *l2Table, uint32_t validEntries)
+{
+    uint32_t capacity = getLevel2Capacity(validEntries);
+    if (capacity == 0 && l2Table->capacity == 0)
+    {
+        return l2Table; // dense tables keep their invalid entries
+    }
+    // a sparse table that keeps its size drops its invalid slots in place
+    Level2Table *resized = capacity == l2Table->capacity ? l2Table : allocateL2(capacity);
+    PageTableEntry *entries = resized->getEntries();
+    uint32_t *indices = resized->getIndices();
+    uint32_t slots = 0;
+    auto keep = [&](uint32_t l2Index, const PageTableEntry &entry) {
+        if (capacity == 0)
+        {
+            entries[l2Index] = entry;
+            return;
+        }
+        indices[slots] = l2Index;
+        entries[slots++] = entry;
+    };
+    const PageTableEntry *oldEntries = l2Table->getEntries();
+    if (l2Table->capacity == 0)
+    {
+        for (uint32_t l2Index = 0; l2Index < 1U << l2Bits; l2Index++)
+        {
+            if (oldEntries[l2Index].isValid())
+            {
+                keep(l2Index, oldEntries[l2Index]);
+            }
+        }
+    }
+    else
+    {
+        const uint32_t *oldIndices = l2Table->getIndices();
+        for (uint32_t slot = 0; slot < l2Table->slots; slot++)
+        {
+            if (oldEntries[slot].isValid())
+            {
+                keep(oldIndices[slot], oldEntries[slot]);
+            }
+        }
+    }
+    resized->validEntries = l2Table->validEntries;
+    resized->slots = slots;
+    if (resized != l2Table)
+    {
+        deallocateL2(l2Table);
+        replaceL2(l1Index, resized);
+    }
+    return resized;
+}
+
+inline PageTableEntry *PageTable::findEntry(Level2Table &l2Table, uint32_t l2Index)
+{
+    PageTableEntry *entries = l2Table.getEntries();
+    if (l2Table.capacity == 0)
+    {
+        return &entries[l2Index];
+    }
+    uint32_t slot = findSlot(l2Table.getIndices(), l2Table.slots, l2Index);
+    return slot < l2Table.slots ? &entries[slot] : nullptr;
+}
+
+PageTableEntry &PageTable::insertEntry(uint32_t l1Index, Level2Table *l2Table, uint32_t l2Index)
+{
+    PageTableEntry *entries = l2Table->getEntries();
+    if (l2Table->capacity == 0)
+    {
+        return entries[l2Index];
+    }
+    uint32_t *indices = l2Table->getIndices();
+    uint32_t *end = indices + l2Table->slots;
+    uint32_t *position = lower_bound(indices, end, l2Index);
+    uint32_t slot = position - indices;
+    if (position != end && *position == l2Index)
+    {
+        return entries[slot];
+    }
+    if (l2Table->slots == l2Table->capacity)
+    {
+        // grow, or turn dense, for one more valid entry
+        return insertEntry(l1Index, resizeL2(l1Index, l2Table, l2Table->validEntries + 1), l2Index);
+    }
+    move_backward(position, end, end + 1);
+    move_backward(entries + slot, entries + l2Table->slots, entries + l2Table->slots + 1);
+    l2Table->slots++;
+    *position = l2Index;
+    entries[slot] = PageTableEntry();
+    return entries[slot];
+}
+
+template <typename Geometry>
+PageTableEntry *PageTable::walk(uint32_t VPN)
+{
+    Level2Table *l2Table = findL2(VPN >> Geometry::L2_BITS);
+    if (!l2Table)
+    {
+        return nullptr;
+    }
+    PageTableEntry *entry = findEntry(*l2Table, VPN & Geometry::L2_MASK);
+    return entry && entry->isValid() ? entry : nullptr;
+}
+
+PageTableEntry *PageTable::findValidEntry(uint32_t VPN)
+{
+    if (invertedTable)
+    {
+        return invertedTable->find(pid, VPN);
+    }
+    switch (walkGeometry)
+    {
+    case WalkGeometry::Pages4K32:
+        return walk<FixedPageGeometry<12, 32>>(VPN);
+    case WalkGeometry::Pages16K32:
+        return walk<FixedPageGeometry<14, 32>>(VPN);
+    case WalkGeometry::Pages64K32:
+        return walk<FixedPageGeometry<16, 32>>(VPN);
+    case WalkGeometry::Generic:
+        break;
+    }
+    Level2Table *l2Table = findL2(getL1Index(VPN));
+    if (!l2Table)
+    {
+        return nullptr;
+    }
+    PageTableEntry *entry = findEntry(*l2Table, getL2Index(VPN));
+    return entry && entry->isValid() ? entry : nullptr;
+}
+
+void PageTable::entryValidityChanged(uint32_t l1Index, bool valid)
+{
+    Level2Table *l2Table = findL2(l1Index);
+    if (valid)
+    {
+        l2Table->validEntries++;
+    }
+    else if (--l2Table->validEntries == 0)
+    {
+        freeL2(l1Index);
+    }
+    else
+    {
+        resizeL2(l1Index, l2Table, l2Table->validEntries);
+    }
 }
 
 // Check if a VPN is within a valid range
 bool PageTable::isValidRange(uint32_t VPN)
 {
-    return VPN < addressSpaceSize / pageSize;
+    return VPN < vpnCount;
 }
 
 //-----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 // constructor
-PageTable::PageTable(uint32_t addressBits, uint32_t pageSize)
-    :addressBits(addressBits),
+PageTable::PageTable(uint32_t addressBits, uint32_t pageSize, shared_ptr<NodeArena> arena,
+                     shared_ptr<InvertedPageTable> invertedTable, uint32_t pid)
+    :level1Allocator(arena),
+    indexAllocator(arena),
+    tableAllocator(arena),
+    invertedTable(move(invertedTable)),
+    pid(pid),
+    addressBits(addressBits),
     addressSpaceSize(1ULL << addressBits),
       pageSize(pageSize),
-      clockAlgo()
+      clockAlgo(arena)
 {
     if (addressSpaceSize % pageSize != 0)
     {
-        cerr << "Error: Address space size must be a multiple of page size" << endl;
+        *errorStream << "Error: Address space size must be a multiple of page size" << endl;
         return;
     }
 }
+
+PageTable::~PageTable()
+{
+    resetPageTable();
+}
 // -----------------------------------------------------------------------------------------------------------------------------------------------------------------------------------
 
 // Lookup the page table for a given VPN and return the frame number or -1 if not found
 int32_t PageTable::lookupPageTable(uint32_t VPN)
 {
+    PageTableEntry *entry = lookupPageTableEntry(VPN);
+    return entry ? entry->getFrameNumber() : -1;
+}
+
+// Lookup the page table for a given VPN and return its entry, updating the reference level like a hardware walk
+PageTableEntry *PageTable::lookupPageTableEntry(uint32_t VPN)
+{
+    PROFILE_STAGE(PageWalk);
     if (!isValidRange(VPN))
     {
-        cerr << "Invalid VPN: " << VPN << " Out of range" << endl;
-        return -1;
+        *errorStream << "Invalid VPN: " << VPN << " Out of range" << endl;
+        return nullptr;
     }
 
-    uint32_t l1Index = getL1Index(VPN); // Get the first-level index
-    uint32_t l2Index = getL2Index(VPN); // Get the second-level index
-
-    auto it1 = pageTable.find(l1Index); // Find the first-level map
-    if (it1 != pageTable.end())         // If the first-level map exists
+    PageTableEntry *entry = findValidEntry(VPN);
+    if (invertedTable)
+    {
+        invertedTable->recordWalk();
+        walks++;
+        probedBuckets += invertedTable->getLastProbes();
+    }
+    if (entry) // If the second-level table exists and the page is valid
     {
-        auto it2 = it1->second.find(l2Index);              // Find the second-level map
-        if (it2 != it1->second.end() && it2->second.valid) // If the second-level map exists and the page is valid
+        // Increment reference count if less than 3
+        if (entry->getReference() < 3)
         {
-            // Increment reference count if less than 3
-            if (it2->second.reference < 3)
-            {
-                it2->second.referenceInc(); // Increment the reference count
-            }
+            entry->referenceInc(); // Increment the reference count
+        }
 
-            // Update active pages via ClockAlgorithm
-            clockAlgo.addPage(VPN);
+        // Update active pages via ClockAlgorithm
+        clockAlgo.addPage(VPN);
 
-            return it2->second.frameNumber; // Return the frame number
-        }
+        return entry; // Return the entry
     }
 
-    return -1; // Page fault
+    return nullptr; // Page fault
 }
 
 // Update the page table with the given VPN and PFN
@@ -92,39 +513,58 @@ void PageTable::updatePageTable(uint32_t VPN, uint32_t frameNumber, bool valid,
 {
     if (!isValidRange(VPN))
     {
-        cerr << "Invalid VPN: " << VPN << " Out of range" << endl;
+        *errorStream << "Invalid VPN: " << VPN << " Out of range" << endl;
+        return;
+    }
+
+    // The inverted table only keeps valid entries: an invalidated page loses its slot
+    if (invertedTable)
+    {
+        if (valid)
+        {
+            PageTableEntry &entry = invertedTable->insert(pid, VPN);
+            if (!entry.isValid())
+            {
+                level2EntriesAllocated++;
+                hashedEntries++;
+            }
+            entry = PageTableEntry(frameNumber, valid, dirty, read, write, execute, reference);
+            clockAlgo.addPage(VPN);
+        }
+        else
+        {
+            hashedEntries -= invertedTable->erase(pid, VPN);
+            clockAlgo.removePage(VPN);
+        }
         return;
     }
 
     uint32_t l1Index = getL1Index(VPN);
     uint32_t l2Index = getL2Index(VPN);
 
-    // Check if we're adding a new first-level entry
-    bool isNewL1Entry = (pageTable.find(l1Index) == pageTable.end());
-    auto &l2Table = checkL2(l1Index); // This will create a new second-level map if necessary
-
-    // If a new L1 entry was created, increment the L1 counter
-    if (isNewL1Entry) {
-        level1EntriesAllocated++;
+    // Invalidating a page that was never mapped leaves the table as it is
+    if (!valid && !findValidEntry(VPN))
+    {
+        clockAlgo.removePage(VPN);
+        return;
     }
 
+    Level2Table *l2Table = checkL2(l1Index); // This will create a new second-level table if necessary
+
+    // Get the second-level table entry, a sparse table makes room for it if it is new
+    PageTableEntry &entry = insertEntry(l1Index, l2Table, l2Index);
+
     // Check if we're adding a new second-level entry
-    bool isNewL2Entry = (l2Table.find(l2Index) == l2Table.end());
-    if (isNewL2Entry) {
+    bool wasValid = entry.isValid();
+    if (!wasValid) {
         level2EntriesAllocated++;
     }
 
-    // Get the second-level map entry
-    auto &entry = l2Table[l2Index];
-
     // Update the page table entry
-    entry.frameNumber = frameNumber;
-    entry.valid = valid;
-    entry.dirty = dirty;
-    entry.read = read;
-    entry.write = write;
-    entry.execute = execute;
-    entry.reference = reference;
+    entry = PageTableEntry(frameNumber, valid, dirty, read, write, execute, reference);
+    if (wasValid != valid) {
+        entryValidityChanged(l1Index, valid);
+    }
 
     // If the page is valid, update the active pages via ClockAlgorithm
     if (valid) {
@@ -140,10 +580,33 @@ bool PageTable::replacePageUsingClockAlgo(uint32_t VPN)
 {
     if (!isValidRange(VPN))
     {
-        cerr << "Invalid VPN: " << VPN << " Out of range" << endl;
+        *errorStream << "Invalid VPN: " << VPN << " Out of range" << endl;
+        return false;
+    }
+
+    uint32_t targetVPN; // claim a target VPN
+    int oldFrame = evictPageUsingClockAlgo(targetVPN);
+    if (oldFrame == -1)
+    {
+        *errorStream << "Failed to replace page for VPN: " << VPN << endl;
+        return false; // fail to replace page
+    }
+
+    // reuse the victim's frame for the new page
+    updatePageTable(VPN, oldFrame, true, false, true, true, true, 0);
+
+    PageTableEntry *newEntry = getPageTableEntry(VPN);
+    if (!newEntry || !newEntry->isValid())
+    {
+        *errorStream << "Error: Failed to update page table with VPN: " << VPN << " and Frame: " << oldFrame << endl;
         return false;
     }
+    return true;
+}
 
+// Evict one page selected by the ClockAlgorithm and return its frame, or -1 if nothing can be evicted
+int PageTable::evictPageUsingClockAlgo(uint32_t &victimVPN)
+{
     uint32_t targetVPN; // claim a target VPN
 
     // select a page to replace using the clock algorithm
@@ -151,92 +614,101 @@ bool PageTable::replacePageUsingClockAlgo(uint32_t VPN)
     {
         PageTableEntry *targetEntry = getPageTableEntry(targetVPN);
 
-        // if page is valid, replace it
-        if (targetEntry && targetEntry->valid)
+        // if page is valid, evict it
+        if (targetEntry && targetEntry->isValid())
         {
-            uint32_t oldFrame = targetEntry->frameNumber;
+            uint32_t oldFrame = targetEntry->getFrameNumber();
 
             // if the target page is dirty, write it back to disk
-            if (targetEntry->dirty)
+            if (targetEntry->isDirty())
             {
                 writeBackToDisk(oldFrame);
             }
 
-            // remove the old page from the page table before replacing it
-            // FIXME: removed and reallocated memory within pagetable, no interaction with main -------
+            // remove the old page from the page table, the caller decides what to do with the frame
             int removedFrame = removeAddressForOneEntry(targetVPN);
             if (removedFrame == -1)
             {
-                cerr << "Error: Failed to remove victim VPN: " << targetVPN << endl;
-                return false;
+                *errorStream << "Error: Failed to remove victim VPN: " << targetVPN << endl;
+                return -1;
             }
 
-            // ---- need method from main to allocate a new frame for the new page
-            int newFrame = oldFrame;
-            updatePageTable(VPN, oldFrame, true, false, true, true, true, 0);
-            // ---------------
-
-            PageTableEntry *newEntry = getPageTableEntry(VPN);
-            if (!newEntry || !newEntry->valid)
-            {
-                cerr << "Error: Failed to update page table with VPN: " << VPN << " and Frame: " << oldFrame << endl;
-                return false;
-            }
-
-            //--------------------------------------------
-            return true;
+            victimVPN = targetVPN;
+            return oldFrame;
         }
         else
         {
             // if the target page is invalid, remove it from the page table and try again
-            cerr << "Warning: Invalid or non-existent page selected by ClockAlgorithm: " << targetVPN << endl;
+            *errorStream << "Warning: Invalid or non-existent page selected by ClockAlgorithm: " << targetVPN << endl;
             clockAlgo.removePage(targetVPN); // remove the target page from the active pages
         }
     }
 
-    cerr << "Failed to replace page for VPN: " << VPN << endl;
-    return false; // fail to replace page
+    return -1; // no page to evict
+}
+
+// Number of pages currently resident in memory
+uint32_t PageTable::getResidentPages() const
+{
+    return clockAlgo.getActivePageCount();
+}
+
+// VPNs of the resident pages, in clock order
+const PoolList<uint32_t> &PageTable::getResidentVPNs() const
+{
+    return clockAlgo.getActivePages();
 }
 
 // Write the page back to disk
 void PageTable::writeBackToDisk(uint32_t frameNumber)
 {
-    cout << "Writing frame " << frameNumber << " back to disk." << endl;
+    *logStream << "Writing frame " << frameNumber << " back to disk." << endl;
 }
 
 // Remove the address for one entry
 int PageTable::removeAddressForOneEntry(uint32_t VPN)
 {
+    if (invertedTable)
+    {
+        PageTableEntry *entry = isValidRange(VPN) ? invertedTable->find(pid, VPN) : nullptr;
+        if (!entry)
+        {
+            *errorStream << "Error: VPN " << VPN << " not found in the hashed page table" << endl;
+            return -1;
+        }
+        int pfn = entry->getFrameNumber();
+        invertedTable->erase(pid, VPN);
+        hashedEntries--;
+        clockAlgo.removePage(VPN);
+        return pfn;
+    }
+
     uint32_t l1Index = getL1Index(VPN);
     uint32_t l2Index = getL2Index(VPN);
 
     // check if VPN is in the page table
-    // fist check if the first level index exists
-    auto it1 = pageTable.find(l1Index);
-    if (it1 == pageTable.end())
+    // fist check if the second level table exists
+    Level2Table *l2Table = isValidRange(VPN) ? findL2(l1Index) : nullptr;
+    if (!l2Table)
     {
-        cerr << "Error: L1 index " << l1Index << " not found in the page table for VPN: " << VPN << endl;
+        *errorStream << "Error: L1 index " << l1Index << " not found in the page table for VPN: " << VPN << endl;
         return -1;
     }
 
-    // then check if the second level index exists
-    auto it2 = it1->second.find(l2Index);
-    if (it2 == it1->second.end())
+    // then check if the entry is mapped
+    PageTableEntry *entry = findEntry(*l2Table, l2Index);
+    if (!entry || !entry->isValid())
     {
-        cerr << "Error: L2 index " << l2Index << " not found in the page table for VPN: " << VPN << endl;
+        *errorStream << "Error: L2 index " << l2Index << " not found in the page table for VPN: " << VPN << endl;
         return -1;
     }
 
     // get the frame number for the VPN
-    int pfn = it2->second.frameNumber;
+    int pfn = entry->getFrameNumber();
 
-
-    // delete the entry from the page table
-    it1->second.erase(it2);
-    if (it1->second.empty())
-    {
-        pageTable.erase(it1);
-    }
+    // clear the entry, freeing its table if it was the last one mapped
+    entry->reset();
+    entryValidityChanged(l1Index, false);
 
     // remove the VPN from the clock algorithm
     clockAlgo.removePage(VPN);
@@ -244,6 +716,93 @@ int PageTable::removeAddressForOneEntry(uint32_t VPN)
     return pfn; // return the frame number
 }
 
+// Tear down a range one second-level table at a time: tables that were never allocated are skipped,
+// a table stops being scanned once its last valid entry is gone and is then freed as a whole
+void PageTable::removeRange(uint32_t firstVPN, uint32_t count, vector<pair<uint32_t, uint32_t>> &removed)
+{
+    uint64_t endVPN = min<uint64_t>(static_cast<uint64_t>(firstVPN) + count, vpnCount);
+    size_t firstRemoved = removed.size();
+    if (invertedTable)
+    {
+        invertedTable->eraseRange(pid, firstVPN, endVPN, removed);
+        hashedEntries -= removed.size() - firstRemoved;
+    }
+    else
+    {
+        for (uint64_t VPN = firstVPN; VPN < endVPN;)
+        {
+            uint32_t l1Index = getL1Index(VPN);
+            uint64_t tableEnd = min<uint64_t>(static_cast<uint64_t>(l1Index + 1) << l2Bits, endVPN);
+            Level2Table *l2Table = findL2(l1Index);
+            if (l2Table && l2Table->capacity == 0)
+            {
+                for (; VPN < tableEnd && l2Table->validEntries > 0; VPN++)
+                {
+                    PageTableEntry &entry = l2Table->getEntries()[getL2Index(VPN)];
+                    if (entry.isValid())
+                    {
+                        removed.emplace_back(VPN, entry.getFrameNumber());
+                        entry.reset();
+                        l2Table->validEntries--;
+                    }
+                }
+            }
+            else if (l2Table)
+            {
+                // a sparse table only visits its slots in the range
+                uint32_t tableBase = l1Index << l2Bits;
+                const uint32_t *indices = l2Table->getIndices();
+                uint32_t slot = lower_bound(indices, indices + l2Table->slots, getL2Index(VPN)) - indices;
+                for (; slot < l2Table->slots && tableBase + indices[slot] < tableEnd; slot++)
+                {
+                    PageTableEntry &entry = l2Table->getEntries()[slot];
+                    if (entry.isValid())
+                    {
+                        removed.emplace_back(tableBase + indices[slot], entry.getFrameNumber());
+                        entry.reset();
+                        l2Table->validEntries--;
+                    }
+                }
+            }
+            if (l2Table && l2Table->validEntries == 0)
+            {
+                freeL2(l1Index);
+            }
+            else if (l2Table)
+            {
+                resizeL2(l1Index, l2Table, l2Table->validEntries);
+            }
+            VPN = tableEnd;
+        }
+    }
+
+    // only the pages that were mapped are looked up on the clock
+    for (size_t i = firstRemoved; i < removed.size(); i++)
+    {
+        clockAlgo.removePage(removed[i].first);
+    }
+}
+
+void PageTable::removeAll(vector<pair<uint32_t, uint32_t>> &removed)
+{
+    // Every mapped page is on the clock, so a hashed table is not scanned for the process's entries
+    for (uint32_t VPN : clockAlgo.getActivePages())
+    {
+        PageTableEntry *entry = findValidEntry(VPN);
+        if (!entry)
+        {
+            continue;
+        }
+        removed.emplace_back(VPN, entry->getFrameNumber());
+        if (invertedTable)
+        {
+            invertedTable->erase(pid, VPN);
+            hashedEntries--;
+        }
+    }
+    resetPageTable();
+}
+
 // Get the PageTableEntry for a given VPN
 PageTableEntry *PageTable::getPageTableEntry(uint32_t VPN)
 {
@@ -252,36 +811,101 @@ PageTableEntry *PageTable::getPageTableEntry(uint32_t VPN)
         return nullptr;
     }
 
-    uint32_t l1Index = getL1Index(VPN);
-    uint32_t l2Index = getL2Index(VPN);
+    // return the page table entry if it is valid
+    return findValidEntry(VPN);
+}
 
-    // check if the VPN is in the page table
-    auto it1 = pageTable.find(l1Index);
-    if (it1 == pageTable.end())
+// reset the page table
+void PageTable::resetPageTable()
+{
+    if (invertedTable)
     {
-        return nullptr;
+        invertedTable->eraseProcess(pid, hashedEntries);
+        hashedEntries = 0;
     }
+    // every table is freed, the first level needs no layout in between
+    forEachL2([this](uint32_t, Level2Table *l2Table) {
+        deallocateL2(l2Table);
+    });
+    freeLevel1();
+    level2Tables = 0;
+    clockAlgo.reset();
+}
 
-    // check if the second level index exists
-    auto it2 = it1->second.find(l2Index);
-    if (it2 == it1->second.end())
+void PageTable::forEachEntry(const function<void(uint32_t VPN, const PageTableEntry &entry)> &visit) const
+{
+    if (invertedTable)
     {
-        return nullptr;
+        invertedTable->forEachEntry(pid, visit);
+        return;
     }
+    forEachL2([this, &visit](uint32_t l1Index, const Level2Table *l2Table) {
+        const PageTableEntry *entries = l2Table->getEntries();
+        if (l2Table->capacity > 0)
+        {
+            for (uint32_t slot = 0; slot < l2Table->slots; slot++)
+            {
+                if (entries[slot].isValid())
+                {
+                    visit(l1Index << l2Bits | l2Table->getIndices()[slot], entries[slot]);
+                }
+            }
+            return;
+        }
+        for (uint32_t l2Index = 0; l2Index < 1U << l2Bits; l2Index++)
+        {
+            const PageTableEntry &entry = entries[l2Index];
+            if (entry.isValid())
+            {
+                visit(l1Index << l2Bits | l2Index, entry);
+            }
+        }
+    });
+}
 
-    // return the page table entry if it is valid
-    if (it2->second.valid)
+uint32_t PageTable::getLevel1Entries() const
+{
+    return level1EntriesAllocated;
+}
+
+uint32_t PageTable::getLevel2Entries() const
+{
+    return level2EntriesAllocated;
+}
+
+uint32_t PageTable::getClockHandIndex() const
+{
+    return clockAlgo.getClockHandIndex();
+}
+
+// Store an entry as saved, the clock and the counters are restored separately
+void PageTable::restoreEntry(uint32_t VPN, const PageTableEntry &entry)
+{
+    if (!isValidRange(VPN) || !entry.isValid())
+    {
+        return;
+    }
+    if (invertedTable)
+    {
+        PageTableEntry &stored = invertedTable->insert(pid, VPN);
+        hashedEntries += !stored.isValid();
+        stored = entry;
+        return;
+    }
+    uint32_t l1Index = getL1Index(VPN);
+    PageTableEntry &stored = insertEntry(l1Index, checkL2(l1Index), getL2Index(VPN));
+    if (!stored.isValid())
     {
-        return &(it2->second);
+        entryValidityChanged(l1Index, true);
     }
-    return nullptr;
+    stored = entry;
 }
 
-// reset the page table
-void PageTable::resetPageTable()
+void PageTable::restoreState(uint32_t level1Entries, uint32_t level2Entries, const vector<uint32_t> &clockPages, uint32_t clockHand)
 {
-    pageTable.clear();
-    clockAlgo.reset();
+    level1EntriesAllocated = level1Entries;
+    level2EntriesAllocated = level2Entries;
+    clockAlgo.restore(clockPages, clockHand);
 }
 
 // Returns the number of allocated entries in total
@@ -289,12 +913,17 @@ uint32_t PageTable::getAllocatedEntries() const {
     return level1EntriesAllocated + level2EntriesAllocated;
 }
 
-// Returns the memory usage for the two-level page table
+// Returns the memory usage for the two-level page table, or the slots taken in the hashed one
 uint32_t PageTable::getTotalMemoryUsage() const {
-    uint32_t sizeL1Entry = sizeof(unordered_map<uint32_t, PageTableEntry>);
-    uint32_t sizeL2Entry = sizeof(PageTableEntry);
+    uint64_t replacementState = clockAlgo.getMemoryUsage();
+    if (invertedTable) {
+        return getHashedSlotBytes() + replacementState;
+    }
+    return getLevel1Bytes(level2Tables) + level2Bytes + replacementState;
+}
 
-    return (level1EntriesAllocated * sizeL1Entry) + (level2EntriesAllocated * sizeL2Entry);
+uint64_t PageTable::getHashedSlotBytes() const {
+    return static_cast<uint64_t>(hashedEntries) * (InvertedPageTable::BUCKET_BYTES / InvertedPageTable::SLOTS_PER_BUCKET);
 }
 
 // Returns the memory usage for a hypothetical single-level page table
@@ -304,13 +933,41 @@ uint32_t PageTable::getAvailableSpaceSingleLevel(uint64_t addressSpaceSize, uint
     return (numPages * sizeSingleLevelEntry);
 }
 
+// The first-level array plus one second-level table per range with a mapped page, laid out for its pages
+uint64_t PageTable::getTwoLevelMemoryUsage() const {
+    if (!invertedTable) {
+        return getLevel1Bytes(level2Tables) + level2Bytes;
+    }
+    unordered_map<uint32_t, uint32_t> level1Pages;
+    forEachEntry([this, &level1Pages](uint32_t VPN, const PageTableEntry &) {
+        level1Pages[VPN >> l2Bits]++;
+    });
+    uint64_t bytes = getLevel1Bytes(level1Pages.size());
+    for (const auto &tablePages : level1Pages) {
+        bytes += getLevel2Bytes(getLevel2Capacity(tablePages.second));
+    }
+    return bytes;
+}
+
 void PageTable::displayStatistics() const {
-    cout << "Two-Level Page Table Statistics:" << endl;
-    cout << "  Total L1 Entries Allocated: " << level1EntriesAllocated << endl;
-    cout << "  Total L2 Entries Allocated: " << level2EntriesAllocated << endl;
-    cout << "  Total Allocated Entries: " << getAllocatedEntries() << endl;
-    cout << "  Total Memory Usage (Two-Level): " << getTotalMemoryUsage() << " bytes" << endl;
-    cout << "  For comparison, a single-level page table requires " << addressSpaceSize / pageSize
+    if (invertedTable) {
+        *logStream << "Hashed Page Table Statistics:" << endl;
+        *logStream << "  Entries Mapped: " << hashedEntries << " (" << level2EntriesAllocated << " over the run)" << endl;
+        *logStream << "  Walks: " << walks << ", average buckets probed: "
+             << (walks > 0 ? static_cast<double>(probedBuckets) / walks : 0.0) << endl;
+        *logStream << "  Slots Used: " << getHashedSlotBytes() << " bytes" << endl;
+        *logStream << "  Replacement State: " << clockAlgo.getMemoryUsage() << " bytes" << endl;
+        *logStream << "  For comparison, two-level tables for these pages require " << getTwoLevelMemoryUsage() << " bytes" << endl;
+        *logStream << endl;
+        return;
+    }
+    *logStream << "Two-Level Page Table Statistics:" << endl;
+    *logStream << "  Total L1 Entries Allocated: " << level1EntriesAllocated << endl;
+    *logStream << "  Total L2 Entries Allocated: " << level2EntriesAllocated << endl;
+    *logStream << "  Total Allocated Entries: " << getAllocatedEntries() << endl;
+    *logStream << "  Total Memory Usage (Two-Level): " << getTotalMemoryUsage() << " bytes, "
+         << clockAlgo.getMemoryUsage() << " of them for page replacement" << endl;
+    *logStream << "  For comparison, a single-level page table requires " << addressSpaceSize / pageSize
          << " entries and " << getAvailableSpaceSingleLevel(addressSpaceSize, pageSize) << " bytes" << endl;
-    cout << endl;
+    *logStream << endl;
 }
@@ -1,33 +1,84 @@
 #ifndef PAGETABLE_H
 #define PAGETABLE_H
 
-#include <unordered_map>
 #include <cstdint>
 #include <list>
 #include <unordered_set>
+#include <functional>
+#include <memory>
+#include <vector>
 #include "PageTableEntry.h"
+#include "InvertedPageTable.h"
+#include "PageGeometry.h"
 #include "helperFiles/ClockAlgorithm.h"
-#include <cmath>
+#include "../Allocator/PoolAllocator.h"
 using namespace std;
 
 class PageTable
 {
 private:
-    // Two-level page table structure
-    unordered_map<uint32_t, unordered_map<uint32_t, PageTableEntry>> pageTable;
+    // Second-level table covering 2^l2Bits consecutive VPNs of packed entries. Like the page-sized tables
+    // of a hardware page table, it is allocated with its first mapped page and freed with its last one.
+    // A table with few valid entries is sparse: a sorted array of their second-level indices and one of
+    // their entries, a binary search away. Past sparseLimit entries it becomes a dense array indexed
+    // directly, and turns sparse again once it is back to sparseLimit. The layout only depends on the
+    // number of valid entries, so a restored table takes the memory it took before the checkpoint. Mapping
+    // or unmapping a page may move its table and entries, like a rehash of the inverted table does.
+    // The entries follow the table in one block, a dense table is then read without loading a pointer
+    struct alignas(PageTableEntry) Level2Table
+    {
+        uint32_t validEntries;
+        uint32_t slots;    // Slots in use in a sparse table
+        uint32_t capacity; // Slots of a sparse table, 0 for a dense one
+
+        // The slots' entries, or all 2^l2Bits entries of a dense table
+        PageTableEntry *getEntries() { return reinterpret_cast<PageTableEntry *>(this + 1); }
+        const PageTableEntry *getEntries() const { return reinterpret_cast<const PageTableEntry *>(this + 1); }
+        // Sorted second-level index of every slot of a sparse table, after its entries
+        uint32_t *getIndices() { return reinterpret_cast<uint32_t *>(getEntries() + capacity); }
+        const uint32_t *getIndices() const { return reinterpret_cast<const uint32_t *>(getEntries() + capacity); }
+    };
+    static const uint32_t MIN_SPARSE_SLOTS = 4;
+
+    // The first level is laid out the same way for the second-level tables: sorted arrays of the first-level
+    // indices that have a table and of their tables while there are at most level1SparseLimit of them, a
+    // dense array of 2^l1Bits pointers beyond. A page table with nothing mapped has no first level at all
+    Level2Table **pageTable = nullptr;     // The dense first level, nullptr while it is sparse
+    uint32_t *level1Indices = nullptr;    // Sorted first-level index of every table of a sparse first level
+    Level2Table **level1Tables = nullptr; // Their tables
+    uint32_t level1Capacity = 0;          // Slots of a sparse first level
+    uint32_t level2Tables = 0; // Second-level tables allocated right now
+    uint64_t level2Bytes = 0;  // Their memory, with the slots they have right now
+
+    // First levels and second-level tables come from the simulator's arena, the tables in entry-sized units
+    PoolAllocator<Level2Table *> level1Allocator;
+    PoolAllocator<uint32_t> indexAllocator;
+    PoolAllocator<PageTableEntry> tableAllocator;
+
+    // With a hashed inverted page table the entries live there, keyed by pid, and no tables are allocated
+    shared_ptr<InvertedPageTable> invertedTable;
+    uint32_t pid;
+    uint32_t hashedEntries = 0;
+    uint64_t walks = 0;
+    uint64_t probedBuckets = 0;
 
     uint32_t addressBits; // 32bit
     uint64_t addressSpaceSize; // length of the address space
     uint32_t pageSize;         // 4096
 
     // Counters to track allocated entries
-    uint32_t level1EntriesAllocated = 0; // Count of L1 entries allocated
-    uint32_t level2EntriesAllocated = 0; // Count of L2 entries allocated
+    uint32_t level1EntriesAllocated = 0; // Second-level tables allocated over the run
+    uint32_t level2EntriesAllocated = 0; // Entries mapped over the run
 
-    const int pageOffsetBits = static_cast<int>(log2(pageSize));
+    const int pageOffsetBits = static_cast<int>(getPageShift(pageSize));
     const int vpnBits = addressBits - pageOffsetBits;
     const int l1Bits = vpnBits / 2;
     const int l2Bits = vpnBits - l1Bits;
+    const uint64_t vpnCount = 1ULL << vpnBits;
+    // A sparse level holds up to a thirty-second of its range, under a twentieth of the dense level's memory
+    const uint32_t level1SparseLimit = getSparseLimit(l1Bits);
+    const uint32_t sparseLimit = getSparseLimit(l2Bits);
+    const WalkGeometry walkGeometry = getWalkGeometry(pageOffsetBits, addressBits);
 
     // Clock algorithm manager
     ClockAlgorithm clockAlgo;
@@ -36,39 +87,121 @@ private:
     uint32_t getL1Index(uint32_t VPN);
     uint32_t getL2Index(uint32_t VPN);
 
-    // Helper function to check and create a second-level map if necessary
-    unordered_map<uint32_t, PageTableEntry> &checkL2(uint32_t l1Index);
+    // Slots a sparse level of 2^bits positions may have, 0 if it is too small to have any
+    static uint32_t getSparseLimit(int bits);
+    // Slots of a sparse level with used positions in use, 0 if it takes the dense layout
+    static uint32_t getSparseCapacity(uint32_t used, uint32_t limit);
+
+    // Slot of an index in a sorted array of a sparse level, not below count if it is not there
+    static uint32_t findSlot(const uint32_t *indices, uint32_t count, uint32_t index);
+    // The second-level table of a first-level index, or nullptr
+    Level2Table *findL2(uint32_t l1Index) const;
+    template <typename Visit>
+    void forEachL2(Visit visit) const;
+    // Add or remove a table in the first level, which is laid out for the tables it has afterwards
+    void insertL2(uint32_t l1Index, Level2Table *l2Table);
+    void replaceL2(uint32_t l1Index, Level2Table *l2Table);
+    void removeL2(uint32_t l1Index);
+    void resizeL1(uint32_t tables);
+    void freeLevel1();
+    // Memory of a first level with this many tables
+    uint64_t getLevel1Bytes(uint32_t tables) const;
+
+    // Helper function to check and create a second-level table if necessary
+    Level2Table *checkL2(uint32_t l1Index);
+    void freeL2(uint32_t l1Index);
+    // A table with no entries and capacity slots, and back to the arena
+    Level2Table *allocateL2(uint32_t capacity);
+    void deallocateL2(Level2Table *l2Table);
+
+    // Slots a table with validEntries valid entries has, 0 for a dense table, and the memory that takes
+    uint32_t getLevel2Capacity(uint32_t validEntries) const;
+    uint64_t getLevel2Bytes(uint32_t capacity) const;
+    // Give a table the layout for validEntries entries, dropping the invalid ones of a sparse table, and
+    // return the table now at its first-level index
+    Level2Table *resizeL2(uint32_t l1Index, Level2Table *l2Table, uint32_t validEntries);
+    // The entry stored for an index, or nullptr if a sparse table has no slot for it
+    PageTableEntry *findEntry(Level2Table &l2Table, uint32_t l2Index);
+    // The entry for an index, adding an invalid one to a sparse table without a slot for it
+    PageTableEntry &insertEntry(uint32_t l1Index, Level2Table *l2Table, uint32_t l2Index);
+
+    // The valid entry of a VPN, or nullptr. Common geometries take a walk specialized for them
+    PageTableEntry *findValidEntry(uint32_t VPN);
+    template <typename Geometry>
+    PageTableEntry *walk(uint32_t VPN);
+
+    // Memory of the slots this table takes in the inverted table
+    uint64_t getHashedSlotBytes() const;
+
+    // Account for an entry turning valid or invalid, freeing its table once nothing in it is valid and
+    // shrinking it to the layout for the entries left otherwise
+    void entryValidityChanged(uint32_t l1Index, bool valid);
 
 public:
-    // Constructors
-    PageTable(uint32_t addressBits, uint32_t pageSize);
+    // Constructors, tables and clock pages are allocated from arena, or from the heap without one. Given an
+    // inverted table, entries are kept there under pid instead
+    PageTable(uint32_t addressBits, uint32_t pageSize, shared_ptr<NodeArena> arena = nullptr,
+              shared_ptr<InvertedPageTable> invertedTable = nullptr, uint32_t pid = 0);
+    ~PageTable();
+    PageTable(const PageTable &) = delete;
+    PageTable &operator=(const PageTable &) = delete;
 
     // Lookup the page table for a given VPN, returning the frame number or -1 if not found
     int32_t lookupPageTable(uint32_t VPN);
 
+    // Same lookup, returning the entry so callers can check its permissions, or nullptr if not found
+    PageTableEntry *lookupPageTableEntry(uint32_t VPN);
+
     // Update the page table with a new or existing entry
     void updatePageTable(uint32_t VPN, uint32_t frameNumber, bool valid, bool dirty, bool read, bool write, bool execute, uint8_t reference);
 
     // Replace a page in memory using ClockAlgorithm
     bool replacePageUsingClockAlgo(uint32_t VPN);
 
+    // Evict a page selected by ClockAlgorithm, returning its frame number or -1 if no page can be evicted
+    int evictPageUsingClockAlgo(uint32_t &victimVPN);
+
+    // Get the number of pages currently resident in memory
+    uint32_t getResidentPages() const;
+
+    // Get the VPNs of all resident pages
+    const PoolList<uint32_t> &getResidentVPNs() const;
+
     // Write a page frame back to disk
     void writeBackToDisk(uint32_t frameNumber);
 
     // Remove the address for one entry
     int removeAddressForOneEntry(uint32_t VPN);
 
+    // Unmap every page in [firstVPN, firstVPN + count), appending each mapped VPN and its frame to removed
+    void removeRange(uint32_t firstVPN, uint32_t count, vector<pair<uint32_t, uint32_t>> &removed);
+
+    // Unmap every page, appending each VPN and its frame to removed. Only the mapped pages are visited
+    void removeAll(vector<pair<uint32_t, uint32_t>> &removed);
+
     // Get the PageTableEntry for a given VPN
     PageTableEntry *getPageTableEntry(uint32_t VPN);
 
     void resetPageTable();
 
+    // Checkpoints: visit every valid entry, and rebuild the table from saved entries
+    void forEachEntry(const function<void(uint32_t VPN, const PageTableEntry &entry)> &visit) const;
+    uint32_t getLevel1Entries() const;
+    uint32_t getLevel2Entries() const;
+    uint32_t getClockHandIndex() const;
+    void restoreEntry(uint32_t VPN, const PageTableEntry &entry);
+    void restoreState(uint32_t level1Entries, uint32_t level2Entries, const vector<uint32_t> &clockPages, uint32_t clockHand);
+
     bool isValidRange(uint32_t VPN);
 
     // Functions to calculate memory usage
     uint32_t getAllocatedEntries() const;
+    // True footprint: the first-level array, if the table has its own, the second-level tables allocated
+    // right now and the clock's replacement state
     uint32_t getTotalMemoryUsage() const;
     uint32_t getAvailableSpaceSingleLevel(uint64_t addressSpaceSize, uint32_t pageSize) const;
+    // What two-level tables would take for the pages mapped right now, to compare other backends with
+    uint64_t getTwoLevelMemoryUsage() const;
     void displayStatistics() const;
 };
 
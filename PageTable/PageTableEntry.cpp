@@ -9,34 +9,42 @@ PageTableEntry::PageTableEntry(uint32_t frameNumber,
                                bool write,
                                bool execute,
                                uint8_t reference)
-    : frameNumber(frameNumber), valid(valid), dirty(dirty),
-      read(read), write(write), execute(execute), reference(reference) {}
+    : bits(frameNumber)
+{
+    bits |= valid ? VALID_BIT : 0;
+    bits |= dirty ? DIRTY_BIT : 0;
+    bits |= read ? READ_BIT : 0;
+    bits |= write ? WRITE_BIT : 0;
+    bits |= execute ? EXECUTE_BIT : 0;
+    bits |= static_cast<uint64_t>(reference > 3 ? 3 : reference) << REFERENCE_SHIFT;
+}
+
+PageTableEntry PageTableEntry::fromBits(uint64_t bits)
+{
+    PageTableEntry entry;
+    entry.bits = bits;
+    return entry;
+}
 
 void PageTableEntry::reset()
 {
-    frameNumber = static_cast<uint32_t>(-1); // Using UINT32_MAX to represent invalid frame number
-    valid = false;
-    dirty = false;
-    read = false;
-    write = false;
-    execute = false;
-    reference = 0;
+    bits = FRAME_MASK; // Using UINT32_MAX to represent invalid frame number
 }
 
 // Increment the reference level, with max level 3
 void PageTableEntry::referenceInc()
 {
-    if (reference < 3)
+    if ((bits & REFERENCE_MASK) != REFERENCE_MASK)
     {
-        reference++;
+        bits += 1ULL << REFERENCE_SHIFT;
     }
 }
 
 // Decrement the reference level, with min level 0
 void PageTableEntry::referenceDec()
 {
-    if (reference > 0)
+    if (bits & REFERENCE_MASK)
     {
-        reference--;
+        bits -= 1ULL << REFERENCE_SHIFT;
     }
 }
@@ -4,17 +4,27 @@
 #include <cstdint>
 #include <sstream>
 
+// A page table entry packed into one 64-bit word: the frame number in the low 32 bits, the flags and the
+// 2-bit reference level above. The whole entry is one value, so it can be stored in an atomic word as is
 class PageTableEntry
 {
 public:
-    uint32_t frameNumber; // The frame number associated with this page entry
-    bool valid;           // Valid bit
-    bool dirty;           // Dirty bit
-    bool read;            // Read permission
-    bool write;           // Write permission
-    bool execute;         // Execute permission
-    uint8_t reference;    // Reference level for clock algorithm (0 to 3)
+    static const uint64_t FRAME_MASK = 0xFFFFFFFFULL;
+    static const uint64_t VALID_BIT = 1ULL << 32;
+    static const uint64_t DIRTY_BIT = 1ULL << 33;
+    static const uint64_t READ_BIT = 1ULL << 34;
+    static const uint64_t WRITE_BIT = 1ULL << 35;
+    static const uint64_t EXECUTE_BIT = 1ULL << 36;
+    static const uint64_t COPY_ON_WRITE_BIT = 1ULL << 37; // Write-protected after fork, a write fault copies the frame
+    static const int REFERENCE_SHIFT = 38;
+    static const uint64_t REFERENCE_MASK = 3ULL << REFERENCE_SHIFT; // Reference level for clock algorithm (0 to 3)
 
+private:
+    uint64_t bits;
+
+    void setBit(uint64_t bit, bool value) { bits = value ? bits | bit : bits & ~bit; }
+
+public:
     // Constructor with default parameters in header file only
     PageTableEntry(uint32_t frameNumber = static_cast<uint32_t>(-1),
                    bool valid = false,
@@ -24,26 +34,47 @@ public:
                    bool execute = false,
                    uint8_t reference = 0);
 
+    static PageTableEntry fromBits(uint64_t bits);
+    uint64_t getBits() const { return bits; }
+
+    uint32_t getFrameNumber() const { return static_cast<uint32_t>(bits & FRAME_MASK); }
+    bool isValid() const { return bits & VALID_BIT; }
+    bool isDirty() const { return bits & DIRTY_BIT; }
+    bool isReadable() const { return bits & READ_BIT; }
+    bool isWritable() const { return bits & WRITE_BIT; }
+    bool isExecutable() const { return bits & EXECUTE_BIT; }
+    bool isCopyOnWrite() const { return bits & COPY_ON_WRITE_BIT; }
+    uint8_t getReference() const { return static_cast<uint8_t>((bits & REFERENCE_MASK) >> REFERENCE_SHIFT); }
+
+    void setFrameNumber(uint32_t frameNumber) { bits = (bits & ~FRAME_MASK) | frameNumber; }
+    void setValid(bool valid) { setBit(VALID_BIT, valid); }
+    void setDirty(bool dirty) { setBit(DIRTY_BIT, dirty); }
+    void setWritable(bool write) { setBit(WRITE_BIT, write); }
+    void setCopyOnWrite(bool copyOnWrite) { setBit(COPY_ON_WRITE_BIT, copyOnWrite); }
+
     // Reset the page entry to default values
     void reset();
 
-    // Set reference bit to true
+    // Raise the reference level, up to 3
     void referenceInc();
 
-    // Set reference bit to false
+    // Lower the reference level, down to 0
     void referenceDec();
 
     // Return a string representation of the page entry
     std::string toString() const
     {
         std::ostringstream oss;
-        oss << "{ Frame: " << frameNumber
-            << ", Valid: " << valid
-            << ", Dirty: " << dirty
-            << ", Reference: " << static_cast<int>(reference)
+        oss << "{ Frame: " << getFrameNumber()
+            << ", Valid: " << isValid()
+            << ", Dirty: " << isDirty()
+            << ", COW: " << isCopyOnWrite()
+            << ", Reference: " << static_cast<int>(getReference())
             << " }";
         return oss.str();
     }
 };
 
+static_assert(sizeof(PageTableEntry) == sizeof(uint64_t), "PageTableEntry must stay one packed word");
+
 #endif // PAGETABLEENTRY_H
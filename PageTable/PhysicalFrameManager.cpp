@@ -1,29 +1,98 @@
 #include <queue>
+#include <algorithm>
 #include "PhysicalFrameManager.h"
 
 using namespace std;
 
-PhysicalFrameManager::PhysicalFrameManager(uint32_t totalFrames) : totalFrames(totalFrames)
+PhysicalFrameManager::PhysicalFrameManager(uint32_t totalFrames)
+    : tierFirstFrame(1, 0), nodeFirstFrame(1, 0), partitionFirstFrame(1, 0), totalFrames(totalFrames), frameOwners(totalFrames, NO_FRAME_OWNER)
 {
+    pools.push_back(FramePool{0, 0, 0, 0, queue<uint32_t>()});
+    poolFirstFrame.push_back(0);
     for (uint32_t i = 0; i < totalFrames; ++i)
     {
-        freeFrames.push(i);
+        pools[0].freeFrames.push(i);
     }
+    freeFrameCount = totalFrames;
 }
 
 // allocate a frame, if no free frames return -1,
 // used in pageTable page replacement
 uint32_t PhysicalFrameManager::allocateFrame()
 {
-    if (freeFrames.empty())
+    for (uint32_t tier = 0; tier < tierFirstFrame.size(); tier++)
     {
-        return static_cast<uint32_t>(-1); // Return -1 if no frames are available
+        uint32_t frame = allocateFrameInTier(tier);
+        if (frame != static_cast<uint32_t>(-1))
+        {
+            return frame;
+        }
     }
-    uint32_t frame = freeFrames.front();
-    freeFrames.pop();
+    return static_cast<uint32_t>(-1); // Return -1 if no frames are available
+}
+
+// allocate a frame from one tier, used by tier migration
+uint32_t PhysicalFrameManager::allocateFrameInTier(uint32_t tier)
+{
+    for (FramePool &pool : pools)
+    {
+        if (pool.tier == tier && !pool.freeFrames.empty())
+        {
+            return allocateFrameFromPool(pool);
+        }
+    }
+    return static_cast<uint32_t>(-1);
+}
+
+// allocate a frame from one node, pools are ordered by frame so faster tiers come first
+uint32_t PhysicalFrameManager::allocateFrameOnNode(uint32_t node)
+{
+    for (uint32_t tier = 0; tier < tierFirstFrame.size(); tier++)
+    {
+        for (FramePool &pool : pools)
+        {
+            if (pool.node == node && pool.tier == tier && !pool.freeFrames.empty())
+            {
+                return allocateFrameFromPool(pool);
+            }
+        }
+    }
+    return static_cast<uint32_t>(-1);
+}
+
+uint32_t PhysicalFrameManager::allocateFrameFromPool(FramePool &pool)
+{
+    uint32_t frame = pool.freeFrames.front();
+    pool.freeFrames.pop();
+    freeFrameCount--;
     return frame;
 }
 
+// allocate a frame of one color, rotating through each pool's queue so the other frames keep their order
+uint32_t PhysicalFrameManager::allocateFrameWithColor(uint32_t color, uint32_t colors)
+{
+    for (uint32_t tier = 0; tier < tierFirstFrame.size(); tier++)
+    {
+        for (FramePool &pool : pools)
+        {
+            if (pool.tier != tier)
+            {
+                continue;
+            }
+            for (size_t i = 0; i < pool.freeFrames.size(); i++)
+            {
+                if (pool.freeFrames.front() % colors == color)
+                {
+                    return allocateFrameFromPool(pool);
+                }
+                pool.freeFrames.push(pool.freeFrames.front());
+                pool.freeFrames.pop();
+            }
+        }
+    }
+    return allocateFrame();
+}
+
 // free a frame, if the frame is invalid, print error message
 void PhysicalFrameManager::freeAFrame(uint32_t frame)
 {
@@ -31,7 +100,29 @@ void PhysicalFrameManager::freeAFrame(uint32_t frame)
     {
         throw std::invalid_argument("Invalid frame number: " + std::to_string(frame));
     }
-    freeFrames.push(frame);
+    clearFrameOwner(frame);
+    getFramePool(frame).freeFrames.push(frame);
+    freeFrameCount++;
+}
+
+// Frames of a range often come from one pool, the pool is only looked up again once a frame falls outside it
+void PhysicalFrameManager::freeFrames(const std::vector<uint32_t> &frames)
+{
+    uint32_t poolIndex = 0;
+    for (uint32_t frame : frames)
+    {
+        if (frame >= totalFrames)
+        {
+            throw std::invalid_argument("Invalid frame number: " + std::to_string(frame));
+        }
+        if (frame < poolFirstFrame[poolIndex] || (poolIndex + 1 < poolFirstFrame.size() && frame >= poolFirstFrame[poolIndex + 1]))
+        {
+            poolIndex = (upper_bound(poolFirstFrame.begin(), poolFirstFrame.end(), frame) - poolFirstFrame.begin()) - 1;
+        }
+        clearFrameOwner(frame);
+        pools[poolIndex].freeFrames.push(frame);
+    }
+    freeFrameCount += frames.size();
 }
 
 // get the total number of frames
@@ -43,5 +134,393 @@ uint32_t PhysicalFrameManager::getTotalFrames() const
 
 uint32_t PhysicalFrameManager::getFreeFrames() const
 {
-    return freeFrames.size();
+    return freeFrameCount;
+}
+
+// set the reclaim watermarks, all values are in frames
+void PhysicalFrameManager::setWatermarks(uint32_t minFrames, uint32_t lowFrames, uint32_t highFrames)
+{
+    if (minFrames > lowFrames || lowFrames > highFrames || highFrames > totalFrames)
+    {
+        throw std::invalid_argument("Invalid watermarks: " + std::to_string(minFrames) + ":" +
+                                    std::to_string(lowFrames) + ":" + std::to_string(highFrames) +
+                                    " (expected min <= low <= high <= " + std::to_string(totalFrames) + ")");
+    }
+    minWatermark = minFrames;
+    lowWatermark = lowFrames;
+    highWatermark = highFrames;
+}
+
+uint32_t PhysicalFrameManager::getMinWatermark() const
+{
+    return minWatermark;
+}
+
+uint32_t PhysicalFrameManager::getLowWatermark() const
+{
+    return lowWatermark;
+}
+
+uint32_t PhysicalFrameManager::getHighWatermark() const
+{
+    return highWatermark;
+}
+
+// used in page fault to decide whether the fault has to reclaim synchronously
+bool PhysicalFrameManager::isBelowMinWatermark() const
+{
+    return freeFrameCount < minWatermark;
+}
+
+// used to decide whether background reclaim should run
+bool PhysicalFrameManager::isBelowLowWatermark() const
+{
+    return freeFrameCount < lowWatermark;
+}
+
+bool PhysicalFrameManager::isAboveHighWatermark() const
+{
+    return freeFrameCount >= highWatermark;
+}
+
+// turn a list of range sizes into the first frame of each range, the sizes must cover all frames
+vector<uint32_t> PhysicalFrameManager::getFirstFrames(const vector<uint32_t> &sizes, uint32_t totalFrames, const string &name)
+{
+    uint64_t sum = 0;
+    for (uint32_t frames : sizes)
+    {
+        if (frames == 0)
+        {
+            throw std::invalid_argument("Every memory " + name + " needs at least one frame");
+        }
+        sum += frames;
+    }
+    if (sizes.empty() || sum != totalFrames)
+    {
+        throw std::invalid_argument("Memory " + name + "s must add up to " + std::to_string(totalFrames) + " frames");
+    }
+
+    vector<uint32_t> firstFrames;
+    uint32_t firstFrame = 0;
+    for (uint32_t frames : sizes)
+    {
+        firstFrames.push_back(firstFrame);
+        firstFrame += frames;
+    }
+    return firstFrames;
+}
+
+// split frames into tiers, frames that are already allocated keep their number and simply belong to their new tier
+void PhysicalFrameManager::setTiers(const vector<uint32_t> &tierFrames)
+{
+    tierFirstFrame = getFirstFrames(tierFrames, totalFrames, "tier");
+    rebuildPools();
+}
+
+// split frames into NUMA nodes, in the same way as tiers
+void PhysicalFrameManager::setNodes(const vector<uint32_t> &nodeFrames)
+{
+    nodeFirstFrame = getFirstFrames(nodeFrames, totalFrames, "node");
+    rebuildPools();
+}
+
+// a pool starts wherever a tier, a node or a partition starts
+void PhysicalFrameManager::rebuildPools()
+{
+    vector<uint32_t> boundaries(tierFirstFrame);
+    boundaries.insert(boundaries.end(), nodeFirstFrame.begin(), nodeFirstFrame.end());
+    boundaries.insert(boundaries.end(), partitionFirstFrame.begin(), partitionFirstFrame.end());
+    sort(boundaries.begin(), boundaries.end());
+    boundaries.erase(unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+    vector<FramePool> oldPools;
+    oldPools.swap(pools);
+    poolFirstFrame = boundaries;
+    for (uint32_t firstFrame : boundaries)
+    {
+        uint32_t partition = (upper_bound(partitionFirstFrame.begin(), partitionFirstFrame.end(), firstFrame) - partitionFirstFrame.begin()) - 1;
+        pools.push_back(FramePool{firstFrame, getFrameTier(firstFrame), getFrameNode(firstFrame), partition, queue<uint32_t>()});
+    }
+
+    // redistribute the free frames, keeping their allocation order within each pool
+    for (FramePool &oldPool : oldPools)
+    {
+        while (!oldPool.freeFrames.empty())
+        {
+            uint32_t frame = oldPool.freeFrames.front();
+            oldPool.freeFrames.pop();
+            getFramePool(frame).freeFrames.push(frame);
+        }
+    }
+}
+
+PhysicalFrameManager::FramePool &PhysicalFrameManager::getFramePool(uint32_t frame)
+{
+    return pools[(upper_bound(poolFirstFrame.begin(), poolFirstFrame.end(), frame) - poolFirstFrame.begin()) - 1];
+}
+
+const PhysicalFrameManager::FramePool &PhysicalFrameManager::getFramePool(uint32_t frame) const
+{
+    return pools[(upper_bound(poolFirstFrame.begin(), poolFirstFrame.end(), frame) - poolFirstFrame.begin()) - 1];
+}
+
+uint32_t PhysicalFrameManager::getTierCount() const
+{
+    return tierFirstFrame.size();
+}
+
+uint32_t PhysicalFrameManager::getFrameTier(uint32_t frame) const
+{
+    return (upper_bound(tierFirstFrame.begin(), tierFirstFrame.end(), frame) - tierFirstFrame.begin()) - 1;
+}
+
+uint32_t PhysicalFrameManager::getTierFirstFrame(uint32_t tier) const
+{
+    return tierFirstFrame[tier];
+}
+
+uint32_t PhysicalFrameManager::getTierFrames(uint32_t tier) const
+{
+    uint32_t end = tier + 1 < tierFirstFrame.size() ? tierFirstFrame[tier + 1] : totalFrames;
+    return end - tierFirstFrame[tier];
+}
+
+uint32_t PhysicalFrameManager::getFreeFramesInTier(uint32_t tier) const
+{
+    uint32_t freeCount = 0;
+    for (const FramePool &pool : pools)
+    {
+        if (pool.tier == tier)
+        {
+            freeCount += pool.freeFrames.size();
+        }
+    }
+    return freeCount;
+}
+
+uint32_t PhysicalFrameManager::getNodeCount() const
+{
+    return nodeFirstFrame.size();
+}
+
+uint32_t PhysicalFrameManager::getFrameNode(uint32_t frame) const
+{
+    return (upper_bound(nodeFirstFrame.begin(), nodeFirstFrame.end(), frame) - nodeFirstFrame.begin()) - 1;
+}
+
+uint32_t PhysicalFrameManager::getNodeFrames(uint32_t node) const
+{
+    uint32_t end = node + 1 < nodeFirstFrame.size() ? nodeFirstFrame[node + 1] : totalFrames;
+    return end - nodeFirstFrame[node];
+}
+
+uint32_t PhysicalFrameManager::getFreeFramesOnNode(uint32_t node) const
+{
+    uint32_t freeCount = 0;
+    for (const FramePool &pool : pools)
+    {
+        if (pool.node == node)
+        {
+            freeCount += pool.freeFrames.size();
+        }
+    }
+    return freeCount;
+}
+
+// split frames into partitions, each owned by one process so that processes never compete for frames
+void PhysicalFrameManager::setPartitions(const vector<uint32_t> &partitionFrames)
+{
+    vector<uint32_t> sizes(partitionFrames);
+    uint64_t used = 0;
+    for (uint32_t frames : partitionFrames)
+    {
+        used += frames;
+    }
+    if (used > totalFrames)
+    {
+        throw std::invalid_argument("Frame partitions need " + std::to_string(used) + " frames, only " + std::to_string(totalFrames) + " exist");
+    }
+    if (used < totalFrames)
+    {
+        sizes.push_back(totalFrames - used);
+    }
+    partitionFirstFrame = getFirstFrames(sizes, totalFrames, "partition");
+    rebuildPools();
+}
+
+uint32_t PhysicalFrameManager::allocateFrameInPartition(uint32_t partition)
+{
+    for (FramePool &pool : pools)
+    {
+        if (pool.partition == partition && !pool.freeFrames.empty())
+        {
+            return allocateFrameFromPool(pool);
+        }
+    }
+    return static_cast<uint32_t>(-1);
+}
+
+uint32_t PhysicalFrameManager::getPartitionCount() const
+{
+    return partitionFirstFrame.size();
+}
+
+uint32_t PhysicalFrameManager::getFreeFramesInPartition(uint32_t partition) const
+{
+    uint32_t freeCount = 0;
+    for (const FramePool &pool : pools)
+    {
+        if (pool.partition == partition)
+        {
+            freeCount += pool.freeFrames.size();
+        }
+    }
+    return freeCount;
+}
+
+// used to merge the results of a parallel replay, where each worker only touched its own partitions
+void PhysicalFrameManager::copyPartition(const PhysicalFrameManager &other, uint32_t partition)
+{
+    for (size_t i = 0; i < pools.size(); i++)
+    {
+        if (pools[i].partition != partition)
+        {
+            continue;
+        }
+        freeFrameCount -= pools[i].freeFrames.size();
+        pools[i].freeFrames = other.pools[i].freeFrames;
+        freeFrameCount += pools[i].freeFrames.size();
+
+        uint32_t end = i + 1 < pools.size() ? pools[i + 1].firstFrame : totalFrames;
+        for (uint32_t frame = pools[i].firstFrame; frame < end; frame++)
+        {
+            frameOwners[frame] = other.frameOwners[frame];
+        }
+    }
+}
+
+// set the only owner of a frame
+void PhysicalFrameManager::setFrameOwner(uint32_t frame, uint64_t owner)
+{
+    frameOwners[frame] = owner;
+    sharedFrameOwners.erase(frame);
+}
+
+void PhysicalFrameManager::clearFrameOwner(uint32_t frame)
+{
+    frameOwners[frame] = NO_FRAME_OWNER;
+    sharedFrameOwners.erase(frame);
+}
+
+uint64_t PhysicalFrameManager::getFrameOwner(uint32_t frame) const
+{
+    return frameOwners[frame];
+}
+
+void PhysicalFrameManager::addFrameOwner(uint32_t frame, uint64_t owner)
+{
+    if (frameOwners[frame] == NO_FRAME_OWNER)
+    {
+        frameOwners[frame] = owner;
+        return;
+    }
+    sharedFrameOwners[frame].push_back(owner);
+}
+
+uint32_t PhysicalFrameManager::removeFrameOwner(uint32_t frame, uint64_t owner)
+{
+    auto shared = sharedFrameOwners.find(frame);
+    if (shared != sharedFrameOwners.end())
+    {
+        vector<uint64_t> &owners = shared->second;
+        if (frameOwners[frame] == owner)
+        {
+            // promote another owner to be the first one
+            frameOwners[frame] = owners.back();
+            owners.pop_back();
+        }
+        else
+        {
+            owners.erase(remove(owners.begin(), owners.end(), owner), owners.end());
+        }
+        if (owners.empty())
+        {
+            sharedFrameOwners.erase(shared);
+        }
+    }
+    else if (frameOwners[frame] == owner)
+    {
+        frameOwners[frame] = NO_FRAME_OWNER;
+    }
+    return getFrameRefCount(frame);
+}
+
+uint32_t PhysicalFrameManager::getFrameRefCount(uint32_t frame) const
+{
+    if (frameOwners[frame] == NO_FRAME_OWNER)
+    {
+        return 0;
+    }
+    auto shared = sharedFrameOwners.find(frame);
+    return 1 + (shared == sharedFrameOwners.end() ? 0 : shared->second.size());
+}
+
+vector<uint64_t> PhysicalFrameManager::getFrameOwners(uint32_t frame) const
+{
+    vector<uint64_t> owners;
+    if (frameOwners[frame] != NO_FRAME_OWNER)
+    {
+        owners.push_back(frameOwners[frame]);
+        auto shared = sharedFrameOwners.find(frame);
+        if (shared != sharedFrameOwners.end())
+        {
+            owners.insert(owners.end(), shared->second.begin(), shared->second.end());
+        }
+    }
+    return owners;
+}
+
+const vector<uint32_t> &PhysicalFrameManager::getPoolFirstFrames() const
+{
+    return poolFirstFrame;
+}
+
+vector<vector<uint32_t>> PhysicalFrameManager::getFreeFrameQueues() const
+{
+    vector<vector<uint32_t>> queues;
+    for (const FramePool &pool : pools)
+    {
+        queue<uint32_t> frames = pool.freeFrames;
+        queues.emplace_back();
+        while (!frames.empty())
+        {
+            queues.back().push_back(frames.front());
+            frames.pop();
+        }
+    }
+    return queues;
+}
+
+void PhysicalFrameManager::restoreFreeFrames(const vector<vector<uint32_t>> &queues)
+{
+    if (queues.size() != pools.size())
+    {
+        throw invalid_argument("Saved free frames are split into " + to_string(queues.size()) + " pools, not " + to_string(pools.size()));
+    }
+    freeFrameCount = 0;
+    for (size_t i = 0; i < pools.size(); i++)
+    {
+        pools[i].freeFrames = queue<uint32_t>();
+        for (uint32_t frame : queues[i])
+        {
+            if (frame >= totalFrames || &getFramePool(frame) != &pools[i])
+            {
+                throw invalid_argument("Saved free frame " + to_string(frame) + " is not in pool " + to_string(i));
+            }
+            pools[i].freeFrames.push(frame);
+            freeFrameCount++;
+        }
+    }
+    fill(frameOwners.begin(), frameOwners.end(), NO_FRAME_OWNER);
+    sharedFrameOwners.clear();
 }
@@ -2,31 +2,140 @@
 #define PHYSICALFRAMEMANAGER_H
 
 #include <queue>
+#include <vector>
+#include <unordered_map>
 #include <cstdint>
 #include <stdexcept>
 #include <string>
 
+// Owner value of a frame that is not mapped by any page
+const uint64_t NO_FRAME_OWNER = UINT64_MAX;
+
 class PhysicalFrameManager
 {
 private:
-    std::queue<uint32_t> freeFrames; // Queue to store free frames
-    uint32_t totalFrames;            // Total number of frames
+    // Frames are split into contiguous memory tiers (tier 0 is the fastest) and, independently,
+    // into contiguous NUMA nodes and static partitions. Every range that falls in one tier, one node
+    // and one partition is a pool with its own queue of free frames.
+    struct FramePool
+    {
+        uint32_t firstFrame;
+        uint32_t tier;
+        uint32_t node;
+        uint32_t partition;
+        std::queue<uint32_t> freeFrames; // Queue to store free frames
+    };
+
+    std::vector<FramePool> pools;         // Pools ordered by first frame
+    std::vector<uint32_t> poolFirstFrame; // First frame of each pool, for lookups by frame
+    std::vector<uint32_t> tierFirstFrame; // First frame number of each tier
+    std::vector<uint32_t> nodeFirstFrame; // First frame number of each node
+    std::vector<uint32_t> partitionFirstFrame; // First frame number of each partition
+    uint32_t totalFrames;                 // Total number of frames
+    uint32_t freeFrameCount = 0;          // Free frames across all pools
+
+    std::vector<uint64_t> frameOwners; // Reverse map from frame to the (pid, VPN) key mapping it
+    std::unordered_map<uint32_t, std::vector<uint64_t>> sharedFrameOwners; // Further owners of frames mapped more than once
+
+    // Rebuild the pools after the tier or node layout changed, keeping free frames free
+    void rebuildPools();
+    FramePool &getFramePool(uint32_t frame);
+    const FramePool &getFramePool(uint32_t frame) const;
+    uint32_t allocateFrameFromPool(FramePool &pool);
+    static std::vector<uint32_t> getFirstFrames(const std::vector<uint32_t> &sizes, uint32_t totalFrames, const std::string &name);
+
+    // Free-frame watermarks used by reclaim, all zero means reclaim only happens on demand
+    uint32_t minWatermark = 0;  // Below this, faults must reclaim synchronously (direct reclaim)
+    uint32_t lowWatermark = 0;  // Below this, background reclaim is woken up
+    uint32_t highWatermark = 0; // Background reclaim stops once free frames reach this level
 
 public:
     // Constructor to initialize the total number of frames
     PhysicalFrameManager(uint32_t totalFrames);
 
-    // Allocate a frame; return -1 if no free frames are available
+    // Allocate a frame from the fastest tier that has one; return -1 if no free frames are available
     uint32_t allocateFrame();
 
+    // Allocate a frame from the given tier only; return -1 if that tier has no free frames
+    uint32_t allocateFrameInTier(uint32_t tier);
+
+    // Page coloring: allocate a frame whose number modulo colors equals color, fastest tier first,
+    // or any free frame if none has that color; return -1 if no free frames are available
+    uint32_t allocateFrameWithColor(uint32_t color, uint32_t colors);
+
     // Free a frame; throw an error if the frame is invalid
     void freeAFrame(uint32_t frame);
 
+    // Free many frames at once, e.g. those of an unmapped range; throw an error if any frame is invalid
+    void freeFrames(const std::vector<uint32_t> &frames);
+
     // Get the total number of frames
     uint32_t getTotalFrames() const;
 
     // Get the total number of free frames
     uint32_t getFreeFrames() const;
+
+    // Set the min/low/high watermarks; throw an error unless min <= low <= high <= total frames
+    void setWatermarks(uint32_t minFrames, uint32_t lowFrames, uint32_t highFrames);
+
+    uint32_t getMinWatermark() const;
+    uint32_t getLowWatermark() const;
+    uint32_t getHighWatermark() const;
+
+    // Watermark checks against the current number of free frames
+    bool isBelowMinWatermark() const;
+    bool isBelowLowWatermark() const;
+    bool isAboveHighWatermark() const;
+
+    // Split the frames into tiers of the given sizes, fastest first; the sizes must add up to the total
+    void setTiers(const std::vector<uint32_t>& tierFrames);
+
+    uint32_t getTierCount() const;
+    uint32_t getFrameTier(uint32_t frame) const;
+    uint32_t getTierFirstFrame(uint32_t tier) const;
+    uint32_t getTierFrames(uint32_t tier) const;
+    uint32_t getFreeFramesInTier(uint32_t tier) const;
+
+    // Split the frames into NUMA nodes of the given sizes; the sizes must add up to the total
+    void setNodes(const std::vector<uint32_t>& nodeFrames);
+
+    // Allocate a frame on the given node, fastest tier first; return -1 if the node has no free frames
+    uint32_t allocateFrameOnNode(uint32_t node);
+
+    uint32_t getNodeCount() const;
+    uint32_t getFrameNode(uint32_t frame) const;
+    uint32_t getNodeFrames(uint32_t node) const;
+    uint32_t getFreeFramesOnNode(uint32_t node) const;
+
+    // Split the frames into static partitions of the given sizes, frames left over form one more partition
+    void setPartitions(const std::vector<uint32_t>& partitionFrames);
+
+    // Allocate a frame from the given partition only; return -1 if the partition has no free frames
+    uint32_t allocateFrameInPartition(uint32_t partition);
+
+    uint32_t getPartitionCount() const;
+    uint32_t getFreeFramesInPartition(uint32_t partition) const;
+
+    // Take over the free frames and owners of one partition from another manager with the same layout
+    void copyPartition(const PhysicalFrameManager& other, uint32_t partition);
+
+    // Reverse map, kept up to date by whoever maps a frame into a page table
+    void setFrameOwner(uint32_t frame, uint64_t owner);
+    void clearFrameOwner(uint32_t frame);
+    uint64_t getFrameOwner(uint32_t frame) const;
+
+    // Frame sharing (fork, shared code): every owner holds one reference to the frame
+    void addFrameOwner(uint32_t frame, uint64_t owner);
+    // Drop one owner's reference and return the number of references left
+    uint32_t removeFrameOwner(uint32_t frame, uint64_t owner);
+    uint32_t getFrameRefCount(uint32_t frame) const;
+    std::vector<uint64_t> getFrameOwners(uint32_t frame) const;
+
+    // Checkpoints: the first frame and the free frames of every pool, in allocation order
+    const std::vector<uint32_t> &getPoolFirstFrames() const;
+    std::vector<std::vector<uint32_t>> getFreeFrameQueues() const;
+    // Replace the free frames with saved queues and drop every owner; the pool layout must not have changed
+    void restoreFreeFrames(const std::vector<std::vector<uint32_t>> &queues);
 };
 
 #endif // PHYSICALFRAMEMANAGER_H
@@ -2,10 +2,13 @@
 #include "../PageTable.h"
 #include <algorithm>
 #include <iostream>
+#include "../../Log/Log.h"
+#include "../../Profiler/Profiler.h"
 
 using namespace std;
 
-ClockAlgorithm::ClockAlgorithm()
+ClockAlgorithm::ClockAlgorithm(shared_ptr<NodeArena> arena)
+    : activePages(PoolAllocator<uint32_t>(arena)), activeVPNs(0, hash<uint32_t>(), equal_to<uint32_t>(), PoolAllocator<pair<const uint32_t, PoolList<uint32_t>::iterator>>(arena))
 {
     clockHand = activePages.begin(); // initialize clockHand to the beginning of the list
 }
@@ -15,8 +18,7 @@ void ClockAlgorithm::addPage(uint32_t VPN)
 {
     if (activeVPNs.find(VPN) == activeVPNs.end())
     {
-        activePages.push_back(VPN);
-        activeVPNs.insert(VPN);
+        activeVPNs.emplace(VPN, activePages.insert(activePages.end(), VPN));
         if (activePages.size() == 1)
         {
             clockHand = activePages.begin();
@@ -27,21 +29,22 @@ void ClockAlgorithm::addPage(uint32_t VPN)
 // According to the Clock Algorithm, remove a page from the activePages list.
 void ClockAlgorithm::removePage(uint32_t VPN)
 {
-    // find the VPN in the activePages list, if it exists, return an iterator to it
-    auto it = find(activePages.begin(), activePages.end(), VPN);
+    // look the VPN up instead of searching the activePages list for it
+    auto found = activeVPNs.find(VPN);
 
-    if (it != activePages.end()) // if the VPN is found in the activePages list
+    if (found != activeVPNs.end()) // if the VPN is in the activePages list
     {
+        auto it = found->second;
         // if the VPN is the current clockHand, move the clockHand to the next element
         if (it == clockHand)
         {
             moveClockHandNext();
              if (clockHand == activePages.end()) clockHand = activePages.begin();
         }
-        // remove the VPN from the activeVPNs set
+        // remove the VPN from the activePages list and the activeVPNs map
         activePages.erase(it);
-        activeVPNs.erase(VPN);
-        
+        activeVPNs.erase(found);
+
         if (activePages.empty()) // if the activePages list is empty, reset the clockHand
         {
             clockHand = activePages.end(); // prevent dereferencing an empty iterator
@@ -52,27 +55,28 @@ void ClockAlgorithm::removePage(uint32_t VPN)
 // scan the activePages list to find a page to replace, based on the reference bit of each page
 bool ClockAlgorithm::selectPageToReplace(uint32_t &targetVPN, PageTable &pageTable)
 {
+    PROFILE_STAGE(ClockSweep);
     if (activePages.empty())
     {
-        cerr << "Error: No active pages available for replacement." << endl;
+        *errorStream << "Error: No active pages available for replacement." << endl;
         return false;
     }
 
     int maxScans = activePages.size(); // maximum number of scans before resetting reference bits
     int scans = 0;
-    cout << "Selecting page to replace. Total active pages: " << activePages.size() << endl;
+    *logStream << "Selecting page to replace. Total active pages: " << activePages.size() << endl;
 
     while (true) // until a page to replace is found
     {
         if (scans >= maxScans)
         {
-            cout << "Completed one full scan, resetting reference bits" << endl;
+            *logStream << "Completed one full scan, resetting reference bits" << endl;
 
             // after one complete scan, reset the reference bits for all active pages, and reset the scan count
             for (uint32_t vpn : activePages)
             {
                 PageTableEntry *entry = pageTable.getPageTableEntry(vpn);
-                if (entry && entry->reference > 0)
+                if (entry && entry->getReference() > 0)
                 {
                     entry->referenceDec(); // decrement the reference bit
                 }
@@ -93,17 +97,17 @@ bool ClockAlgorithm::selectPageToReplace(uint32_t &targetVPN, PageTable &pageTab
         //  --------------------------------------------
         if (!entry || !pageTable.isValidRange(currentVPN))
         {
-            cerr << "Error: Invalid or out-of-range PageTableEntry for VPN: " << currentVPN << ". Removing from active pages." << endl;
+            *errorStream << "Error: Invalid or out-of-range PageTableEntry for VPN: " << currentVPN << ". Removing from active pages." << endl;
             removePage(currentVPN);
             moveClockHandNext();
             scans++;
             continue;
         }
 
-        if (entry->reference == 0)
+        if (entry->getReference() == 0)
         {
             targetVPN = currentVPN;
-            cout << "Selected VPN to replace: " << targetVPN << endl;
+            *logStream << "Selected VPN to replace: " << targetVPN << endl;
             moveClockHandNext(); // 将时钟指针移至下一个页面
             return true;
         }
@@ -115,7 +119,7 @@ bool ClockAlgorithm::selectPageToReplace(uint32_t &targetVPN, PageTable &pageTab
     return false; // should never reach here
 }
 
-// reset the clock algorithm by clearing the activePages list and activeVPNs set
+// reset the clock algorithm by clearing the activePages list and activeVPNs map
 void ClockAlgorithm::reset()
 {
     activePages.clear();
@@ -123,6 +127,50 @@ void ClockAlgorithm::reset()
     clockHand = activePages.begin();
 }
 
+// get the number of pages in the activePages list
+uint32_t ClockAlgorithm::getActivePageCount() const
+{
+    return activeVPNs.size();
+}
+
+uint64_t ClockAlgorithm::getMemoryUsage() const
+{
+    // node layouts of the standard list and unordered_map
+    struct ListNode
+    {
+        void *links[2];
+        uint32_t VPN;
+    };
+    struct MapNode
+    {
+        void *next;
+        pair<const uint32_t, PoolList<uint32_t>::iterator> value;
+    };
+    return activePages.size() * sizeof(ListNode) + activeVPNs.size() * sizeof(MapNode) + activeVPNs.bucket_count() * sizeof(void *);
+}
+
+const PoolList<uint32_t> &ClockAlgorithm::getActivePages() const
+{
+    return activePages;
+}
+
+uint32_t ClockAlgorithm::getClockHandIndex() const
+{
+    return distance(activePages.begin(), PoolList<uint32_t>::const_iterator(clockHand));
+}
+
+void ClockAlgorithm::restore(const vector<uint32_t> &pages, uint32_t handIndex)
+{
+    activePages.clear();
+    activeVPNs.clear();
+    for (uint32_t VPN : pages)
+    {
+        activeVPNs.emplace(VPN, activePages.insert(activePages.end(), VPN));
+    }
+    clockHand = activePages.begin();
+    advance(clockHand, min<size_t>(handIndex, activePages.size()));
+}
+
 // move the clock hand to the next position in the activePages list
 void ClockAlgorithm::moveClockHandNext()
 {
@@ -2,9 +2,11 @@
 #define CLOCKALGORITHM_H
 
 #include <list>
-#include <unordered_set>
+#include <unordered_map>
+#include <vector>
 #include <cstdint>
 #include "../PageTableEntry.h"
+#include "../../Allocator/PoolAllocator.h"
 
 using namespace std;
 
@@ -14,12 +16,15 @@ class PageTable;
 class ClockAlgorithm
 {
 private:
-    list<uint32_t> activePages;         // Tracks active VPNs in a circular list
-    list<uint32_t>::iterator clockHand; // Iterator pointing to current clock position
-    unordered_set<uint32_t> activeVPNs; // To avoid duplicate VPNs
+    PoolList<uint32_t> activePages;         // Tracks active VPNs in a circular list
+    PoolList<uint32_t>::iterator clockHand; // Iterator pointing to current clock position
+    // Where each active VPN sits in the list, so a page is added once and removed without a search
+    unordered_map<uint32_t, PoolList<uint32_t>::iterator, hash<uint32_t>, equal_to<uint32_t>,
+                  PoolAllocator<pair<const uint32_t, PoolList<uint32_t>::iterator>>> activeVPNs;
 
 public:
-    ClockAlgorithm();
+    // The active pages draw their nodes from arena, or from the heap without one
+    explicit ClockAlgorithm(shared_ptr<NodeArena> arena = nullptr);
 
     // Add a new VPN to active pages
     void addPage(uint32_t VPN);
@@ -35,6 +40,21 @@ public:
     // Reset the clock algorithm
     void reset();
 
+    // Get the number of active pages tracked by the clock
+    uint32_t getActivePageCount() const;
+
+    // Bytes of the list and map nodes and of the map's buckets
+    uint64_t getMemoryUsage() const;
+
+    // Get the active pages in clock order
+    const PoolList<uint32_t> &getActivePages() const;
+
+    // Position of the clock hand in the active pages, for checkpoints
+    uint32_t getClockHandIndex() const;
+
+    // Replace the active pages and the hand with a checkpointed state
+    void restore(const vector<uint32_t> &pages, uint32_t handIndex);
+
 private:
     // Move the clock hand to the next position
     void moveClockHandNext();
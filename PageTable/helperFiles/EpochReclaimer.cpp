@@ -0,0 +1,133 @@
+#include "EpochReclaimer.h"
+#include <stdexcept>
+
+using namespace std;
+
+namespace
+{
+    mutex slotMutex;
+    vector<uint32_t> freeSlots;
+    uint32_t nextSlot = 0;
+
+    // Reader slot of the calling thread, taken on first use and handed back when the thread exits
+    struct ReaderSlot
+    {
+        uint32_t index;
+
+        ReaderSlot()
+        {
+            lock_guard<mutex> lock(slotMutex);
+            if (!freeSlots.empty())
+            {
+                index = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else if (nextSlot < EpochReclaimer::MAX_READERS)
+            {
+                index = nextSlot++;
+            }
+            else
+            {
+                throw runtime_error("More than " + to_string(EpochReclaimer::MAX_READERS) + " threads reading a concurrent page table");
+            }
+        }
+
+        ~ReaderSlot()
+        {
+            lock_guard<mutex> lock(slotMutex);
+            freeSlots.push_back(index);
+        }
+    };
+
+    uint32_t currentReaderSlot()
+    {
+        thread_local ReaderSlot slot;
+        return slot.index;
+    }
+}
+
+EpochReclaimer::Guard::Guard(EpochReclaimer &reclaimer)
+    : reclaimer(reclaimer), slot(currentReaderSlot()), outermost(false)
+{
+    if (reclaimer.readerEpochs[slot].load(memory_order_relaxed) == 0)
+    {
+        // Sequentially consistent so a writer that misses the announcement has already unlinked
+        // everything this reader could load afterwards
+        reclaimer.readerEpochs[slot].store(reclaimer.globalEpoch.load());
+        outermost = true;
+    }
+}
+
+EpochReclaimer::Guard::~Guard()
+{
+    if (outermost)
+    {
+        reclaimer.readerEpochs[slot].store(0, memory_order_release);
+    }
+}
+
+EpochReclaimer::EpochReclaimer()
+    : globalEpoch(1), retiredCount(0), reclaimedCount(0)
+{
+    for (atomic<uint64_t> &epoch : readerEpochs)
+    {
+        epoch.store(0, memory_order_relaxed);
+    }
+}
+
+EpochReclaimer::~EpochReclaimer()
+{
+    for (const RetiredObject &entry : retired)
+    {
+        entry.deleter(entry.object);
+    }
+}
+
+// Retire an unlinked object in the current epoch and move on to the next one
+void EpochReclaimer::retire(void *object, void (*deleter)(void *))
+{
+    lock_guard<mutex> lock(retireMutex);
+    retired.push_back({object, deleter, globalEpoch.fetch_add(1)});
+    retiredCount.fetch_add(1, memory_order_relaxed);
+}
+
+// Free the objects retired before the oldest epoch a reader is still in
+void EpochReclaimer::reclaim()
+{
+    // Scan the readers after taking the lock, a reader the scan misses cannot reach anything retired so far
+    lock_guard<mutex> lock(retireMutex);
+    uint64_t oldestReader = UINT64_MAX;
+    for (const atomic<uint64_t> &epoch : readerEpochs)
+    {
+        uint64_t readerEpoch = epoch.load();
+        if (readerEpoch != 0 && readerEpoch < oldestReader)
+        {
+            oldestReader = readerEpoch;
+        }
+    }
+
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); i++)
+    {
+        if (retired[i].epoch < oldestReader)
+        {
+            retired[i].deleter(retired[i].object);
+            reclaimedCount.fetch_add(1, memory_order_relaxed);
+        }
+        else
+        {
+            retired[kept++] = retired[i];
+        }
+    }
+    retired.resize(kept);
+}
+
+uint64_t EpochReclaimer::getRetiredCount() const
+{
+    return retiredCount.load(memory_order_relaxed);
+}
+
+uint64_t EpochReclaimer::getReclaimedCount() const
+{
+    return reclaimedCount.load(memory_order_relaxed);
+}
@@ -0,0 +1,68 @@
+#ifndef EPOCHRECLAIMER_H
+#define EPOCHRECLAIMER_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Epoch-based reclamation for structures read without locks. Readers announce the epoch they
+// entered in while they hold a Guard, objects unlinked by writers are retired with the epoch they
+// were unlinked in and freed once every reader still inside entered after that epoch
+class EpochReclaimer
+{
+public:
+    // Maximum number of threads inside a guard at the same time, across all reclaimers
+    static const uint32_t MAX_READERS = 64;
+
+    // Keeps objects retired from now on alive until the guard is destroyed
+    class Guard
+    {
+    public:
+        explicit Guard(EpochReclaimer &reclaimer);
+        ~Guard();
+
+        Guard(const Guard &) = delete;
+        Guard &operator=(const Guard &) = delete;
+
+    private:
+        EpochReclaimer &reclaimer;
+        uint32_t slot;
+        bool outermost; // Nested guards on the same thread keep the outer epoch
+    };
+
+    EpochReclaimer();
+
+    // Frees everything still retired, no reader may be inside a guard any more
+    ~EpochReclaimer();
+
+    EpochReclaimer(const EpochReclaimer &) = delete;
+    EpochReclaimer &operator=(const EpochReclaimer &) = delete;
+
+    // Hand over an object that is no longer reachable by new readers
+    void retire(void *object, void (*deleter)(void *));
+
+    // Free the retired objects no reader can still see
+    void reclaim();
+
+    uint64_t getRetiredCount() const;
+    uint64_t getReclaimedCount() const;
+
+private:
+    struct RetiredObject
+    {
+        void *object;
+        void (*deleter)(void *);
+        uint64_t epoch;
+    };
+
+    std::atomic<uint64_t> globalEpoch;
+    std::atomic<uint64_t> readerEpochs[MAX_READERS]; // 0 while the slot's thread is outside a guard
+
+    std::mutex retireMutex;
+    std::vector<RetiredObject> retired;
+    std::atomic<uint64_t> retiredCount;
+    std::atomic<uint64_t> reclaimedCount;
+};
+
+#endif // EPOCHRECLAIMER_H
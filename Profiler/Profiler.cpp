@@ -0,0 +1,143 @@
+#include "Profiler.h"
+
+#ifdef VMSIM_PROFILE
+
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include "../CostModel/helperFiles/LatencyHistogram.h"
+
+using namespace std;
+
+namespace
+{
+const int STAGES = static_cast<int>(ProfileStage::Count);
+const char *const STAGE_NAMES[STAGES] = {"Instruction", "Parse", "Access", "TLB Lookup", "Page Walk", "Page Fault", "Clock Sweep"};
+const char *const STAGE_KEYS[STAGES] = {"instruction", "parse", "access", "tlb_lookup", "page_walk", "page_fault", "clock_sweep"};
+
+struct StageData
+{
+    uint64_t calls[STAGES] = {};
+    LatencyHistogram latency[STAGES];
+
+    void merge(const StageData &other)
+    {
+        for (int i = 0; i < STAGES; i++)
+        {
+            calls[i] += other.calls[i];
+            latency[i].merge(other.latency[i]);
+        }
+    }
+};
+
+atomic<uint32_t> samplePeriod(1);
+
+mutex totalsLock;
+StageData totals; // Data handed over by the threads that exited
+
+// A thread's own data, merged into the totals when the thread exits
+struct ThreadData : StageData
+{
+    uint32_t untilSample[STAGES] = {};
+
+    ~ThreadData()
+    {
+        lock_guard<mutex> lock(totalsLock);
+        totals.merge(*this);
+    }
+};
+
+thread_local ThreadData threadData;
+
+StageData collect()
+{
+    lock_guard<mutex> lock(totalsLock);
+    StageData all = totals;
+    all.merge(threadData);
+    return all;
+}
+}
+
+Profiler::StageTimer::StageTimer(ProfileStage stage) : stage(stage), timed(false)
+{
+    int index = static_cast<int>(stage);
+    threadData.calls[index]++;
+    if (threadData.untilSample[index] == 0)
+    {
+        threadData.untilSample[index] = samplePeriod.load(memory_order_relaxed) - 1;
+        timed = true;
+        start = chrono::steady_clock::now();
+    }
+    else
+    {
+        threadData.untilSample[index]--;
+    }
+}
+
+Profiler::StageTimer::~StageTimer()
+{
+    if (timed)
+    {
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start);
+        threadData.latency[static_cast<int>(stage)].record(static_cast<uint64_t>(elapsed.count()));
+    }
+}
+
+void Profiler::setSamplePeriod(uint32_t period)
+{
+    if (period == 0)
+    {
+        throw invalid_argument("Profile sample period must be at least 1");
+    }
+    samplePeriod.store(period, memory_order_relaxed);
+}
+
+// The total time of a stage is estimated from its timed calls, stages nest so the totals overlap
+void Profiler::displayStatistics(ostream &out)
+{
+    StageData all = collect();
+    out << "--- Simulator Profile ---" << endl;
+    out << "  Sample Period: every " << samplePeriod.load(memory_order_relaxed) << " calls" << endl;
+    for (int i = 0; i < STAGES; i++)
+    {
+        const LatencyHistogram &latency = all.latency[i];
+        out << "  " << STAGE_NAMES[i] << ": " << all.calls[i] << " calls";
+        if (latency.getCount() > 0)
+        {
+            out << ", mean " << latency.getMean() << " ns (p50 " << latency.getPercentile(0.5) << ", p99 "
+                << latency.getPercentile(0.99) << ", p99.9 " << latency.getPercentile(0.999) << ", max "
+                << latency.getMax() << "), estimated total " << latency.getMean() * all.calls[i] / 1e6 << " ms";
+        }
+        out << endl;
+    }
+    out << endl;
+}
+
+void Profiler::writeJson(const string &path)
+{
+    ofstream out(path);
+    if (!out)
+    {
+        throw runtime_error("Cannot open profile output file " + path);
+    }
+    StageData all = collect();
+    out << "{\n  \"sample_period\": " << samplePeriod.load(memory_order_relaxed) << ",\n  \"stages\": {";
+    for (int i = 0; i < STAGES; i++)
+    {
+        const LatencyHistogram &latency = all.latency[i];
+        out << (i > 0 ? "," : "") << "\n    \"" << STAGE_KEYS[i] << "\": {"
+            << "\"calls\": " << all.calls[i]
+            << ", \"timed\": " << latency.getCount()
+            << ", \"mean_ns\": " << latency.getMean()
+            << ", \"p50_ns\": " << latency.getPercentile(0.5)
+            << ", \"p90_ns\": " << latency.getPercentile(0.9)
+            << ", \"p99_ns\": " << latency.getPercentile(0.99)
+            << ", \"p999_ns\": " << latency.getPercentile(0.999)
+            << ", \"max_ns\": " << latency.getMax()
+            << ", \"estimated_total_ns\": " << static_cast<uint64_t>(latency.getMean() * all.calls[i]) << "}";
+    }
+    out << "\n  }\n}" << endl;
+}
+
+#endif // VMSIM_PROFILE
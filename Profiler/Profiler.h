@@ -0,0 +1,66 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Stages of the simulator's own work that are timed when it is built with VMSIM_PROFILE. Stages nest,
+// an access includes its TLB lookup, page walk and fault, so their times are inclusive
+enum class ProfileStage
+{
+    Instruction,
+    Parse,
+    Access,
+    TlbLookup,
+    PageWalk,
+    PageFault,
+    ClockSweep,
+    Count
+};
+
+#ifdef VMSIM_PROFILE
+
+#include <chrono>
+
+// Per-thread call counters and latency histograms of the simulator's hot paths. Every call is counted,
+// every samplePeriod-th call per stage is timed with steady_clock. Each thread records into its own
+// data without locking and hands it over to the global totals when it exits
+class Profiler
+{
+public:
+    class StageTimer
+    {
+    private:
+        ProfileStage stage;
+        bool timed;
+        std::chrono::steady_clock::time_point start;
+
+    public:
+        explicit StageTimer(ProfileStage stage);
+        ~StageTimer();
+
+        StageTimer(const StageTimer &) = delete;
+        StageTimer &operator=(const StageTimer &) = delete;
+    };
+
+    // Time every Nth call of each stage, 1 times every call
+    static void setSamplePeriod(uint32_t period);
+
+    // Print the totals of the exited threads and the calling thread
+    static void displayStatistics(std::ostream &out);
+    static void writeJson(const std::string &path);
+};
+
+#define VMSIM_PROFILE_CONCAT_(a, b) a##b
+#define VMSIM_PROFILE_CONCAT(a, b) VMSIM_PROFILE_CONCAT_(a, b)
+// Time the rest of the enclosing scope as one call of a stage
+#define PROFILE_STAGE(stage) Profiler::StageTimer VMSIM_PROFILE_CONCAT(profileTimer, __LINE__)(ProfileStage::stage)
+
+#else
+
+#define PROFILE_STAGE(stage) ((void)0)
+
+#endif // VMSIM_PROFILE
+
+#endif // PROFILER_H
@@ -0,0 +1,138 @@
+#include "SampleStats.h"
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include "../Log/Log.h"
+
+using namespace std;
+
+SampleStats::SampleStats(uint64_t windowInstructions, uint64_t intervalInstructions, uint64_t warmupInstructions, bool representative)
+    : windowInstructions(windowInstructions), intervalInstructions(intervalInstructions),
+      warmupInstructions(warmupInstructions), representative(representative)
+{
+    if (windowInstructions == 0 || windowInstructions > intervalInstructions)
+    {
+        throw invalid_argument("Sample windows must be between 1 instruction and the sample interval long");
+    }
+    if (warmupInstructions > intervalInstructions - windowInstructions)
+    {
+        throw invalid_argument("Warm-up and window together must fit into the sample interval");
+    }
+}
+
+void SampleStats::countInstruction(bool detailed)
+{
+    instructions++;
+    if (detailed)
+    {
+        detailedInstructions++;
+    }
+}
+
+void SampleStats::addWindow(const SampleWindow &window)
+{
+    // A window without accesses has no rates to contribute
+    if (window.accesses > 0)
+    {
+        windows.push_back(window);
+    }
+}
+
+double SampleStats::studentT95(uint64_t degreesOfFreedom)
+{
+    static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                   2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                   2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+    if (degreesOfFreedom == 0)
+    {
+        return 0;
+    }
+    if (degreesOfFreedom <= 30)
+    {
+        return table[degreesOfFreedom - 1];
+    }
+    return degreesOfFreedom <= 60 ? 2.000 : degreesOfFreedom <= 120 ? 1.980 : 1.960;
+}
+
+// Weighted mean of a per-window rate. Periodic windows are weighted equally, and their spread gives the
+// confidence interval of the mean
+template <typename Rate>
+SampleStats::Estimate SampleStats::estimate(Rate rate) const
+{
+    Estimate result;
+    double weights = 0;
+    for (const SampleWindow &window : windows)
+    {
+        result.mean += window.weight * rate(window);
+        weights += window.weight;
+    }
+    if (weights == 0)
+    {
+        return result;
+    }
+    result.mean /= weights;
+    if (representative || windows.size() < 2)
+    {
+        return result;
+    }
+    double squares = 0;
+    for (const SampleWindow &window : windows)
+    {
+        squares += (rate(window) - result.mean) * (rate(window) - result.mean);
+    }
+    double deviation = sqrt(squares / (windows.size() - 1));
+    result.halfWidth = studentT95(windows.size() - 1) * deviation / sqrt(static_cast<double>(windows.size()));
+    return result;
+}
+
+void SampleStats::displayStatistics(uint64_t totalAccesses) const
+{
+    Estimate tlbHitRate = estimate([](const SampleWindow &window) { return static_cast<double>(window.tlbHits) / window.accesses; });
+    Estimate faultRate = estimate([](const SampleWindow &window) { return static_cast<double>(window.faults) / window.accesses; });
+    auto describe = [this](const Estimate &rate, double scale, const string &unit) {
+        ostringstream text;
+        text << fixed << setprecision(2) << rate.mean * scale << unit;
+        if (!representative && windows.size() >= 2)
+        {
+            text << " +- " << rate.halfWidth * scale << unit;
+        }
+        return text.str();
+    };
+
+    *logStream << "--- Sampled Simulation ---" << endl;
+    *logStream << "  Windows: " << windows.size() << (representative ? " representative" : " periodic") << " windows of "
+               << windowInstructions << " instructions, interval " << intervalInstructions << ", warm-up "
+               << warmupInstructions << endl;
+    *logStream << "  Detailed Instructions: " << detailedInstructions << " of " << instructions << " ("
+               << (instructions > 0 ? static_cast<double>(detailedInstructions) / instructions * 100 : 0.0) << "%)" << endl;
+    if (windows.empty())
+    {
+        *logStream << "  No window saw a memory access, nothing to extrapolate" << endl << endl;
+        return;
+    }
+    if (representative)
+    {
+        *logStream << "  Representative Windows (start instruction: weight):";
+        for (const SampleWindow &window : windows)
+        {
+            *logStream << " " << window.start << ": " << fixed << setprecision(3) << window.weight << defaultfloat;
+        }
+        *logStream << endl;
+    }
+    *logStream << "  Estimated TLB Hit Rate: " << describe(tlbHitRate, 100, "%") << endl;
+    *logStream << "  Estimated Page Fault Rate: " << describe(faultRate, 100, "%") << endl;
+    *logStream << "  Estimated Page Faults: " << describe(faultRate, static_cast<double>(totalAccesses), "") << " of "
+               << totalAccesses << " accesses" << endl;
+    if (representative)
+    {
+        *logStream << "  Weighted by cluster size, representative windows give no confidence interval" << endl;
+    }
+    else if (windows.size() >= 2)
+    {
+        *logStream << "  Intervals are 95% confidence over " << windows.size() << " windows" << endl;
+    }
+    *logStream << endl;
+}
@@ -0,0 +1,53 @@
+#ifndef SAMPLESTATS_H
+#define SAMPLESTATS_H
+
+#include <cstdint>
+#include <vector>
+
+// Counters of one detailed window, summed over all processes
+struct SampleWindow
+{
+    uint64_t start = 0; // Trace instruction the window starts at
+    uint64_t accesses = 0;
+    uint64_t tlbHits = 0;
+    uint64_t faults = 0;
+    double weight = 1; // Share of the trace the window stands for, equal for periodic windows
+};
+
+// Estimates of a sampled replay: the rates measured in the detailed windows are extrapolated to the
+// whole trace. Periodic windows are a systematic sample and get a Student-t confidence interval,
+// representative windows picked by clustering are weighted by their cluster's share instead
+class SampleStats
+{
+private:
+    uint64_t windowInstructions;
+    uint64_t intervalInstructions;
+    uint64_t warmupInstructions;
+    bool representative;
+    uint64_t instructions = 0;
+    uint64_t detailedInstructions = 0;
+    std::vector<SampleWindow> windows;
+
+    struct Estimate
+    {
+        double mean = 0;
+        double halfWidth = 0; // Of the 95% confidence interval, 0 when there is none
+    };
+    template <typename Rate>
+    Estimate estimate(Rate rate) const;
+
+public:
+    SampleStats(uint64_t windowInstructions, uint64_t intervalInstructions, uint64_t warmupInstructions, bool representative);
+
+    // Count one replayed trace instruction, simulated in detail or fast-forwarded
+    void countInstruction(bool detailed);
+    void addWindow(const SampleWindow &window);
+
+    // Two-sided 95% critical value of Student's t distribution
+    static double studentT95(uint64_t degreesOfFreedom);
+
+    // Rates extrapolated to all accesses, detailed ones and fast-forwarded ones
+    void displayStatistics(uint64_t totalAccesses) const;
+};
+
+#endif // SAMPLESTATS_H
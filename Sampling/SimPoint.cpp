@@ -0,0 +1,169 @@
+#include "SimPoint.h"
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+using namespace std;
+
+static const uint32_t MAX_ITERATIONS = 100;
+static const uint64_t CLUSTER_SEED = 1;
+
+SimPoint::SimPoint(uint64_t intervalInstructions) : intervalInstructions(intervalInstructions)
+{
+    if (intervalInstructions == 0)
+    {
+        throw invalid_argument("SimPoint intervals need at least one instruction");
+    }
+}
+
+void SimPoint::recordAccess(uint32_t pid, uint32_t vpn)
+{
+    uint64_t key = (static_cast<uint64_t>(pid) << 32 | vpn) * 0x9E3779B97F4A7C15ULL;
+    current[key >> 59]++;
+    accessesInInterval++;
+}
+
+void SimPoint::completeInstruction()
+{
+    if (++instructionsInInterval == intervalInstructions)
+    {
+        finishInterval();
+    }
+}
+
+void SimPoint::finishInterval()
+{
+    for (double &bucket : current)
+    {
+        bucket = accessesInInterval > 0 ? bucket / accessesInInterval : 0;
+    }
+    signatures.push_back(current);
+    current.fill(0);
+    instructionsInInterval = 0;
+    accessesInInterval = 0;
+}
+
+double SimPoint::distance(const Signature &a, const Signature &b)
+{
+    double sum = 0;
+    for (uint32_t i = 0; i < SIGNATURE_SIZE; i++)
+    {
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    }
+    return sum;
+}
+
+vector<SimPoint::Choice> SimPoint::choose(uint32_t clusters)
+{
+    if (instructionsInInterval > 0)
+    {
+        finishInterval();
+    }
+    if (clusters == 0)
+    {
+        throw invalid_argument("SimPoint needs at least one cluster");
+    }
+    size_t count = signatures.size();
+    if (count == 0)
+    {
+        return {};
+    }
+    clusters = static_cast<uint32_t>(min<size_t>(clusters, count));
+
+    // k-means++ seeding: each next centre is picked with probability proportional to its squared distance
+    mt19937_64 random(CLUSTER_SEED);
+    vector<Signature> centres{signatures[random() % count]};
+    vector<double> nearest(count, numeric_limits<double>::max());
+    while (centres.size() < clusters)
+    {
+        double total = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            nearest[i] = min(nearest[i], distance(signatures[i], centres.back()));
+            total += nearest[i];
+        }
+        if (total == 0)
+        {
+            break; // Fewer distinct signatures than clusters
+        }
+        double target = uniform_real_distribution<double>(0, total)(random);
+        size_t pick = 0;
+        while (pick + 1 < count && (target -= nearest[pick]) > 0)
+        {
+            pick++;
+        }
+        centres.push_back(signatures[pick]);
+    }
+
+    // Lloyd iterations until no interval changes its cluster
+    vector<uint32_t> assignment(count, 0);
+    for (uint32_t iteration = 0; iteration < MAX_ITERATIONS; iteration++)
+    {
+        bool changed = iteration == 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t best = 0;
+            for (uint32_t c = 1; c < centres.size(); c++)
+            {
+                if (distance(signatures[i], centres[c]) < distance(signatures[i], centres[best]))
+                {
+                    best = c;
+                }
+            }
+            changed |= best != assignment[i];
+            assignment[i] = best;
+        }
+        if (!changed)
+        {
+            break;
+        }
+        vector<Signature> sums(centres.size(), Signature{});
+        vector<uint64_t> sizes(centres.size(), 0);
+        for (size_t i = 0; i < count; i++)
+        {
+            for (uint32_t b = 0; b < SIGNATURE_SIZE; b++)
+            {
+                sums[assignment[i]][b] += signatures[i][b];
+            }
+            sizes[assignment[i]]++;
+        }
+        for (uint32_t c = 0; c < centres.size(); c++)
+        {
+            // An empty cluster keeps its old centre
+            if (sizes[c] > 0)
+            {
+                for (uint32_t b = 0; b < SIGNATURE_SIZE; b++)
+                {
+                    centres[c][b] = sums[c][b] / sizes[c];
+                }
+            }
+        }
+    }
+
+    // The interval closest to each centre represents its cluster
+    vector<Choice> choices;
+    for (uint32_t c = 0; c < centres.size(); c++)
+    {
+        size_t best = count;
+        uint64_t size = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            if (assignment[i] != c)
+            {
+                continue;
+            }
+            size++;
+            if (best == count || distance(signatures[i], centres[c]) < distance(signatures[best], centres[c]))
+            {
+                best = i;
+            }
+        }
+        if (size > 0)
+        {
+            choices.push_back({best, static_cast<double>(size) / count});
+        }
+    }
+    sort(choices.begin(), choices.end(), [](const Choice &a, const Choice &b) { return a.interval < b.interval; });
+    return choices;
+}
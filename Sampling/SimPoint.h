@@ -0,0 +1,45 @@
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// SimPoint-style choice of representative intervals. Every interval of the trace gets a signature, the
+// share of its accesses that falls into each bucket of hashed (pid, VPN) pairs. The signatures are
+// clustered with k-means, and the interval closest to each cluster's centre stands for the whole cluster
+class SimPoint
+{
+public:
+    static const uint32_t SIGNATURE_SIZE = 32;
+
+    struct Choice
+    {
+        uint64_t interval;
+        double weight; // Share of all intervals in the chosen interval's cluster
+    };
+
+private:
+    using Signature = std::array<double, SIGNATURE_SIZE>;
+
+    uint64_t intervalInstructions;
+    uint64_t instructionsInInterval = 0;
+    uint64_t accessesInInterval = 0;
+    Signature current{};
+    std::vector<Signature> signatures;
+
+    void finishInterval();
+    static double distance(const Signature &a, const Signature &b);
+
+public:
+    explicit SimPoint(uint64_t intervalInstructions);
+
+    void recordAccess(uint32_t pid, uint32_t vpn);
+    void completeInstruction();
+
+    // Cluster the intervals seen so far into at most the given number of clusters, deterministically,
+    // and return one interval per cluster in trace order
+    std::vector<Choice> choose(uint32_t clusters);
+};
+
+#endif // SIMPOINT_H
@@ -0,0 +1,159 @@
+#include "Scheduler.h"
+#include <iostream>
+#include "../Log/Log.h"
+
+using namespace std;
+
+static const uint32_t NO_PROCESS = static_cast<uint32_t>(-1);
+
+Scheduler::Scheduler(uint64_t timeSlice, uint64_t switchCost)
+    : timeSlice(timeSlice), switchCost(switchCost), runningPid(NO_PROCESS), lastRunPid(NO_PROCESS)
+{
+}
+
+void Scheduler::addProcess(uint32_t pid)
+{
+    processes[pid] = ProcessState();
+    makeReady(pid);
+}
+
+bool Scheduler::hasProcess(uint32_t pid) const
+{
+    return processes.count(pid) > 0;
+}
+
+void Scheduler::makeReady(uint32_t pid)
+{
+    ProcessState &process = processes.at(pid);
+    process.state = State::Ready;
+    process.readySince = clock;
+    readyQueue.push_back(pid);
+}
+
+void Scheduler::completeIo()
+{
+    while (!ioCompletions.empty() && ioCompletions.top().first <= clock)
+    {
+        uint32_t pid = ioCompletions.top().second;
+        ioCompletions.pop();
+        makeReady(pid);
+    }
+}
+
+bool Scheduler::pickNext(uint32_t &pid)
+{
+    completeIo();
+    if (runningPid != NO_PROCESS)
+    {
+        if (clock - sliceStart < timeSlice || readyQueue.empty())
+        {
+            if (clock - sliceStart >= timeSlice)
+            {
+                sliceStart = clock; // Nobody else wants the CPU, start a new slice
+            }
+            pid = runningPid;
+            return true;
+        }
+        // Slice used up while another process is ready
+        preemptions++;
+        uint32_t preempted = runningPid;
+        runningPid = NO_PROCESS;
+        makeReady(preempted);
+    }
+
+    if (readyQueue.empty())
+    {
+        if (ioCompletions.empty())
+        {
+            return false;
+        }
+        uint64_t wakeUp = ioCompletions.top().first;
+        *logStream << "CPU idle for " << wakeUp - clock << " ns until process " << ioCompletions.top().second
+                   << "'s I/O completes" << endl;
+        idleTime += wakeUp - clock;
+        clock = wakeUp;
+        completeIo();
+    }
+
+    uint32_t next = readyQueue.front();
+    readyQueue.pop_front();
+    ProcessState &process = processes.at(next);
+    process.waitTime += clock - process.readySince;
+    if (next != lastRunPid && lastRunPid != NO_PROCESS)
+    {
+        clock += switchCost;
+        switchTime += switchCost;
+        contextSwitches++;
+    }
+    lastRunPid = next;
+    process.state = State::Running;
+    runningPid = next;
+    sliceStart = clock;
+    pid = next;
+    return true;
+}
+
+void Scheduler::runInstruction(uint64_t cpuTime)
+{
+    ProcessState &process = processes.at(runningPid);
+    process.instructions++;
+    process.runTime += cpuTime;
+    busyTime += cpuTime;
+    clock += cpuTime;
+}
+
+uint64_t Scheduler::block(uint64_t ioTime)
+{
+    ProcessState &process = processes.at(runningPid);
+    process.state = State::Blocked;
+    process.stallTime += ioTime;
+    process.blockingFaults++;
+    ioCompletions.emplace(clock + ioTime, runningPid);
+    runningPid = NO_PROCESS;
+    return clock + ioTime;
+}
+
+void Scheduler::finish()
+{
+    ProcessState &process = processes.at(runningPid);
+    process.state = State::Finished;
+    process.finishTime = clock;
+    runningPid = NO_PROCESS;
+}
+
+uint64_t Scheduler::getClock() const
+{
+    return clock;
+}
+
+void Scheduler::displayStatistics() const
+{
+    uint64_t instructions = 0;
+    uint64_t blockingFaults = 0;
+    for (const auto &[pid, process] : processes)
+    {
+        instructions += process.instructions;
+        blockingFaults += process.blockingFaults;
+    }
+
+    *logStream << "--- Scheduler Statistics ---" << endl;
+    *logStream << "  Simulated Time: " << clock << " ns" << endl;
+    *logStream << "  CPU Utilization: " << (clock > 0 ? static_cast<double>(busyTime) / clock * 100 : 0.0) << "% (busy "
+               << busyTime << " ns, idle " << idleTime << " ns, context switching " << switchTime << " ns)" << endl;
+    *logStream << "  Context Switches: " << contextSwitches << ", preemptions: " << preemptions << endl;
+    *logStream << "  Blocking Faults: " << blockingFaults << endl;
+    *logStream << "  Throughput: " << (clock > 0 ? static_cast<double>(instructions) / clock * 1000000 : 0.0)
+               << " instructions per ms" << endl;
+    for (const auto &[pid, process] : processes)
+    {
+        *logStream << "  Process " << pid << ": " << process.instructions << " instructions, run " << process.runTime
+                   << " ns, I/O stall " << process.stallTime << " ns (" << process.blockingFaults << " faults), ready wait "
+                   << process.waitTime << " ns";
+        if (process.state == State::Finished)
+        {
+            *logStream << ", finished at " << process.finishTime << " ns";
+        }
+        *logStream << endl;
+    }
+    *logStream << endl;
+}
@@ -0,0 +1,81 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <queue>
+#include <utility>
+#include <vector>
+
+// Event-driven round-robin scheduler for one CPU on a simulated nanosecond clock. The running process
+// is charged for each instruction it executes, a fault that waits for I/O blocks it until the I/O
+// completes and the CPU runs other ready processes, or idles until the next completion
+class Scheduler
+{
+private:
+    enum class State { Ready, Running, Blocked, Finished };
+
+    struct ProcessState
+    {
+        State state = State::Ready;
+        uint64_t readySince = 0;
+        uint64_t instructions = 0;
+        uint64_t runTime = 0;       // CPU time spent executing instructions and fault work
+        uint64_t stallTime = 0;     // Time blocked on I/O
+        uint64_t waitTime = 0;      // Time ready but waiting for the CPU
+        uint64_t blockingFaults = 0;
+        uint64_t finishTime = 0;
+    };
+
+    uint64_t timeSlice;
+    uint64_t switchCost;
+
+    uint64_t clock = 0;
+    uint64_t sliceStart = 0;
+    uint32_t runningPid;
+    uint32_t lastRunPid; // Process whose context the CPU holds, switching away from it costs switchCost
+
+    std::map<uint32_t, ProcessState> processes;
+    std::deque<uint32_t> readyQueue;
+    // I/O completions as (time, pid), earliest first
+    std::priority_queue<std::pair<uint64_t, uint32_t>, std::vector<std::pair<uint64_t, uint32_t>>,
+                        std::greater<std::pair<uint64_t, uint32_t>>> ioCompletions;
+
+    uint64_t busyTime = 0;
+    uint64_t idleTime = 0;
+    uint64_t switchTime = 0;
+    uint64_t contextSwitches = 0;
+    uint64_t preemptions = 0;
+
+    // Move the processes whose I/O completed by now to the ready queue
+    void completeIo();
+    void makeReady(uint32_t pid);
+
+public:
+    Scheduler(uint64_t timeSlice, uint64_t switchCost);
+
+    // Add a process that is ready to run from now on, e.g. at start-up or after a fork
+    void addProcess(uint32_t pid);
+    bool hasProcess(uint32_t pid) const;
+
+    // Choose the process to run next, idling the CPU until an I/O completes if nothing is ready.
+    // Returns false once no process is ready or blocked any more
+    bool pickNext(uint32_t &pid);
+
+    // The running process executed one instruction that kept the CPU busy for cpuTime
+    void runInstruction(uint64_t cpuTime);
+
+    // The running process waits ioTime for a page to be read, returns the time it completes
+    uint64_t block(uint64_t ioTime);
+
+    // The running process has no instructions left
+    void finish();
+
+    uint64_t getClock() const;
+
+    void displayStatistics() const;
+};
+
+#endif // SCHEDULER_H
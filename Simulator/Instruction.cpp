@@ -0,0 +1,135 @@
+#include "Instruction.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include "../Profiler/Profiler.h"
+
+using namespace std;
+
+// Next whitespace-separated field of a trace line from pos on, empty at the end of the line. Trace fields
+// fit in a short string, so unlike a string stream this does not allocate
+static string nextField(const string& line, size_t& pos) {
+    static const char* whitespace = " \t\r\n\v\f";
+    size_t start = line.find_first_not_of(whitespace, pos);
+    if (start == string::npos) {
+        pos = line.size();
+        return string();
+    }
+    pos = min(line.find_first_of(whitespace, start), line.size());
+    return line.substr(start, pos - start);
+}
+
+TraceOp parseInstruction(const string& line) {
+    TraceOp op;
+    size_t pos = 0;
+    string pidField = nextField(line, pos);
+    char* end = nullptr;
+    unsigned long value = strtoul(pidField.c_str(), &end, 10);
+    // Lines that do not start with a pid are not instructions
+    if (pidField.empty() || *end != '\0') {
+        return op;
+    }
+    op.pid = static_cast<uint32_t>(value);
+    string command = nextField(line, pos);
+    string operand = nextField(line, pos);
+    string mode = nextField(line, pos);
+
+    if (command == "switch") {
+        op.command = TraceCommand::Switch;
+    }
+    else if (command == "alloc" || command == "free") {
+        op.command = command == "alloc" ? TraceCommand::Alloc : TraceCommand::Free;
+        op.operand = stoul(operand, nullptr, 16);
+    }
+    else if (command == "fork" || command == "spawn") {
+        op.command = command == "fork" ? TraceCommand::Fork : TraceCommand::Spawn;
+        op.operand = stoul(operand);
+    }
+    else if (command == "exit") {
+        op.command = TraceCommand::Exit;
+    }
+    else if (command.substr(0, 6) == "access") {
+        op.command = TraceCommand::Access;
+        op.operand = stoul(operand, nullptr, 16);
+        // Code fetches only read, data accesses are writes unless the trace marks them "r"
+        op.type = command == "access_code" ? AccessType::Code
+                : command == "access_stak" ? AccessType::Stack : AccessType::Heap;
+        op.isWrite = op.type != AccessType::Code && mode != "r";
+    }
+    return op;
+}
+
+string formatInstruction(const TraceOp& op) {
+    static const char* accessCommands[] = {"access_code", "access_stak", "access_heap"};
+    char line[64];
+    switch (op.command) {
+    case TraceCommand::Access:
+        if (op.type == AccessType::Code) {
+            snprintf(line, sizeof(line), "%u\taccess_code\t0x%x", op.pid, op.operand);
+        } else {
+            snprintf(line, sizeof(line), "%u\t%s\t0x%x\t%c", op.pid, accessCommands[static_cast<int>(op.type)], op.operand, op.isWrite ? 'w' : 'r');
+        }
+        break;
+    case TraceCommand::Alloc:
+    case TraceCommand::Free:
+        snprintf(line, sizeof(line), "%u\t%s\t\t0x%x", op.pid, op.command == TraceCommand::Alloc ? "alloc" : "free", op.operand);
+        break;
+    case TraceCommand::Switch:
+        snprintf(line, sizeof(line), "%u\tswitch\t", op.pid);
+        break;
+    case TraceCommand::Fork:
+    case TraceCommand::Spawn:
+        snprintf(line, sizeof(line), "%u\t%s\t\t%u", op.pid, op.command == TraceCommand::Fork ? "fork" : "spawn", op.operand);
+        break;
+    case TraceCommand::Exit:
+        snprintf(line, sizeof(line), "%u\texit\t", op.pid);
+        break;
+    case TraceCommand::None:
+        line[0] = '\0';
+        break;
+    }
+    return line;
+}
+
+void executeOperation(Simulator& simulator, const TraceOp& op, bool fastForward) {
+    switch (op.command) {
+    case TraceCommand::Switch:
+        simulator.switchProcess(op.pid);
+        break;
+    case TraceCommand::Alloc:
+        simulator.allocateMemory(op.operand);
+        break;
+    case TraceCommand::Free:
+        simulator.freeMemory(op.operand);
+        break;
+    case TraceCommand::Fork:
+        simulator.forkProcess(op.pid, op.operand);
+        break;
+    case TraceCommand::Spawn:
+        simulator.spawnProcess(op.pid, op.operand);
+        break;
+    case TraceCommand::Exit:
+        simulator.exitProcess(op.pid);
+        break;
+    case TraceCommand::Access:
+        if (fastForward) {
+            simulator.fastForwardAccess(op.operand, op.type, op.isWrite);
+        } else {
+            simulator.accessMemory(op.operand, op.type, op.isWrite);
+        }
+        break;
+    case TraceCommand::None:
+        break;
+    }
+}
+
+void executeInstruction(Simulator& simulator, const string& line, bool fastForward) {
+    PROFILE_STAGE(Instruction);
+    TraceOp op;
+    {
+        PROFILE_STAGE(Parse);
+        op = parseInstruction(line);
+    }
+    executeOperation(simulator, op, fastForward);
+    simulator.completeInstruction();
+}
@@ -0,0 +1,33 @@
+#ifndef INSTRUCTION_H
+#define INSTRUCTION_H
+
+#include <cstdint>
+#include <string>
+#include "Simulator.h"
+
+// Trace commands, as generator.py writes them
+enum class TraceCommand : uint8_t { None, Access, Alloc, Free, Switch, Fork, Spawn, Exit };
+
+// One decoded trace instruction. Lines that are not instructions decode to TraceCommand::None
+struct TraceOp {
+    uint32_t pid = 0;
+    TraceCommand command = TraceCommand::None;
+    AccessType type = AccessType::Heap; // Accesses only
+    bool isWrite = false;               // Accesses only
+    uint32_t operand = 0;               // Address of an access, size of an alloc or free, pid of a fork's or spawn's child
+};
+
+// Decode a trace line, throws if the operand of an instruction is not a number
+TraceOp parseInstruction(const std::string& line);
+
+// The trace line of an instruction, as generator.py writes it
+std::string formatInstruction(const TraceOp& op);
+
+// Run a decoded instruction on the simulator's current CPU, fast-forwarded accesses only keep residency warm.
+// The caller counts it with Simulator::completeInstruction
+void executeOperation(Simulator& simulator, const TraceOp& op, bool fastForward = false);
+
+// Decode, run and count one trace line
+void executeInstruction(Simulator& simulator, const std::string& line, bool fastForward = false);
+
+#endif // INSTRUCTION_H
@@ -0,0 +1,160 @@
+#include "Process.h"
+#include <iostream>
+#include "../Log/Log.h"
+
+using namespace std;
+
+Process::Process(uint32_t pid, uint32_t numPages, const list<uint32_t>& frames, const shared_ptr<const PageTableSettings>& settings)
+    : id(pid), settings(settings), availableFrames(frames.begin(), frames.end(), PoolAllocator<uint32_t>(settings->arena)),
+      maxFrames(numPages), allocatedFrames(frames.size()) {}
+
+void ProcessCounters::add(const ProcessCounters& other) {
+    memoryAccesses += other.memoryAccesses;
+    tlbHits += other.tlbHits;
+    tlbMisses += other.tlbMisses;
+    pageTableHits += other.pageTableHits;
+    pageFaults += other.pageFaults;
+    evictions += other.evictions;
+}
+
+double ProcessCounters::getTLBHitRate() const {
+    return memoryAccesses > 0 ? static_cast<double>(tlbHits) / memoryAccesses : 0.0;
+}
+
+double ProcessCounters::getPageTableHitRate() const {
+    return tlbMisses > 0 ? static_cast<double>(pageTableHits) / tlbMisses : 0.0;
+}
+
+void Process::addCounters(ProcessCounters& counters) const {
+    counters.memoryAccesses += memoryAccessAttempts;
+    counters.tlbHits += tlbHits;
+    counters.tlbMisses += tlbMisses;
+    counters.pageTableHits += pageTableHits;
+    counters.pageFaults += pageTableMisses;
+    counters.evictions += evictions;
+}
+
+void Process::saveCounters(ProcessRecord& record) const {
+    record.pid = id;
+    record.maxFrames = maxFrames;
+    record.allocatedFrames = allocatedFrames;
+    record.tlbHits = tlbHits;
+    record.tlbMisses = tlbMisses;
+    record.pageTableHits = pageTableHits;
+    record.pageTableMisses = pageTableMisses;
+    record.memoryAccessAttempts = memoryAccessAttempts;
+    record.directReclaimStalls = directReclaimStalls;
+    record.evictions = evictions;
+    record.heapSize = heapSize;
+}
+
+void Process::restoreCounters(const ProcessRecord& record) {
+    allocatedFrames = record.allocatedFrames;
+    tlbHits = record.tlbHits;
+    tlbMisses = record.tlbMisses;
+    pageTableHits = record.pageTableHits;
+    pageTableMisses = record.pageTableMisses;
+    memoryAccessAttempts = record.memoryAccessAttempts;
+    directReclaimStalls = record.directReclaimStalls;
+    evictions = record.evictions;
+    heapSize = record.heapSize;
+}
+
+uint32_t Process::getPid() {
+    return id;
+}
+uint32_t Process::getMaxFrames() {
+    return maxFrames;
+}
+
+uint32_t Process::getAllocationQuota() {
+    return allocatedFrames < maxFrames ? maxFrames - allocatedFrames : 0;
+}
+
+bool Process::hasFrameQuota() const {
+    return allocatedFrames < maxFrames;
+}
+
+PageTable* Process::getPageTable() {
+    if (!pageTable) {
+        pageTable = make_unique<PageTable>(settings->addressBits, settings->pageSize, settings->arena, settings->invertedTable, id);
+    }
+    return pageTable.get();
+}
+
+void Process::allocateMemory(list<uint32_t> frames) {
+    allocatedFrames += frames.size();
+    while (!frames.empty()) {
+        availableFrames.push_back(frames.front());
+        frames.pop_front();
+    }
+}
+
+void Process::freeMemory(uint32_t frameNumber) {
+    allocatedFrames--;
+}
+
+// Account for a frame taken directly from the physical frame manager on a page fault
+void Process::chargeFrame() {
+    allocatedFrames++;
+}
+
+uint32_t Process::getAFrame() {
+    if (availableFrames.size() < 1) {
+        return -1;
+    }
+    uint32_t frame = availableFrames.front();
+    availableFrames.pop_front();
+    return frame;
+}
+
+// Prefer one of the process's frames with the given page color, any frame otherwise
+uint32_t Process::getAFrameWithColor(uint32_t color, uint32_t colors) {
+    for (auto it = availableFrames.begin(); it != availableFrames.end(); ++it) {
+        if (*it % colors == color) {
+            uint32_t frame = *it;
+            availableFrames.erase(it);
+            return frame;
+        }
+    }
+    return getAFrame();
+}
+
+void Process::returnAFrame(uint32_t frame) {
+    availableFrames.push_back(frame);
+}
+
+void Process::releaseFrames(uint32_t count, vector<uint32_t>& frames) {
+    while (count > 0 && !availableFrames.empty()) {
+        frames.push_back(availableFrames.back());
+        availableFrames.pop_back();
+        allocatedFrames--;
+        count--;
+    }
+}
+
+void Process::growHeap(uint32_t bytes) {
+    heapSize = bytes > UINT32_MAX - heapSize ? UINT32_MAX : heapSize + bytes;
+}
+
+void Process::shrinkHeap(uint32_t bytes) {
+    heapSize -= min(bytes, heapSize);
+}
+
+double Process::getTLBHitRate() const {
+    return memoryAccessAttempts > 0 ? static_cast<double>(tlbHits) / memoryAccessAttempts : 0.0;
+}
+
+double Process::getPageTableHitRate() const {
+    return tlbMisses > 0 ? static_cast<double>(pageTableHits) / tlbMisses : 0.0;
+}
+
+void Process::displayStatistics() const {
+    *logStream << "Process " << id << " Statistics:" << endl;
+    // cout << "  Memory Access Attempts: " << memoryAccessAttempts << endl;
+    *logStream << "  Memory Access Attempts: " << std::dec << memoryAccessAttempts << endl;
+    *logStream << "  TLB Hit Rate: " << getTLBHitRate() * 100 << "%" << endl;
+    *logStream << "  Page Table Hit Rate: " << getPageTableHitRate() * 100 << "%" << endl;
+    *logStream << "  Direct Reclaim Stalls: " << directReclaimStalls << endl;
+    *logStream << endl;
+}
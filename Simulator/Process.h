@@ -0,0 +1,116 @@
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+#include "../PageTable/PageTable.h"
+#include "../Checkpoint/Checkpoint.h"
+#include "../Allocator/NodeArena.h"
+#include "../Allocator/PoolAllocator.h"
+
+using namespace std;
+
+// What a process needs to build its page table, one instance shared by every process of a simulator
+struct PageTableSettings {
+    uint32_t addressBits;
+    uint32_t pageSize;
+    shared_ptr<NodeArena> arena;
+    shared_ptr<InvertedPageTable> invertedTable;
+};
+
+// Counters of several processes added up, e.g. of the processes that have exited
+struct ProcessCounters {
+    uint64_t memoryAccesses = 0;
+    uint64_t tlbHits = 0;
+    uint64_t tlbMisses = 0;
+    uint64_t pageTableHits = 0;
+    uint64_t pageFaults = 0;
+    uint64_t evictions = 0;
+
+    void add(const ProcessCounters& other);
+    double getTLBHitRate() const;
+    double getPageTableHitRate() const;
+};
+
+// A process owns its page table and frame list, so it can be moved but not copied. The page table is
+// built when the process first touches memory, until then a process is a little over a hundred bytes
+class Process {
+private:
+    uint32_t id;
+    shared_ptr<const PageTableSettings> settings;
+    unique_ptr<PageTable> pageTable;
+    PoolList<uint32_t> availableFrames; // A list of physical frames to use
+    uint32_t maxFrames; // Max number of frames for this process
+    uint32_t allocatedFrames;  // Number of frames assigned to this process, should never exceed maxFrames
+    uint32_t heapSize = 0;     // Bytes allocated and not freed by the trace, the heap ends heapSize bytes above its base
+
+    // Counters for tracking individual process statistics
+    uint32_t tlbHits = 0;
+    uint32_t tlbMisses = 0;
+    uint32_t pageTableHits = 0;
+    uint32_t pageTableMisses = 0;
+    uint32_t memoryAccessAttempts = 0;
+    uint32_t directReclaimStalls = 0; // Page faults that had to run the clock sweep synchronously
+    uint32_t evictions = 0;           // Pages evicted from memory, by any reclaim
+
+public:
+    // The page table and frame list draw from the settings' arena, entries go to its inverted table if there is one
+    Process(uint32_t pid, uint32_t numPages, const list<uint32_t>& allocatedFrames, const shared_ptr<const PageTableSettings>& settings);
+    Process(const Process&) = delete;
+    Process& operator=(const Process&) = delete;
+    Process(Process&&) = default;
+    Process& operator=(Process&&) = default;
+    uint32_t getPid();
+    uint32_t getMaxFrames();
+    uint32_t getAllocationQuota();
+    bool hasFrameQuota() const;
+    // Frames charged to the quota: the mapped pages and the frames held for later faults
+    uint32_t getAllocatedFrames() const { return allocatedFrames; }
+    // The page table, built on first use
+    PageTable* getPageTable();
+    // The page table, or nullptr if the process has not touched memory yet
+    PageTable* findPageTable() const { return pageTable.get(); }
+    void allocateMemory(list<uint32_t> allocatedFrames);
+    void freeMemory(uint32_t frameNumber);
+    void chargeFrame();
+    uint32_t getAFrame();
+    uint32_t getAFrameWithColor(uint32_t color, uint32_t colors);
+    void returnAFrame(uint32_t frame);
+    // Give up to count frames the process holds but has not mapped, appending them to frames
+    void releaseFrames(uint32_t count, vector<uint32_t>& frames);
+
+    uint32_t getHeapSize() const { return heapSize; }
+    void growHeap(uint32_t bytes);
+    void shrinkHeap(uint32_t bytes);
+
+    // Functions to increment counters
+    void incrementTLBHit() { tlbHits++; }
+    void incrementTLBMiss() { tlbMisses++; }
+    void incrementPageTableHit() { pageTableHits++; }
+    void incrementPageTableMiss() { pageTableMisses++; }
+    void incrementMemoryAccess() { memoryAccessAttempts++; }
+    void incrementDirectReclaimStall() { directReclaimStalls++; }
+    void incrementEviction() { evictions++; }
+
+    uint32_t getTLBHits() const { return tlbHits; }
+    uint32_t getTLBMisses() const { return tlbMisses; }
+    uint32_t getPageFaults() const { return pageTableMisses; }
+    uint32_t getEvictions() const { return evictions; }
+    uint32_t getMemoryAccesses() const { return memoryAccessAttempts; }
+    void addCounters(ProcessCounters& counters) const;
+
+    // Checkpoints: the frames the process holds but has not mapped yet, and its counters
+    const PoolList<uint32_t>& getAvailableFrames() const { return availableFrames; }
+    void saveCounters(ProcessRecord& record) const;
+    void restoreCounters(const ProcessRecord& record);
+
+    // Functions to calculate hit rates
+    double getTLBHitRate() const;
+    double getPageTableHitRate() const;
+    // Display statistics for the process
+    void displayStatistics() const;
+};
+
+#endif // PROCESS_H
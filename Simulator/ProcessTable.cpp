@@ -0,0 +1,68 @@
+#include "ProcessTable.h"
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+const uint32_t ProcessTable::DENSE_PIDS;
+
+Process* ProcessTable::findSparse(uint32_t pid) const {
+    if (pid < DENSE_PIDS) {
+        return nullptr;
+    }
+    auto it = sparseProcesses.find(pid);
+    return it == sparseProcesses.end() ? nullptr : it->second.get();
+}
+
+Process& ProcessTable::at(uint32_t pid) {
+    Process* process = find(pid);
+    if (!process) {
+        throw out_of_range("No process " + to_string(pid));
+    }
+    return *process;
+}
+
+Process& ProcessTable::insert(uint32_t pid, unique_ptr<Process> process) {
+    if (contains(pid)) {
+        throw runtime_error("Process " + to_string(pid) + " already exists");
+    }
+    Process& inserted = *process;
+    if (pid < DENSE_PIDS) {
+        if (pid >= slots.size()) {
+            slots.resize(pid + 1);
+        }
+        slots[pid] = move(process);
+    } else {
+        sparseProcesses[pid] = move(process);
+    }
+    processes++;
+    return inserted;
+}
+
+unique_ptr<Process> ProcessTable::remove(uint32_t pid) {
+    unique_ptr<Process> removed;
+    if (pid < slots.size()) {
+        removed = move(slots[pid]);
+    } else if (pid >= DENSE_PIDS) {
+        auto it = sparseProcesses.find(pid);
+        if (it != sparseProcesses.end()) {
+            removed = move(it->second);
+            sparseProcesses.erase(it);
+        }
+    }
+    processes -= removed ? 1 : 0;
+    return removed;
+}
+
+uint32_t ProcessTable::nextPid(uint32_t pid) const {
+    for (size_t slot = pid; slot < slots.size(); slot++) {
+        if (slots[slot]) {
+            return static_cast<uint32_t>(slot);
+        }
+    }
+    auto it = sparseProcesses.lower_bound(pid);
+    if (it != sparseProcesses.end()) {
+        return it->first;
+    }
+    return (*begin()).first;
+}
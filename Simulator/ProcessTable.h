@@ -0,0 +1,82 @@
+#ifndef PROCESSTABLE_H
+#define PROCESSTABLE_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Process.h"
+
+using namespace std;
+
+// Processes by pid. Pids below DENSE_PIDS index a vector of slots, so a lookup is an array access; larger
+// pids, which traces rarely use, go to an ordered map. A slot holds a pointer, so a process stays put while
+// the table grows and a free slot costs one null pointer. Iteration is in pid order, like a map
+class ProcessTable {
+public:
+    static const uint32_t DENSE_PIDS = 1U << 22;
+
+    class const_iterator {
+    private:
+        const ProcessTable* table;
+        size_t slot; // Dense slot, the number of slots once past them
+        map<uint32_t, unique_ptr<Process>>::const_iterator sparse;
+
+        void skipFreeSlots() {
+            while (slot < table->slots.size() && !table->slots[slot]) {
+                slot++;
+            }
+        }
+
+    public:
+        const_iterator(const ProcessTable* table, size_t slot, map<uint32_t, unique_ptr<Process>>::const_iterator sparse)
+            : table(table), slot(slot), sparse(sparse) {
+            skipFreeSlots();
+        }
+        pair<uint32_t, const Process&> operator*() const {
+            if (slot < table->slots.size()) {
+                return {static_cast<uint32_t>(slot), *table->slots[slot]};
+            }
+            return {sparse->first, *sparse->second};
+        }
+        const_iterator& operator++() {
+            if (slot < table->slots.size()) {
+                slot++;
+                skipFreeSlots();
+            } else {
+                ++sparse;
+            }
+            return *this;
+        }
+        bool operator!=(const const_iterator& other) const { return slot != other.slot || sparse != other.sparse; }
+    };
+
+    Process* find(uint32_t pid) { return pid < slots.size() ? slots[pid].get() : findSparse(pid); }
+    const Process* find(uint32_t pid) const { return pid < slots.size() ? slots[pid].get() : findSparse(pid); }
+    // Throws out_of_range if there is no such process
+    Process& at(uint32_t pid);
+    bool contains(uint32_t pid) const { return find(pid) != nullptr; }
+
+    // Throws if the pid is taken
+    Process& insert(uint32_t pid, unique_ptr<Process> process);
+    // The process, now out of the table, or nullptr if there is none
+    unique_ptr<Process> remove(uint32_t pid);
+
+    // The first pid from pid on, wrapping around to the smallest one. The table must not be empty
+    uint32_t nextPid(uint32_t pid) const;
+
+    size_t size() const { return processes; }
+    bool empty() const { return processes == 0; }
+    const_iterator begin() const { return const_iterator(this, 0, sparseProcesses.begin()); }
+    const_iterator end() const { return const_iterator(this, slots.size(), sparseProcesses.end()); }
+
+private:
+    vector<unique_ptr<Process>> slots;
+    map<uint32_t, unique_ptr<Process>> sparseProcesses;
+    size_t processes = 0;
+
+    Process* findSparse(uint32_t pid) const;
+};
+
+#endif // PROCESSTABLE_H
@@ -0,0 +1,1549 @@
+#include "Simulator.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include "../TLB/TLB.h"
+#include "../Checkpoint/Checkpoint.h"
+#include "../Log/Log.h"
+#include "../Profiler/Profiler.h"
+
+using namespace std;
+
+const uint32_t Simulator::preAllocatedFrames;
+const uint32_t Simulator::heapBase;
+const uint32_t Simulator::pageTableLevels;
+
+const ProcessTable& Simulator::getProcessTable() {
+    return processTable;
+}
+
+uint32_t Simulator::getPhysicalMemory(){
+    return pageSize * physicalFrames;
+}
+
+Process& Simulator::getCurrentProcess() {
+    return processTable.at(currentProcessId);
+}
+
+Cpu& Simulator::getCurrentCpu() {
+    return cpus[currentCpuId];
+}
+
+// Remove a translation from every TLB that may cache it, returns true if a core was running the process
+bool Simulator::invalidateTranslation(uint32_t pid, uint32_t vpn) {
+    return tlbShootdown.invalidatePage(cpus, currentCpuId, pid, vpn);
+}
+
+// Cores are set up before processes are created and the trace is replayed
+void Simulator::setCpuCount(uint32_t count, uint32_t batchCeiling, bool lazy, uint32_t initiatorCost, uint32_t handlerCost) {
+    if (count == 0 || count > TlbShootdown::MAX_CPUS) {
+        throw runtime_error("Number of CPUs must be between 1 and " + to_string(TlbShootdown::MAX_CPUS));
+    }
+    cpus.clear();
+    for (uint32_t cpu = 0; cpu < count; cpu++) {
+        cpus.emplace_back(cpu, tlbSize, arena);
+    }
+    currentCpuId = 0;
+    tlbShootdown = TlbShootdown(batchCeiling, lazy, initiatorCost, handlerCost);
+}
+
+// Following instructions run on this core, with its TLB and its running process
+void Simulator::setCurrentCpu(uint32_t cpu) {
+    currentCpuId = cpu;
+    currentProcessId = cpus[cpu].getCurrentProcess();
+    cpus[cpu].recordInstruction();
+}
+
+// Give process pid the partition pid, sized for its memory quota. Partitioned processes do not interact,
+// so features that work across processes are not available
+void Simulator::setFramePartitions(const vector<uint32_t>& processPages) {
+    if (pfManager.getMinWatermark() > 0 || kswapdInterval > 0 || tierManager || numaManager || compressedPool || sharedCode || cpus.size() > 1
+        || cacheHierarchy) {
+        throw runtime_error("Frame partitions cannot be combined with watermarks, background reclaim, tiers, NUMA, "
+                            "the compressed pool, shared code, multiple CPUs or caches");
+    }
+    vector<uint32_t> partitionFrames;
+    for (uint32_t pages : processPages) {
+        partitionFrames.push_back(max(pages, preAllocatedFrames));
+    }
+    pfManager.setPartitions(partitionFrames);
+    partitionedFrames = true;
+}
+
+// Take over the processes a parallel replay worker ran, with their frames and statistics
+void Simulator::mergeFrom(Simulator& worker, const vector<uint32_t>& pids) {
+    for (uint32_t pid : pids) {
+        // The process keeps the worker's arena alive. A process that exited left nothing to take over
+        unique_ptr<Process> process = worker.processTable.remove(pid);
+        if (process) {
+            processTable.insert(pid, std::move(process));
+        }
+        pfManager.copyPartition(worker.pfManager, pid);
+    }
+    swapSpace.merge(worker.swapSpace);
+    directReclaimStalls += worker.directReclaimStalls;
+    directReclaimedPages += worker.directReclaimedPages;
+    localReplacements += worker.localReplacements;
+    backgroundReclaimRuns += worker.backgroundReclaimRuns;
+    backgroundReclaimedPages += worker.backgroundReclaimedPages;
+    rangeFrees += worker.rangeFrees;
+    unmappedPages += worker.unmappedPages;
+    rangeFlushes += worker.rangeFlushes;
+    exits += worker.exits;
+    exitedCounters.add(worker.exitedCounters);
+    minorFaults += worker.minorFaults;
+    poolFaults += worker.poolFaults;
+    majorFaults += worker.majorFaults;
+    protectionFaults += worker.protectionFaults;
+    costModel.merge(worker.costModel);
+    if (heatProfiler) {
+        heatProfiler->merge(*worker.heatProfiler);
+    }
+}
+
+void Simulator::displayCpuStatistics() const {
+    if (cpus.size() > 1) {
+        tlbShootdown.displayStatistics(cpus);
+    }
+}
+
+uint32_t Simulator::getPagesFromBytes(uint32_t size) const {
+    return (size + pageSize - 1) / pageSize;
+}
+
+void Simulator::setWatermarks(uint32_t minFrames, uint32_t lowFrames, uint32_t highFrames) {
+    pfManager.setWatermarks(minFrames, lowFrames, highFrames);
+}
+
+void Simulator::setBackgroundReclaimInterval(uint32_t accesses) {
+    kswapdInterval = accesses;
+    accessesSinceKswapd = 0;
+}
+
+void Simulator::setUnmapFlushCeiling(uint32_t pages) {
+    unmapFlushCeiling = pages;
+}
+
+// Evict up to targetPages pages round-robin across processes and return their frames to the frame manager
+uint32_t Simulator::reclaimPages(uint32_t targetPages) {
+    uint32_t reclaimed = 0;
+    if (processTable.empty()) {
+        return reclaimed;
+    }
+
+    uint32_t pid = processTable.nextPid(reclaimCursor);
+    uint32_t idleProcesses = 0; // Consecutive processes with nothing left to evict
+    while (reclaimed < targetPages && idleProcesses < processTable.size()) {
+        Process& process = processTable.at(pid);
+        int frame = evictPage(pid, process);
+        if (frame == -1) {
+            idleProcesses++;
+        } else {
+            idleProcesses = 0;
+            pfManager.freeAFrame(frame);
+            process.freeMemory(frame);
+            *logStream << "Reclaimed frame " << frame << " of process " << pid << endl;
+            reclaimed++;
+        }
+        pid = processTable.nextPid(pid + 1);
+    }
+    reclaimCursor = pid;
+    return reclaimed;
+}
+
+// Evict pages of a process chosen by its clock until one frees a frame, and return that frame, or -1.
+// Evicting a shared page only drops this process's mapping, the frame stays with the other processes
+int Simulator::evictPage(uint32_t pid, Process& process) {
+    PageTable* pageTable = process.findPageTable();
+    while (pageTable && pageTable->getResidentPages() > 0) {
+        uint32_t victimVPN;
+        int frame = pageTable->evictPageUsingClockAlgo(victimVPN);
+        if (frame == -1) {
+            return -1;
+        }
+        process.incrementEviction();
+        invalidateTranslation(pid, victimVPN);
+        // Code pages can be read again from the program file, so they are dropped instead of swapped
+        bool codePage = isCodeCacheFrame(victimVPN, frame);
+        if (!codePage) {
+            swapOutPage(pid, victimVPN);
+        }
+        if (pfManager.removeFrameOwner(frame, makeSwapKey(pid, victimVPN)) > 0) {
+            process.freeMemory(frame);
+            continue;
+        }
+        if (codePage) {
+            codePageCache.erase(victimVPN);
+        }
+        return frame;
+    }
+    return -1;
+}
+
+// Map a page to a frame and record the owner in the frame manager's reverse map
+void Simulator::mapPage(uint32_t pid, uint32_t vpn, uint32_t frame, bool writable) {
+    processTable.at(pid).getPageTable()->updatePageTable(vpn, frame, true, false, true, writable, true, 0);
+    pfManager.setFrameOwner(frame, makeSwapKey(pid, vpn));
+    if (tierManager) {
+        tierManager->resetHeat(frame);
+    }
+    if (numaManager) {
+        numaManager->resetFrame(frame);
+    }
+}
+
+// Point the page identified by owner at newFrame and record it in the reverse map,
+// returns true if a stale TLB entry had to be invalidated
+bool Simulator::remapPage(uint64_t owner, uint32_t newFrame) {
+    uint32_t pid = static_cast<uint32_t>(owner >> 32);
+    uint32_t vpn = static_cast<uint32_t>(owner);
+    PageTableEntry* entry = processTable.at(pid).getPageTable()->getPageTableEntry(vpn);
+    if (isCodeCacheFrame(vpn, entry->getFrameNumber())) {
+        codePageCache[vpn] = newFrame;
+    }
+    entry->setFrameNumber(newFrame);
+    pfManager.setFrameOwner(newFrame, owner);
+    // The old translation must not survive in any TLB
+    return invalidateTranslation(pid, vpn);
+}
+
+// Move a page to a free frame of another tier or node
+bool Simulator::migratePage(uint32_t frame, uint32_t newFrame) {
+    bool invalidated = remapPage(pfManager.getFrameOwner(frame), newFrame);
+    if (tierManager) {
+        tierManager->moveHeat(frame, newFrame);
+    }
+    if (numaManager) {
+        numaManager->resetFrame(newFrame);
+    }
+    pfManager.freeAFrame(frame);
+    return invalidated;
+}
+
+// Swap the frames of two pages, used when the faster tier has no free frame
+void Simulator::exchangePages(uint32_t firstFrame, uint32_t secondFrame) {
+    uint64_t firstOwner = pfManager.getFrameOwner(firstFrame);
+    uint64_t secondOwner = pfManager.getFrameOwner(secondFrame);
+    if (remapPage(firstOwner, secondFrame)) {
+        tierManager->recordTLBInvalidation();
+    }
+    if (remapPage(secondOwner, firstFrame)) {
+        tierManager->recordTLBInvalidation();
+    }
+    tierManager->swapHeat(firstFrame, secondFrame);
+}
+
+// Resident pages of a tier whose heat is at least minHeat
+vector<uint32_t> Simulator::collectTierPages(uint32_t tier, uint32_t minHeat) const {
+    vector<uint32_t> frames;
+    uint32_t firstFrame = pfManager.getTierFirstFrame(tier);
+    uint32_t lastFrame = firstFrame + pfManager.getTierFrames(tier);
+    for (uint32_t frame = firstFrame; frame < lastFrame; frame++) {
+        // Shared frames stay where they are, moving them would mean remapping every process that maps them
+        if (pfManager.getFrameRefCount(frame) == 1 && tierManager->getHeat(frame) >= minHeat) {
+            frames.push_back(frame);
+        }
+    }
+    return frames;
+}
+
+// Promote the hottest pages of every slower tier, demoting the coldest pages of the faster tier when it is full
+void Simulator::balanceTiers() {
+    tierManager->recordScan();
+    uint32_t budget = tierManager->getMigrationLimit();
+    for (uint32_t tier = 1; tier < pfManager.getTierCount(); tier++) {
+        vector<uint32_t> hotPages = collectTierPages(tier, tierManager->getPromoteThreshold());
+        vector<uint32_t> coldPages = collectTierPages(tier - 1, 0);
+        sort(hotPages.begin(), hotPages.end(), [this](uint32_t a, uint32_t b) { return tierManager->getHeat(a) > tierManager->getHeat(b); });
+        sort(coldPages.begin(), coldPages.end(), [this](uint32_t a, uint32_t b) { return tierManager->getHeat(a) < tierManager->getHeat(b); });
+
+        size_t nextCold = 0;
+        for (size_t i = 0; i < hotPages.size(); i++) {
+            uint32_t frame = hotPages[i];
+            if (budget == 0) {
+                tierManager->recordRateLimited(hotPages.size() - i);
+                break;
+            }
+            if (pfManager.getFreeFramesInTier(tier - 1) > 0) {
+                uint32_t target = pfManager.allocateFrameInTier(tier - 1);
+                *logStream << "Promoting frame " << frame << " to frame " << target << " in tier " << tier - 1 << endl;
+                if (migratePage(frame, target)) {
+                    tierManager->recordTLBInvalidation();
+                }
+                tierManager->recordPromotion();
+                budget--;
+                continue;
+            }
+
+            // The faster tier is full, only worth it if its coldest page is colder than this one
+            if (nextCold >= coldPages.size() || tierManager->getHeat(coldPages[nextCold]) >= tierManager->getHeat(frame)) {
+                break;
+            }
+            if (budget < 2) {
+                tierManager->recordRateLimited(hotPages.size() - i);
+                break;
+            }
+            uint32_t coldFrame = coldPages[nextCold++];
+            *logStream << "Exchanging hot frame " << frame << " with cold frame " << coldFrame << " in tier " << tier - 1 << endl;
+            exchangePages(frame, coldFrame);
+            tierManager->recordPromotion();
+            tierManager->recordDemotion();
+            budget -= 2;
+        }
+    }
+    tierManager->ageHeat();
+}
+
+void Simulator::enableTiering(const vector<uint32_t>& tierFrames, const vector<uint32_t>& tierLatencies,
+                              uint32_t scanInterval, uint32_t migrationLimit, uint32_t promoteThreshold) {
+    pfManager.setTiers(tierFrames);
+    tierManager.reset(new TierManager(tierLatencies, physicalFrames, scanInterval, migrationLimit, promoteThreshold));
+}
+
+void Simulator::displayTierStatistics() const {
+    if (!tierManager) {
+        return;
+    }
+    vector<uint32_t> tierFrames;
+    for (uint32_t tier = 0; tier < pfManager.getTierCount(); tier++) {
+        tierFrames.push_back(pfManager.getTierFrames(tier));
+    }
+    tierManager->displayStatistics(tierFrames, pageSize);
+}
+
+// Store an evicted page in the compressed pool, writing back the oldest pool pages when it is full
+void Simulator::swapOutPage(uint32_t pid, uint32_t vpn) {
+    uint64_t key = makeSwapKey(pid, vpn);
+    if (compressedPool) {
+        uint32_t compressedSize = pageCompressor->compressedSize(key);
+        if (compressedPool->acceptsSize(compressedSize)) {
+            uint64_t writeBackKey;
+            while (!compressedPool->hasRoomFor(compressedSize) && compressedPool->writeBackLRU(writeBackKey)) {
+                swapSpace.writePage(writeBackKey);
+                costModel.charge(CostEvent::WriteBack);
+            }
+            if (compressedPool->storePage(key, compressedSize)) {
+                costModel.charge(CostEvent::CompressedPool);
+                *logStream << "Compressed VPN " << vpn << " of process " << pid << " to " << compressedSize << " bytes" << endl;
+                return;
+            }
+        }
+    }
+    swapSpace.writePage(key);
+    costModel.charge(CostEvent::WriteBack);
+    *logStream << "Swapped out VPN " << vpn << " of process " << pid << endl;
+}
+
+// Bring a faulting page back from wherever it was evicted to, and classify the fault
+void Simulator::swapInPage(uint32_t pid, uint32_t vpn) {
+    uint64_t key = makeSwapKey(pid, vpn);
+    if (compressedPool && compressedPool->loadPage(key)) {
+        poolFaults++;
+        faultCpuTime += poolLoadLatency;
+        costModel.charge(CostEvent::CompressedPool);
+        *logStream << "Decompressed VPN " << vpn << " from the compressed pool" << endl;
+    } else if (swapSpace.readPage(key)) {
+        majorFaults++;
+        faultIoTime += swapReadLatency;
+        costModel.charge(CostEvent::MajorFault);
+        *logStream << "Read VPN " << vpn << " back from the swap file" << endl;
+    } else {
+        minorFaults++;
+        faultCpuTime += zeroFillLatency;
+        costModel.charge(CostEvent::MinorFault);
+    }
+}
+
+void Simulator::setFaultLatency(uint64_t swapRead, uint64_t poolLoad, uint64_t zeroFill) {
+    swapReadLatency = swapRead;
+    poolLoadLatency = poolLoad;
+    zeroFillLatency = zeroFill;
+}
+
+// Costs are set before the trace is replayed, replacing the model clears what it recorded
+void Simulator::setCycleCosts(const vector<uint32_t>& costs) {
+    costModel = CostModel(costs);
+}
+
+void Simulator::displayCostStatistics() const {
+    costModel.displayStatistics({"Code", "Stack", "Heap"});
+}
+
+// Caches take every translated access, the page colors come from the last-level cache
+void Simulator::enableCaches(const vector<pair<uint64_t, uint32_t>>& levels, uint32_t lineSize, CacheInclusion inclusion, bool coloring) {
+    cacheHierarchy.reset(new CacheHierarchy(levels, lineSize, inclusion));
+    pageTableBase = static_cast<uint64_t>(physicalFrames) * pageSize;
+    pageColors = cacheHierarchy->getPageColors(pageSize);
+    if (coloring && pageColors < 2) {
+        throw runtime_error("Page coloring needs a last-level cache with more than one page per way");
+    }
+    pageColoring = coloring;
+}
+
+// Feed the PTE fetches of a page walk to the caches: one entry in the process's first-level table,
+// one in the second-level table it points to. Each table is laid out like a page holding 8-byte entries
+void Simulator::fetchPageTableEntries(uint32_t pid, uint32_t vpn) {
+    if (!cacheHierarchy) {
+        return;
+    }
+    if (invertedPageTable) {
+        // One cache line per bucket the walk just probed, the table sits at the start of the region
+        uint64_t bucket = invertedPageTable->getLastHomeBucket();
+        for (uint32_t i = 0; i < invertedPageTable->getLastProbes(); i++) {
+            cacheHierarchy->access(pageTableBase + bucket * InvertedPageTable::BUCKET_BYTES, CacheAccessKind::PageTable);
+            bucket = (bucket + 1) % invertedPageTable->getBucketCount();
+        }
+        return;
+    }
+    const uint32_t entrySize = 8;
+    uint32_t vpnBits = addressBits - offsetBits;
+    uint32_t l2Bits = vpnBits - vpnBits / 2;
+    uint64_t tableBytes = (1ULL << l2Bits) * entrySize; // The second level is never smaller than the first
+    uint64_t processBase = pageTableBase + static_cast<uint64_t>(pid) * ((1ULL << (vpnBits / 2)) + 1) * tableBytes;
+    uint64_t l1Index = vpn >> l2Bits;
+    uint64_t l2Index = vpn & ((1U << l2Bits) - 1);
+    cacheHierarchy->access(processBase + l1Index * entrySize, CacheAccessKind::PageTable);
+    cacheHierarchy->access(processBase + (1 + l1Index) * tableBytes + l2Index * entrySize, CacheAccessKind::PageTable);
+}
+
+void Simulator::displayCacheStatistics() const {
+    if (cacheHierarchy) {
+        cacheHierarchy->displayStatistics(pageTableBase, pageColors, pageColoring);
+    }
+}
+
+void Simulator::enableHeatProfile(uint32_t sketchWidth, uint32_t sketchDepth, uint32_t topK, uint32_t decayInterval, uint32_t regionPages) {
+    heatProfiler.reset(new HeatProfiler(sketchWidth, sketchDepth, topK, decayInterval, regionPages, addressBits, pageSize));
+}
+
+// Cold pages are picked among the pages each process has resident at the end
+void Simulator::displayHeatStatistics() const {
+    if (!heatProfiler) {
+        return;
+    }
+    map<uint32_t, vector<uint32_t>> residentPages;
+    for (const auto& [pid, process] : processTable) {
+        if (process.findPageTable()) {
+            const PoolList<uint32_t>& vpns = process.findPageTable()->getResidentVPNs();
+            residentPages[pid].assign(vpns.begin(), vpns.end());
+        }
+    }
+    heatProfiler->displayStatistics(residentPages);
+}
+
+void Simulator::enableIntervalStats(const string& path, uint64_t instructions, uint64_t cycles, uint32_t bufferSamples) {
+    if ((instructions == 0) == (cycles == 0)) {
+        throw runtime_error("Interval statistics need a window of either instructions or cycles");
+    }
+    intervalStats.reset(new IntervalStats(path, bufferSamples));
+    intervalStatsPath = path;
+    intervalInstructions = instructions;
+    intervalCycles = cycles;
+    nextIntervalCycles = cycles;
+}
+
+void Simulator::completeInstruction() {
+    instructionsReplayed++;
+    if (!intervalStats) {
+        return;
+    }
+    instructionsInWindow++;
+    if (intervalCycles > 0) {
+        uint64_t cycles = costModel.getTotalCycles();
+        if (cycles >= nextIntervalCycles) {
+            recordInterval();
+            nextIntervalCycles = (cycles / intervalCycles + 1) * intervalCycles;
+        }
+    } else if (instructionsInWindow == intervalInstructions) {
+        recordInterval();
+    }
+}
+
+// Snapshot every process's counters at the end of a window, a few reads per process
+void Simulator::recordInterval() {
+    intervalStats->beginWindow();
+    IntervalSample sample;
+    sample.instructions = instructionsReplayed;
+    sample.cycles = costModel.getTotalCycles();
+    sample.freeFrames = pfManager.getFreeFrames();
+    for (const auto& [pid, process] : processTable) {
+        sample.pid = pid;
+        sample.accesses = process.getMemoryAccesses();
+        sample.accessCycles = costModel.getProcessCycles(pid);
+        sample.tlbHits = process.getTLBHits();
+        sample.tlbMisses = process.getTLBMisses();
+        sample.faults = process.getPageFaults();
+        sample.evictions = process.getEvictions();
+        PageTable* pageTable = process.findPageTable();
+        sample.residentPages = pageTable ? pageTable->getResidentPages() : 0;
+        sample.pageTableBytes = pageTable ? pageTable->getTotalMemoryUsage() : 0;
+        intervalStats->record(sample);
+    }
+    instructionsInWindow = 0;
+}
+
+void Simulator::finishIntervalStats() {
+    if (!intervalStats) {
+        return;
+    }
+    if (instructionsInWindow > 0) {
+        recordInterval();
+    }
+    intervalStats->flush();
+    *logStream << "Wrote " << intervalStats->getSamples() << " interval samples over " << intervalStats->getWindows()
+               << " windows to " << intervalStatsPath << endl << endl;
+}
+
+// Hand the latency of the faults taken since the last call to the scheduler
+void Simulator::takeFaultLatency(uint64_t& cpuTime, uint64_t& ioTime) {
+    cpuTime = faultCpuTime;
+    ioTime = faultIoTime;
+    faultCpuTime = 0;
+    faultIoTime = 0;
+}
+
+// The pool's frames are carved out of physical memory, so compression has to win back more than it takes
+void Simulator::enableCompressedSwap(uint32_t poolFrameCount, uint32_t compressibility) {
+    if (poolFrameCount == 0 || poolFrameCount > pfManager.getFreeFrames()) {
+        throw runtime_error("Compressed pool needs between 1 and " + to_string(pfManager.getFreeFrames()) + " frames");
+    }
+    pageCompressor.reset(new PageCompressor(pageSize, compressibility));
+    compressedPool.reset(new CompressedPool(pageSize, poolFrameCount));
+    for (uint32_t i = 0; i < poolFrameCount; i++) {
+        poolFrames.push_back(pfManager.allocateFrame());
+    }
+}
+
+void Simulator::displaySwapStatistics() const {
+    *logStream << "--- Swap Statistics ---" << endl;
+    *logStream << "  Page Faults: " << minorFaults + poolFaults + majorFaults << " (minor: " << minorFaults
+         << ", compressed pool: " << poolFaults << ", major: " << majorFaults << ")" << endl;
+    *logStream << "  Swap File Writes: " << swapSpace.getPagesWritten() << ", reads: " << swapSpace.getPagesRead()
+         << ", pages stored: " << swapSpace.getStoredPages() << endl;
+    *logStream << endl;
+    if (compressedPool) {
+        compressedPool->displayStatistics(swapSpace.getPagesRead());
+        // Pages held in memory per physical frame, counting the frames given up to the pool
+        uint32_t totalFrames = pfManager.getTotalFrames();
+        uint32_t effectivePages = totalFrames - compressedPool->getCapacityFrames() + compressedPool->getStoredPages();
+        *logStream << "  Effective Memory Capacity: " << effectivePages << " pages in " << totalFrames << " frames ("
+             << static_cast<double>(effectivePages) / totalFrames * 100 << "%)" << endl;
+        *logStream << endl;
+    }
+}
+
+// Take a frame from the global pool for a faulting process, reclaiming synchronously below the min watermark
+int Simulator::allocateFrameForFault(Process& process, uint32_t vpn) {
+    if (!process.hasFrameQuota()) {
+        return -1;
+    }
+    // A process that used up its partition replaces its own pages instead
+    if (!partitionedFrames && (pfManager.getFreeFrames() == 0 || pfManager.isBelowMinWatermark())) {
+        // Direct reclaim: the faulting access stalls until free frames are back at the min watermark
+        directReclaimStalls++;
+        process.incrementDirectReclaimStall();
+        uint32_t target = max(pfManager.getMinWatermark(), 1u) - pfManager.getFreeFrames();
+        *logStream << "Direct reclaim of " << target << " pages for process " << process.getPid() << endl;
+        directReclaimedPages += reclaimPages(target);
+    }
+    // Coloring only picks among the frames the partition or placement policy would allow anyway
+    uint32_t frame = pageColoring && !partitionedFrames && !numaManager
+                   ? pfManager.allocateFrameWithColor(getPageColor(process.getPid(), vpn), pageColors)
+                   : allocateFrameFor(process.getPid());
+    if (frame == static_cast<uint32_t>(-1)) {
+        return -1;
+    }
+    process.chargeFrame();
+    return frame;
+}
+
+// Cache color a page should get. Processes share their address space layout, so each one starts at its
+// own color offset instead of all of them crowding the colors of their low pages
+uint32_t Simulator::getPageColor(uint32_t pid, uint32_t vpn) const {
+    return static_cast<uint32_t>((vpn + static_cast<uint64_t>(pid) * 2654435761u) % pageColors);
+}
+
+// Allocate a frame for a process, from its partition or following its NUMA placement policy when enabled
+uint32_t Simulator::allocateFrameFor(uint32_t pid) {
+    if (partitionedFrames) {
+        return pfManager.allocateFrameInPartition(pid);
+    }
+    if (!numaManager) {
+        return pfManager.allocateFrame();
+    }
+    for (uint32_t node : numaManager->getPlacementNodes(pid)) {
+        uint32_t frame = pfManager.allocateFrameOnNode(node);
+        if (frame != static_cast<uint32_t>(-1)) {
+            return frame;
+        }
+    }
+    return static_cast<uint32_t>(-1);
+}
+
+// Per-frame bookkeeping for every translated access: tier hotness and NUMA locality
+void Simulator::recordFrameAccess(uint32_t frame) {
+    if (tierManager) {
+        tierManager->recordAccess(frame, pfManager.getFrameTier(frame));
+    }
+    if (numaManager && numaManager->recordAccess(currentProcessId, frame, pfManager.getFrameNode(frame))) {
+        balanceNumaPage(frame);
+    }
+}
+
+// Automatic NUMA balancing: move a page that keeps being accessed remotely to the accessing node
+void Simulator::balanceNumaPage(uint32_t frame) {
+    if (pfManager.getFrameRefCount(frame) > 1) {
+        // A shared page has no single accessor to move it towards
+        numaManager->resetFrame(frame);
+        return;
+    }
+    uint32_t homeNode = numaManager->getHomeNode(currentProcessId);
+    uint32_t target = pfManager.allocateFrameOnNode(homeNode);
+    if (target == static_cast<uint32_t>(-1)) {
+        numaManager->recordMigrationFailure();
+        numaManager->resetFrame(frame);
+        return;
+    }
+    *logStream << "NUMA balancing: migrating frame " << frame << " to frame " << target << " on node " << homeNode << endl;
+    if (migratePage(frame, target)) {
+        numaManager->recordTLBInvalidation();
+    }
+    numaManager->recordMigration(currentProcessId);
+}
+
+void Simulator::enableNuma(const vector<uint32_t>& nodeFrames, uint32_t localLatency, uint32_t remoteLatency, uint32_t balanceThreshold) {
+    pfManager.setNodes(nodeFrames);
+    numaManager.reset(new NumaManager(nodeFrames.size(), physicalFrames, localLatency, remoteLatency, balanceThreshold));
+}
+
+NumaManager& Simulator::getNumaManager() {
+    if (!numaManager) {
+        throw runtime_error("NUMA is not enabled");
+    }
+    return *numaManager;
+}
+
+void Simulator::displayNumaStatistics() const {
+    if (!numaManager) {
+        return;
+    }
+    vector<uint32_t> nodeFrames;
+    vector<uint32_t> nodeFreeFrames;
+    for (uint32_t node = 0; node < pfManager.getNodeCount(); node++) {
+        nodeFrames.push_back(pfManager.getNodeFrames(node));
+        nodeFreeFrames.push_back(pfManager.getFreeFramesOnNode(node));
+    }
+    numaManager->displayStatistics(nodeFrames, nodeFreeFrames);
+}
+
+// Proactively evict pages until free frames reach the high watermark
+void Simulator::runBackgroundReclaim() {
+    uint32_t target = pfManager.getHighWatermark() - pfManager.getFreeFrames();
+    *logStream << "Background reclaim woken with " << pfManager.getFreeFrames() << " free frames, target " << target << " pages" << endl;
+    backgroundReclaimRuns++;
+    backgroundReclaimedPages += reclaimPages(target);
+}
+
+void Simulator::displayReclaimStatistics() const {
+    uint32_t totalReclaimed = directReclaimedPages + backgroundReclaimedPages;
+    *logStream << "--- Reclaim Statistics ---" << endl;
+    *logStream << "  Watermarks (min/low/high): " << pfManager.getMinWatermark() << "/" << pfManager.getLowWatermark()
+         << "/" << pfManager.getHighWatermark() << " frames" << endl;
+    *logStream << "  Free Frames: " << pfManager.getFreeFrames() << " of " << pfManager.getTotalFrames() << endl;
+    *logStream << "  Direct Reclaim Stalls: " << directReclaimStalls + localReplacements << " (global reclaim: "
+         << directReclaimStalls << ", local replacement: " << localReplacements << ")" << endl;
+    *logStream << "  Direct Reclaimed Pages: " << directReclaimedPages << endl;
+    *logStream << "  Background Reclaim Runs: " << backgroundReclaimRuns << endl;
+    *logStream << "  Background Reclaimed Pages: " << backgroundReclaimedPages << endl;
+    *logStream << "  Background Reclaim Share: "
+         << (totalReclaimed > 0 ? static_cast<double>(backgroundReclaimedPages) / totalReclaimed * 100 : 0.0) << "%" << endl;
+    *logStream << "  Range Frees: " << rangeFrees << " (" << unmappedPages << " pages unmapped, " << rangeFlushes
+         << " full TLB flushes)" << endl;
+    *logStream << endl;
+}
+
+// Take a frame for a faulting page: the process's own frames, then the global pool, then one of its own pages
+int Simulator::getFrameForFault(Process& process, uint32_t vpn, bool& replaced) {
+    replaced = false;
+    int frame = pageColoring ? process.getAFrameWithColor(getPageColor(process.getPid(), vpn), pageColors) : process.getAFrame();
+    if (frame == -1) {
+        frame = allocateFrameForFault(process, vpn);
+    }
+    if (frame == -1) {
+        // No free frames, attempt page replacement using the Clock Algorithm
+        localReplacements++;
+        process.incrementDirectReclaimStall();
+        frame = evictPage(currentProcessId, process);
+        replaced = true;
+    }
+    return frame;
+}
+
+bool Simulator::handlePageFault(uint32_t vpn, AccessType type) {
+    PROFILE_STAGE(PageFault);
+    // Get the current process's page table
+    Process& process = processTable.at(currentProcessId);
+    PageTable* pageTable = process.getPageTable();
+
+    // Use PageTable's isValidRange function to check if the VPN is valid
+    if (!pageTable->isValidRange(vpn)) {
+        *errorStream << "Invalid VPN: " << vpn << ". Out of range." << endl;
+        return false;
+    }
+
+    // A code page another process already brought in is mapped rather than read again
+    bool codePage = sharedCode && type == AccessType::Code;
+    if (codePage && mapSharedCodePage(currentProcessId, process, vpn)) {
+        costModel.charge(CostEvent::MinorFault);
+        *logStream << "Page fault handled. Mapped shared code frame " << codePageCache.at(vpn) << " to VPN " << vpn << endl;
+        return true;
+    }
+
+    bool replaced;
+    int newFrame = getFrameForFault(process, vpn, replaced);
+    if (newFrame == -1) {
+        *errorStream << "Error: Failed to handle page fault for VPN " << vpn << " - page replacement failed." << endl;
+        return false;
+    }
+    // Only with a frame to read into does the page leave swap, a failed fault keeps its contents there
+    swapInPage(currentProcessId, vpn);
+    mapPage(currentProcessId, vpn, newFrame, !codePage);
+    if (codePage) {
+        codePageCache[vpn] = newFrame;
+    }
+    if (replaced) {
+        *logStream << "Page fault handled by page replacement for VPN " << vpn << endl;
+    } else {
+        *logStream << "Page fault handled. Assigned new frame " << newFrame << " to VPN " << vpn << endl;
+    }
+    return true;
+}
+
+// Map a code page from the shared code cache, returns false if no process has it in memory
+bool Simulator::mapSharedCodePage(uint32_t pid, Process& process, uint32_t vpn) {
+    auto cached = codePageCache.find(vpn);
+    if (cached == codePageCache.end()) {
+        return false;
+    }
+    process.getPageTable()->updatePageTable(vpn, cached->second, true, false, true, false, true, 0);
+    pfManager.addFrameOwner(cached->second, makeSwapKey(pid, vpn));
+    process.chargeFrame();
+    sharedCodeFaults++;
+    return true;
+}
+
+bool Simulator::isCodeCacheFrame(uint32_t vpn, uint32_t frame) const {
+    auto cached = codePageCache.find(vpn);
+    return cached != codePageCache.end() && cached->second == frame;
+}
+
+// Write to a read-only page: a copy-on-write page gets a private copy of its frame,
+// or is simply made writable again when no other process maps the frame any more
+bool Simulator::handleWriteFault(Process& process, uint32_t vpn) {
+    PageTable* pageTable = process.getPageTable();
+    PageTableEntry* entry = pageTable->getPageTableEntry(vpn);
+    costModel.charge(CostEvent::MinorFault);
+    if (!entry->isCopyOnWrite()) {
+        protectionFaults++;
+        *errorStream << "Error: Protection fault, write to read-only VPN " << vpn << endl;
+        return false;
+    }
+    uint32_t sharedFrame = entry->getFrameNumber();
+    if (pfManager.getFrameRefCount(sharedFrame) == 1) {
+        // Other cores may keep the read-only translation, a write there just faults again
+        getCurrentCpu().getTLB().deleteTLB(vpn);
+        entry->setWritable(true);
+        entry->setCopyOnWrite(false);
+        cowReuses++;
+        *logStream << "Copy-on-write fault for VPN " << vpn << ", frame " << sharedFrame << " is no longer shared" << endl;
+        return true;
+    }
+
+    bool replaced;
+    int newFrame = getFrameForFault(process, vpn, replaced);
+    if (newFrame == -1) {
+        *errorStream << "Error: Failed to copy shared frame " << sharedFrame << " for VPN " << vpn << endl;
+        return false;
+    }
+    if (pageTable->getPageTableEntry(vpn) == nullptr) {
+        // Finding a frame evicted the faulting page itself, its private copy comes back from swap
+        swapInPage(currentProcessId, vpn);
+    } else {
+        // Threads of the process on other cores must stop using the shared frame
+        invalidateTranslation(currentProcessId, vpn);
+        if (pfManager.removeFrameOwner(sharedFrame, makeSwapKey(currentProcessId, vpn)) == 0) {
+            // Reclaim dropped the other mappings meanwhile
+            pfManager.freeAFrame(sharedFrame);
+        }
+        // The copy is charged to the process now, the shared mapping it replaces no longer is
+        process.freeMemory(sharedFrame);
+    }
+    mapPage(currentProcessId, vpn, newFrame);
+    cowCopies++;
+    *logStream << "Copy-on-write fault for VPN " << vpn << ", copied frame " << sharedFrame << " to frame " << newFrame << endl;
+    return true;
+}
+
+// Duplicate the parent's address space copy-on-write: both processes map the same frames
+// read-only until one of them writes. Pages the parent has swapped out are not inherited
+void Simulator::forkProcess(uint32_t parentPid, uint32_t childPid) {
+    Process* parentProcess = processTable.find(parentPid);
+    if (partitionedFrames) {
+        *errorStream << "Error: Cannot fork process " << childPid << ", fork needs a frame partition of its own" << endl;
+        return;
+    }
+    if (!parentProcess || processTable.contains(childPid)) {
+        *errorStream << "Error: Cannot fork process " << childPid << " from process " << parentPid << endl;
+        return;
+    }
+    Process& parent = *parentProcess;
+    Process& child = processTable.insert(childPid, make_unique<Process>(childPid, parent.getMaxFrames(), list<uint32_t>(), pageTableSettings));
+    child.growHeap(parent.getHeapSize());
+
+    // A parent that never touched memory has nothing to share, its child builds a page table once it runs
+    PageTable* parentTable = parent.findPageTable();
+    uint32_t sharedPages = 0;
+    if (parentTable) {
+        PageTable* childTable = child.getPageTable();
+        for (uint32_t vpn : parentTable->getResidentVPNs()) {
+            PageTableEntry* entry = parentTable->getPageTableEntry(vpn);
+            bool copyOnWrite = entry->isWritable() || entry->isCopyOnWrite();
+            entry->setWritable(false);
+            entry->setCopyOnWrite(copyOnWrite);
+            // Mapping the child's page may rehash a hashed page table, entry is not used after it
+            uint32_t frame = entry->getFrameNumber();
+            childTable->updatePageTable(vpn, frame, true, entry->isDirty(), entry->isReadable(), false, entry->isExecutable(), 0);
+            childTable->getPageTableEntry(vpn)->setCopyOnWrite(copyOnWrite);
+            pfManager.addFrameOwner(frame, makeSwapKey(childPid, vpn));
+            child.chargeFrame();
+            sharedPages++;
+        }
+    }
+    // The parent's cached translations are still writable
+    tlbShootdown.invalidateProcess(cpus, currentCpuId, parentPid);
+    tlbShootdown.flushBatches(cpus, currentCpuId);
+    forks++;
+    *logStream << "Forked process " << childPid << " from process " << parentPid << ", sharing " << sharedPages << " pages" << endl;
+}
+
+// Start a process with the parent's memory quota and an empty address space, like fork followed by exec.
+// Nothing is mapped or reserved, the process builds its page table on its first access
+void Simulator::spawnProcess(uint32_t parentPid, uint32_t childPid) {
+    Process* parent = processTable.find(parentPid);
+    if (partitionedFrames) {
+        *errorStream << "Error: Cannot spawn process " << childPid << ", spawn needs a frame partition of its own" << endl;
+        return;
+    }
+    if (!parent || processTable.contains(childPid)) {
+        *errorStream << "Error: Cannot spawn process " << childPid << " from process " << parentPid << endl;
+        return;
+    }
+    processTable.insert(childPid, make_unique<Process>(childPid, parent->getMaxFrames(), list<uint32_t>(), pageTableSettings));
+    *logStream << "Spawned process " << childPid << " from process " << parentPid << endl;
+}
+
+// Tear down a process: its pages are unmapped in one pass over the mapped pages only, frames nobody else
+// maps go back to the frame manager with the frames it held unmapped, and its swapped pages and cached
+// translations are dropped. The process leaves the table, its pid can be forked again
+void Simulator::exitProcess(uint32_t pid) {
+    unique_ptr<Process> process = processTable.remove(pid);
+    if (!process) {
+        *errorStream << "Error: Cannot exit process " << pid << ", there is no such process" << endl;
+        return;
+    }
+    unmappedEntries.clear();
+    releasedFrames.clear();
+    if (PageTable* pageTable = process->findPageTable()) {
+        pageTable->removeAll(unmappedEntries);
+    }
+    for (const auto& [vpn, frame] : unmappedEntries) {
+        if (pfManager.removeFrameOwner(frame, makeSwapKey(pid, vpn)) == 0) {
+            if (isCodeCacheFrame(vpn, frame)) {
+                codePageCache.erase(vpn);
+            }
+            releasedFrames.push_back(frame);
+        }
+        process->freeMemory(frame);
+    }
+    uint32_t heldFrames = process->getAvailableFrames().size();
+    process->releaseFrames(heldFrames, releasedFrames);
+    pfManager.freeFrames(releasedFrames);
+
+    uint32_t swappedPages = swapSpace.getStoredPages() > 0 ? swapSpace.discardProcess(pid) : 0;
+    if (compressedPool) {
+        swappedPages += compressedPool->invalidateProcess(pid);
+    }
+    tlbShootdown.invalidateProcess(cpus, currentCpuId, pid);
+    tlbShootdown.flushBatches(cpus, currentCpuId);
+    tlbShootdown.removeProcess(pid);
+    process->addCounters(exitedCounters);
+    // Components that keep per-process state fold it into their exited totals
+    costModel.removeProcess(pid);
+    if (heatProfiler) {
+        heatProfiler->removeProcess(pid);
+    }
+    if (intervalStats) {
+        intervalStats->removeProcess(pid);
+    }
+    if (numaManager) {
+        numaManager->removeProcess(pid);
+    }
+    exits++;
+    *logStream << "Process " << pid << " exited, unmapping " << unmappedEntries.size() << " pages, freeing " << releasedFrames.size()
+               << " frames and dropping " << swappedPages << " swapped pages" << endl;
+}
+
+void Simulator::enableSharedCode() {
+    sharedCode = true;
+}
+
+// The table is sized to physical memory, so it has to exist before any process does
+void Simulator::enableHashedPageTable() {
+    if (!processTable.empty()) {
+        throw runtime_error("The page table backend is chosen before processes are created");
+    }
+    invertedPageTable = make_shared<InvertedPageTable>(physicalFrames);
+    pageTableSettings = make_shared<PageTableSettings>(PageTableSettings{addressBits, pageSize, arena, invertedPageTable});
+}
+
+bool Simulator::hasHashedPageTable() const {
+    return invertedPageTable != nullptr;
+}
+
+// Buckets the last lookup probed, or the levels of the two-level table
+uint32_t Simulator::getWalkReferences() const {
+    return invertedPageTable ? invertedPageTable->getLastProbes() : pageTableLevels;
+}
+
+void Simulator::displayPageTableStatistics() const {
+    if (!invertedPageTable) {
+        return;
+    }
+    invertedPageTable->displayStatistics();
+    uint64_t twoLevelBytes = 0;
+    for (const auto& [pid, process] : processTable) {
+        twoLevelBytes += process.findPageTable() ? process.findPageTable()->getTwoLevelMemoryUsage() : 0;
+    }
+    *logStream << "  For comparison, two-level tables for the same pages require " << twoLevelBytes << " bytes and "
+         << pageTableLevels << " memory references per walk" << endl;
+    *logStream << endl;
+}
+
+void Simulator::displaySharingStatistics() const {
+    if (forks == 0 && exits == 0 && !sharedCode) {
+        return;
+    }
+    // Resident set sizes count shared frames once per process, mapped frames count them once
+    uint64_t residentPages = 0;
+    for (const auto& [pid, process] : processTable) {
+        residentPages += process.findPageTable() ? process.findPageTable()->getResidentPages() : 0;
+    }
+    uint64_t mappedFrames = 0;
+    uint64_t sharedFrames = 0;
+    for (uint32_t frame = 0; frame < pfManager.getTotalFrames(); frame++) {
+        uint32_t refCount = pfManager.getFrameRefCount(frame);
+        mappedFrames += refCount > 0 ? 1 : 0;
+        sharedFrames += refCount > 1 ? 1 : 0;
+    }
+    uint64_t savedPages = residentPages - mappedFrames;
+    *logStream << "--- Sharing Statistics ---" << endl;
+    *logStream << "  Forks: " << forks << endl;
+    if (exits > 0) {
+        *logStream << "  Exits: " << exits << endl;
+    }
+    *logStream << "  Copy-on-Write Faults: " << cowCopies + cowReuses << " (copied: " << cowCopies << ", reused: " << cowReuses << ")" << endl;
+    *logStream << "  Shared Code Faults: " << sharedCodeFaults << endl;
+    *logStream << "  Protection Faults: " << protectionFaults << endl;
+    *logStream << "  Resident Pages (sum over processes): " << residentPages << endl;
+    *logStream << "  Mapped Frames: " << mappedFrames << " (" << sharedFrames << " shared)" << endl;
+    *logStream << "  Resident Memory Savings: " << savedPages << " pages, " << savedPages * pageSize << " bytes ("
+         << (residentPages > 0 ? static_cast<double>(savedPages) / residentPages * 100 : 0.0) << "%)" << endl;
+    *logStream << endl;
+}
+
+
+uint32_t Simulator::translateVirtualAddress(uint32_t virtualAddress, AccessType type, bool isWrite) {
+    // Get the current process
+    Process& process = processTable.at(currentProcessId);
+    process.incrementMemoryAccess();
+
+    // Constants for address components based on page size
+    const int pageOffsetBits = offsetBits;
+    const uint32_t pageOffsetMask = pageSize - 1;
+
+    // Calculate VPN (Virtual Page Number) and offset within the page
+    uint32_t vpn = virtualAddress >> pageOffsetBits;
+    uint32_t offset = virtualAddress & pageOffsetMask;
+    if (heatProfiler) {
+        heatProfiler->recordAccess(currentProcessId, vpn);
+    }
+
+    // 1. Check the TLB first for the VPN
+    PageTable* pageTable = process.getPageTable();
+    TLB& tlb = getCurrentCpu().getTLB();
+    costModel.charge(CostEvent::TlbLookup);
+    int pfn = tlb.lookupTLB(vpn);
+    if (pfn != -1) {
+        // TLB hit - construct the physical address
+        process.incrementTLBHit();
+        if (!isWrite || tlb.isWritable(vpn)) {
+            *logStream << "TLB hit for VPN " << vpn << ", PFN: " << pfn << endl;
+            return (pfn << pageOffsetBits) | offset;
+        }
+        // Write through a read-only translation, resolve it in the page table
+        *logStream << "TLB hit for VPN " << vpn << " is read-only" << endl;
+        if (!handleWriteFault(process, vpn)) {
+            return UINT32_MAX;
+        }
+    } else {
+        // TLB miss - increment TLB miss counter for this process
+        process.incrementTLBMiss();
+    }
+
+    // 2. TLB miss - check the page table
+    PageTableEntry* entry = pageTable->lookupPageTableEntry(vpn);
+    costModel.charge(CostEvent::WalkReference, getWalkReferences());
+    fetchPageTableEntries(currentProcessId, vpn);
+    if (entry != nullptr) {
+        // Page table hit - update TLB and return physical address
+        if (pfn == -1) {
+            process.incrementPageTableHit();
+            *logStream << "Page table hit for VPN " << vpn << ", PFN: " << entry->getFrameNumber() << endl;
+        }
+        if (isWrite && !entry->isWritable()) {
+            if (!handleWriteFault(process, vpn)) {
+                return UINT32_MAX;
+            }
+            entry = pageTable->getPageTableEntry(vpn);
+        }
+        tlb.updateTLB(vpn, entry->getFrameNumber(), entry->isReadable(), entry->isWritable(), entry->isExecutable()); // Cache the page's permissions with the translation
+        return (entry->getFrameNumber() << pageOffsetBits) | offset;
+    } else {
+        // Page table miss - increment page table miss counter for this process
+        process.incrementPageTableMiss();
+    }
+
+
+    // 3. Page fault - Handle page fault
+    *logStream << "Page fault for VPN " << vpn << endl;
+    if (!handlePageFault(vpn, type)) {
+        *errorStream << "Error: Unable to handle page fault for VPN " << vpn << endl;
+        return UINT32_MAX; // Return an error if page fault handling fails
+    }
+
+    // Retry after handling page fault
+    entry = pageTable->lookupPageTableEntry(vpn);
+    costModel.charge(CostEvent::WalkReference, getWalkReferences());
+    fetchPageTableEntries(currentProcessId, vpn);
+    if (entry != nullptr) {
+        if (isWrite && !entry->isWritable() && !handleWriteFault(process, vpn)) {
+            return UINT32_MAX;
+        }
+        entry = pageTable->getPageTableEntry(vpn);
+        tlb.updateTLB(vpn, entry->getFrameNumber(), entry->isReadable(), entry->isWritable(), entry->isExecutable()); // Update TLB after page fault resolution
+        return (entry->getFrameNumber() << pageOffsetBits) | offset;
+    }
+
+    // If we still can't resolve the address, return an error
+    *errorStream << "Error: Failed to translate virtual address " << virtualAddress << endl;
+    return UINT32_MAX;
+}
+
+Simulator::Simulator(uint32_t addressBits, uint32_t pageSize, uint32_t numFrames,
+                     uint32_t tlbSize) : arena(make_shared<NodeArena>()), processTable(), pfManager(PhysicalFrameManager(numFrames)), cpus(1, Cpu(0, tlbSize, arena)), currentCpuId(0), currentProcessId(-1), tlbShootdown(0, false, 0, 0), addressBits(addressBits), physicalFrames(numFrames), pageSize(pageSize), tlbSize(tlbSize), offsetBits(getPageShift(pageSize)), swapSpace(arena), costModel(CostModel::getDefaultCosts()) {
+    pageTableSettings = make_shared<PageTableSettings>(PageTableSettings{addressBits, pageSize, arena, nullptr});
+    *logStream << "Virtual memory simulator created with page size " << pageSize << ", physical memory " << getPhysicalMemory() << endl;
+    *logStream << "==========" << endl;
+}
+
+// Processes are created once the optional features are configured, so their first pages follow the placement policy
+void Simulator::createProcess(uint32_t pid, uint32_t numPages) {
+    // NOTE: Here we only check if physical memory is enough for every single process
+    if (numPages > physicalFrames) {
+        throw runtime_error("Not enough physical memory for process " + to_string(pid));
+    }
+    list<uint32_t> frames;
+    for (uint32_t j = 0; j < preAllocatedFrames; j++) {
+        frames.push_back(allocateFrameFor(pid));
+    }
+    //manually pre-allocate some frames for process, the first pages are the start of the code segment
+    Process& inserted = processTable.insert(pid, make_unique<Process>(pid, numPages, frames, pageTableSettings));
+    uint32_t vpn = 0;
+    for (uint32_t k = 0; k < preAllocatedFrames; k++) {
+        if (sharedCode && mapSharedCodePage(pid, inserted, vpn)) {
+            // Another process already has this code page, give back the frame reserved for it
+            uint32_t unused = inserted.getAFrame();
+            pfManager.freeAFrame(unused);
+            inserted.freeMemory(unused);
+        } else {
+            int frame = inserted.getAFrame();
+            mapPage(pid, vpn, frame, !sharedCode);
+            if (sharedCode) {
+                codePageCache[vpn] = frame;
+            }
+        }
+        vpn++;
+    }
+}
+
+void Simulator::accessMemory(uint32_t virtualAddress, AccessType type, bool isWrite) {
+    PROFILE_STAGE(Access);
+    costModel.beginAccess();
+    uint32_t physicalAddress = translateVirtualAddress(virtualAddress, type, isWrite);
+    if (physicalAddress != UINT32_MAX) {
+        *logStream << "Translated Virtual Address " << std::hex << virtualAddress
+                << " to Physical Address " << physicalAddress << std::dec << endl;
+        costModel.charge(CostEvent::MemoryAccess);
+        if (cacheHierarchy) {
+            cacheHierarchy->access(physicalAddress, CacheAccessKind::Data);
+        }
+        costModel.endAccess(currentProcessId, static_cast<uint32_t>(type));
+        recordFrameAccess(physicalAddress >> offsetBits);
+    } else {
+        costModel.cancelAccess();
+        *errorStream << "Error: Translation failed for Virtual Address " << std::hex << virtualAddress << std::dec << endl;
+    }
+
+    tickBackgroundReclaim();
+
+    if (tierManager && tierManager->isScanDue()) {
+        balanceTiers();
+    }
+
+    // Batched shootdowns go out once the access, including any reclaim or migration it caused, is done
+    tlbShootdown.flushBatches(cpus, currentCpuId);
+}
+
+// Fast-forward phases of sampled simulation only keep page residency and the replacement state warm: the
+// page table is walked like on a TLB miss and faults are handled as usual, but the TLB, the cost model,
+// caches, tiering and NUMA access tracking and the per-access counters are left alone
+void Simulator::fastForwardAccess(uint32_t virtualAddress, AccessType type, bool isWrite) {
+    fastForwardAccesses++;
+    Process& process = processTable.at(currentProcessId);
+    PageTable* pageTable = process.getPageTable();
+    uint32_t vpn = virtualAddress >> offsetBits;
+    PageTableEntry* entry = pageTable->lookupPageTableEntry(vpn);
+    if (entry == nullptr) {
+        if (!handlePageFault(vpn, type)) {
+            *errorStream << "Error: Unable to handle page fault for VPN " << vpn << endl;
+            return;
+        }
+        entry = pageTable->lookupPageTableEntry(vpn);
+    }
+    if (entry != nullptr && isWrite && !entry->isWritable()) {
+        handleWriteFault(process, vpn);
+    }
+    tickBackgroundReclaim();
+    tlbShootdown.flushBatches(cpus, currentCpuId);
+}
+
+uint64_t Simulator::getFastForwardAccesses() const {
+    return fastForwardAccesses;
+}
+
+// Periodic background reclaim keeps free frames above the low watermark, off the fault path
+void Simulator::tickBackgroundReclaim() {
+    if (kswapdInterval > 0 && ++accessesSinceKswapd >= kswapdInterval) {
+        accessesSinceKswapd = 0;
+        if (pfManager.isBelowLowWatermark()) {
+            runBackgroundReclaim();
+        }
+    }
+}
+
+// Tiers, NUMA nodes and the compressed pool keep state of their own that snapshots do not cover
+void Simulator::checkCheckpointSupport() const {
+    if (cpus.size() > 1 || tierManager || numaManager || compressedPool) {
+        throw runtime_error("Checkpoints need a single CPU, without memory tiers, NUMA nodes or a compressed swap pool");
+    }
+}
+
+void Simulator::saveCheckpoint(const string& path, uint64_t instruction, uint64_t traceHash) {
+    checkCheckpointSupport();
+    CheckpointWriter writer;
+    SimulatorRecord state{};
+    state.currentProcessId = currentProcessId;
+    state.forks = forks;
+    state.exits = exits;
+    state.accessesSinceKswapd = accessesSinceKswapd;
+    state.reclaimCursor = reclaimCursor;
+    state.directReclaimStalls = directReclaimStalls;
+    state.directReclaimedPages = directReclaimedPages;
+    state.localReplacements = localReplacements;
+    state.backgroundReclaimRuns = backgroundReclaimRuns;
+    state.backgroundReclaimedPages = backgroundReclaimedPages;
+    state.minorFaults = minorFaults;
+    state.poolFaults = poolFaults;
+    state.majorFaults = majorFaults;
+    state.cowCopies = cowCopies;
+    state.cowReuses = cowReuses;
+    state.sharedCodeFaults = sharedCodeFaults;
+    state.protectionFaults = protectionFaults;
+    state.rangeFrees = rangeFrees;
+    state.unmappedPages = unmappedPages;
+    state.rangeFlushes = rangeFlushes;
+    state.swapPagesWritten = swapSpace.getPagesWritten();
+    state.swapPagesRead = swapSpace.getPagesRead();
+    state.exitedAccesses = exitedCounters.memoryAccesses;
+    state.exitedTlbHits = exitedCounters.tlbHits;
+    state.exitedTlbMisses = exitedCounters.tlbMisses;
+    state.exitedPageTableHits = exitedCounters.pageTableHits;
+    state.exitedPageFaults = exitedCounters.pageFaults;
+    state.exitedEvictions = exitedCounters.evictions;
+    writer.add(CheckpointSection::Simulator, vector<SimulatorRecord>{state});
+
+    vector<ProcessRecord> processes;
+    vector<PageTableEntryRecord> entries;
+    vector<uint32_t> clockPages;
+    vector<uint32_t> processFrames;
+    for (const auto& [pid, process] : processTable) {
+        ProcessRecord record{};
+        process.saveCounters(record);
+        // A process without a page table has no entries, clock pages or table counters to save
+        if (PageTable* pageTable = process.findPageTable()) {
+            record.level1Entries = pageTable->getLevel1Entries();
+            record.level2Entries = pageTable->getLevel2Entries();
+            record.clockHand = pageTable->getClockHandIndex();
+
+            size_t firstEntry = entries.size();
+            // Entries are visited in VPN order, so equal states write equal files
+            pageTable->forEachEntry([&entries](uint32_t vpn, const PageTableEntry& entry) {
+                entries.push_back({vpn, 0, entry.getBits()});
+            });
+            record.entryCount = entries.size() - firstEntry;
+
+            const PoolList<uint32_t>& resident = pageTable->getResidentVPNs();
+            clockPages.insert(clockPages.end(), resident.begin(), resident.end());
+            record.clockPageCount = resident.size();
+        }
+        processFrames.insert(processFrames.end(), process.getAvailableFrames().begin(), process.getAvailableFrames().end());
+        record.frameCount = process.getAvailableFrames().size();
+        processes.push_back(record);
+    }
+    writer.add(CheckpointSection::Processes, processes);
+    writer.add(CheckpointSection::PageTableEntries, entries);
+    writer.add(CheckpointSection::ClockPages, clockPages);
+    writer.add(CheckpointSection::ProcessFrames, processFrames);
+
+    vector<FreePoolRecord> pools;
+    vector<uint32_t> freeFrames;
+    vector<vector<uint32_t>> queues = pfManager.getFreeFrameQueues();
+    for (size_t i = 0; i < queues.size(); i++) {
+        pools.push_back({pfManager.getPoolFirstFrames()[i], static_cast<uint32_t>(queues[i].size())});
+        freeFrames.insert(freeFrames.end(), queues[i].begin(), queues[i].end());
+    }
+    writer.add(CheckpointSection::FreePools, pools);
+    writer.add(CheckpointSection::FreeFrames, freeFrames);
+
+    vector<FrameOwnerRecord> owners;
+    for (uint32_t frame = 0; frame < pfManager.getTotalFrames(); frame++) {
+        for (uint64_t owner : pfManager.getFrameOwners(frame)) {
+            owners.push_back({frame, 0, owner});
+        }
+    }
+    writer.add(CheckpointSection::FrameOwners, owners);
+
+    vector<TlbEntryRecord> tlbEntries;
+    for (const auto& [vpn, entry] : cpus[0].getTLB().entries) {
+        uint8_t flags = (entry.valid ? PTE_VALID : 0) | (entry.read ? PTE_READ : 0) | (entry.write ? PTE_WRITE : 0) | (entry.execute ? PTE_EXECUTE : 0);
+        tlbEntries.push_back({vpn, entry.pfn, flags, {}, entry.lastAccessTime});
+    }
+    sort(tlbEntries.begin(), tlbEntries.end(), [](const TlbEntryRecord& a, const TlbEntryRecord& b) { return a.vpn < b.vpn; });
+    writer.add(CheckpointSection::TlbEntries, tlbEntries);
+
+    vector<uint64_t> swapPages = swapSpace.getPages();
+    sort(swapPages.begin(), swapPages.end());
+    writer.add(CheckpointSection::SwapPages, swapPages);
+
+    vector<CodePageRecord> codePages;
+    for (const auto& [vpn, frame] : codePageCache) {
+        codePages.push_back({vpn, frame});
+    }
+    sort(codePages.begin(), codePages.end(), [](const CodePageRecord& a, const CodePageRecord& b) { return a.vpn < b.vpn; });
+    writer.add(CheckpointSection::CodePages, codePages);
+
+    CheckpointHeader header{};
+    header.instruction = instruction;
+    header.traceHash = traceHash;
+    header.pageSize = pageSize;
+    header.addressBits = addressBits;
+    header.physicalFrames = physicalFrames;
+    header.tlbSize = tlbSize;
+    writer.write(path, header);
+}
+
+// The options given with the restore (TLB size, watermarks, costs, caches, ...) apply from here on. Caches,
+// the cost model and the profilers start cold, everything the snapshot holds continues where it stopped
+uint64_t Simulator::restoreCheckpoint(const string& path, uint64_t& traceHash) {
+    checkCheckpointSupport();
+    if (!processTable.empty()) {
+        throw runtime_error("Checkpoints are restored into a simulator without processes");
+    }
+    CheckpointReader reader(path);
+    const CheckpointHeader& header = reader.getHeader();
+    if (header.pageSize != pageSize || header.addressBits != addressBits || header.physicalFrames != physicalFrames) {
+        throw runtime_error("Checkpoint " + path + " was taken with page size " + to_string(header.pageSize) + ", "
+                            + to_string(header.addressBits) + " address bits and " + to_string(header.physicalFrames) + " frames");
+    }
+    size_t count;
+    const SimulatorRecord* state = reader.get<SimulatorRecord>(CheckpointSection::Simulator, count);
+    if (count != 1) {
+        throw runtime_error("Checkpoint " + path + " has no simulator state");
+    }
+
+    // Free frames first, restoring them drops every frame owner
+    const FreePoolRecord* pools = reader.get<FreePoolRecord>(CheckpointSection::FreePools, count);
+    const vector<uint32_t>& poolFirstFrames = pfManager.getPoolFirstFrames();
+    if (count != poolFirstFrames.size()) {
+        throw runtime_error("Checkpoint " + path + " was taken with another frame partitioning");
+    }
+    size_t freeFrameCount;
+    const uint32_t* freeFrames = reader.get<uint32_t>(CheckpointSection::FreeFrames, freeFrameCount);
+    vector<vector<uint32_t>> queues;
+    size_t nextFrame = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (pools[i].firstFrame != poolFirstFrames[i] || nextFrame + pools[i].freeCount > freeFrameCount) {
+            throw runtime_error("Checkpoint " + path + " was taken with another frame partitioning");
+        }
+        queues.emplace_back(freeFrames + nextFrame, freeFrames + nextFrame + pools[i].freeCount);
+        nextFrame += pools[i].freeCount;
+    }
+    pfManager.restoreFreeFrames(queues);
+    const FrameOwnerRecord* owners = reader.get<FrameOwnerRecord>(CheckpointSection::FrameOwners, count);
+    for (size_t i = 0; i < count; i++) {
+        if (owners[i].frame >= physicalFrames) {
+            throw runtime_error("Checkpoint " + path + " maps frame " + to_string(owners[i].frame) + " which does not exist");
+        }
+        pfManager.addFrameOwner(owners[i].frame, owners[i].owner);
+    }
+
+    size_t entryCount;
+    size_t clockPageCount;
+    size_t frameCount;
+    const ProcessRecord* processes = reader.get<ProcessRecord>(CheckpointSection::Processes, count);
+    const PageTableEntryRecord* entries = reader.get<PageTableEntryRecord>(CheckpointSection::PageTableEntries, entryCount);
+    const uint32_t* clockPages = reader.get<uint32_t>(CheckpointSection::ClockPages, clockPageCount);
+    const uint32_t* frames = reader.get<uint32_t>(CheckpointSection::ProcessFrames, frameCount);
+    for (size_t i = 0; i < count; i++) {
+        const ProcessRecord& record = processes[i];
+        if (record.entryCount > entryCount || record.clockPageCount > clockPageCount || record.frameCount > frameCount) {
+            throw runtime_error("Checkpoint " + path + " is inconsistent, process " + to_string(record.pid) + " has more data than stored");
+        }
+        Process& process = processTable.insert(record.pid, make_unique<Process>(record.pid, record.maxFrames,
+                                                                                list<uint32_t>(frames, frames + record.frameCount), pageTableSettings));
+        process.restoreCounters(record);
+        if (record.entryCount > 0 || record.clockPageCount > 0 || record.level1Entries > 0) {
+            PageTable* pageTable = process.getPageTable();
+            for (uint32_t e = 0; e < record.entryCount; e++) {
+                const PageTableEntryRecord& saved = entries[e];
+                pageTable->restoreEntry(saved.vpn, PageTableEntry::fromBits(saved.bits));
+            }
+            pageTable->restoreState(record.level1Entries, record.level2Entries, vector<uint32_t>(clockPages, clockPages + record.clockPageCount), record.clockHand);
+        }
+        entries += record.entryCount;
+        entryCount -= record.entryCount;
+        clockPages += record.clockPageCount;
+        clockPageCount -= record.clockPageCount;
+        frames += record.frameCount;
+        frameCount -= record.frameCount;
+    }
+
+    currentProcessId = state->currentProcessId;
+    if (processTable.contains(currentProcessId)) {
+        getCurrentCpu().switchProcess(currentProcessId);
+        tlbShootdown.recordSwitch(currentCpuId, currentProcessId);
+    }
+    // A TLB of another size keeps the most recently used translations that fit
+    const TlbEntryRecord* tlbEntries = reader.get<TlbEntryRecord>(CheckpointSection::TlbEntries, count);
+    vector<TlbEntryRecord> translations(tlbEntries, tlbEntries + count);
+    stable_sort(translations.begin(), translations.end(), [](const TlbEntryRecord& a, const TlbEntryRecord& b) { return a.lastAccessTime > b.lastAccessTime; });
+    TLB& tlb = getCurrentCpu().getTLB();
+    size_t kept = header.tlbSize == tlbSize ? translations.size() : min<size_t>(translations.size(), tlbSize);
+    for (size_t i = 0; i < kept; i++) {
+        const TlbEntryRecord& saved = translations[i];
+        tlb.entries[saved.vpn] = TLBEntry(saved.vpn, saved.pfn, saved.flags & PTE_VALID, saved.flags & PTE_READ,
+                                          saved.flags & PTE_WRITE, saved.flags & PTE_EXECUTE, saved.lastAccessTime);
+    }
+
+    const uint64_t* swapPages = reader.get<uint64_t>(CheckpointSection::SwapPages, count);
+    swapSpace.restore(vector<uint64_t>(swapPages, swapPages + count), state->swapPagesWritten, state->swapPagesRead);
+    const CodePageRecord* codePages = reader.get<CodePageRecord>(CheckpointSection::CodePages, count);
+    for (size_t i = 0; i < count; i++) {
+        codePageCache[codePages[i].vpn] = codePages[i].frame;
+    }
+
+    forks = state->forks;
+    exits = state->exits;
+    accessesSinceKswapd = state->accessesSinceKswapd;
+    reclaimCursor = state->reclaimCursor;
+    directReclaimStalls = state->directReclaimStalls;
+    directReclaimedPages = state->directReclaimedPages;
+    localReplacements = state->localReplacements;
+    backgroundReclaimRuns = state->backgroundReclaimRuns;
+    backgroundReclaimedPages = state->backgroundReclaimedPages;
+    minorFaults = state->minorFaults;
+    poolFaults = state->poolFaults;
+    majorFaults = state->majorFaults;
+    cowCopies = state->cowCopies;
+    cowReuses = state->cowReuses;
+    sharedCodeFaults = state->sharedCodeFaults;
+    protectionFaults = state->protectionFaults;
+    rangeFrees = state->rangeFrees;
+    unmappedPages = state->unmappedPages;
+    rangeFlushes = state->rangeFlushes;
+    exitedCounters.memoryAccesses = state->exitedAccesses;
+    exitedCounters.tlbHits = state->exitedTlbHits;
+    exitedCounters.tlbMisses = state->exitedTlbMisses;
+    exitedCounters.pageTableHits = state->exitedPageTableHits;
+    exitedCounters.pageFaults = state->exitedPageFaults;
+    exitedCounters.evictions = state->exitedEvictions;
+    traceHash = header.traceHash;
+    return header.instruction;
+}
+
+void Simulator::switchProcess(uint32_t pid){
+    *logStream << "Switched current process to " << pid << endl;
+    currentProcessId = pid;
+    getCurrentCpu().switchProcess(pid);
+    tlbShootdown.recordSwitch(currentCpuId, pid);
+    // TODO: better if we can check TLB status
+}
+
+void Simulator::allocateMemory(uint32_t sizeInBytes){
+    int requestedPages = getPagesFromBytes(sizeInBytes);
+    Process& process = getCurrentProcess();
+    // The trace places its heap accesses up to the new end whether or not frames are handed out
+    process.growHeap(sizeInBytes);
+    uint32_t quota = process.getAllocationQuota();
+    if (requestedPages > quota) {
+        *logStream << "Requested memory exceeds maximum memory for the process: " << process.getMaxFrames() << endl;
+        return;
+    }
+    uint32_t frames = partitionedFrames ? pfManager.getFreeFramesInPartition(currentProcessId) : pfManager.getFreeFrames();
+    if (requestedPages > frames) {
+        *logStream << "Requested memory exceeds available physical memory: " << frames << " frames" << endl;
+        return;
+    }
+    list<uint32_t> allocatedFrames;
+    for (uint32_t i = 0; i < requestedPages; i++) {
+        uint32_t frame = allocateFrameFor(currentProcessId);
+        if (frame == static_cast<uint32_t>(-1)) {
+            // The placement policy ran out of nodes to allocate from, e.g. a full bound node
+            for (uint32_t allocated : allocatedFrames) {
+                pfManager.freeAFrame(allocated);
+            }
+            *logStream << "Requested memory exceeds physical memory allowed by the placement policy" << endl;
+            return;
+        }
+        allocatedFrames.push_back(frame);
+    }
+    process.allocateMemory(allocatedFrames);
+    *logStream << "Allocated " << requestedPages << " pages for process " << process.getPid() << endl;
+}
+
+// Shrink the heap of the current process by sizeInBytes, like generator.py's free instruction does,
+// and unmap the pages that now lie entirely above the end of the heap
+void Simulator::freeMemory(uint32_t sizeInBytes){
+    Process& process = getCurrentProcess();
+    if (sizeInBytes > process.getHeapSize()) {
+        *logStream << "Memory to free exceeds the heap of process " << process.getPid() << ": " << process.getHeapSize() << " bytes" << endl;
+        sizeInBytes = process.getHeapSize();
+    }
+    uint64_t oldEnd = static_cast<uint64_t>(heapBase) + process.getHeapSize();
+    uint64_t newEnd = oldEnd - sizeInBytes;
+    process.shrinkHeap(sizeInBytes);
+    uint64_t firstVpn = (newEnd + pageSize - 1) >> offsetBits;
+    uint64_t endVpn = (oldEnd + pageSize - 1) >> offsetBits;
+    if (firstVpn < endVpn) {
+        unmapRange(currentProcessId, process, firstVpn, endVpn - firstVpn);
+    }
+    *logStream << "Freed " << endVpn - firstVpn << " pages for process " << process.getPid() << endl;
+}
+
+// Unmap count pages from firstVpn on as one operation: the page table is torn down a table at a time,
+// frames go back to the frame manager together and the TLBs get one batched invalidation. Pages of
+// the range that were never touched give back one of the frames the process holds unmapped
+void Simulator::unmapRange(uint32_t pid, Process& process, uint32_t firstVpn, uint32_t count) {
+    unmappedEntries.clear();
+    unmappedVpns.clear();
+    releasedFrames.clear();
+    if (PageTable* pageTable = process.findPageTable()) {
+        pageTable->removeRange(firstVpn, count, unmappedEntries);
+    }
+    for (const auto& [vpn, frame] : unmappedEntries) {
+        unmappedVpns.push_back(vpn);
+        // A frame still mapped by a forked process stays in use
+        if (pfManager.removeFrameOwner(frame, makeSwapKey(pid, vpn)) == 0) {
+            if (isCodeCacheFrame(vpn, frame)) {
+                codePageCache.erase(vpn);
+            }
+            releasedFrames.push_back(frame);
+        }
+        process.freeMemory(frame);
+    }
+
+    // Freed pages no longer need their swapped-out copies
+    uint32_t swappedPages = 0;
+    if (swapSpace.getStoredPages() > 0 || compressedPool) {
+        for (uint64_t vpn = firstVpn; vpn < static_cast<uint64_t>(firstVpn) + count; vpn++) {
+            uint64_t key = makeSwapKey(pid, vpn);
+            bool swapped = swapSpace.containsPage(key) || (compressedPool && compressedPool->containsPage(key));
+            swapSpace.discardPage(key);
+            if (compressedPool) {
+                compressedPool->invalidatePage(key);
+            }
+            swappedPages += swapped;
+        }
+    }
+    process.releaseFrames(count - unmappedEntries.size() - swappedPages, releasedFrames);
+    pfManager.freeFrames(releasedFrames);
+
+    if (unmappedVpns.size() > unmapFlushCeiling) {
+        rangeFlushes++;
+    }
+    tlbShootdown.invalidateRange(cpus, currentCpuId, pid, unmappedVpns, unmapFlushCeiling);
+    tlbShootdown.flushBatches(cpus, currentCpuId);
+    rangeFrees++;
+    unmappedPages += unmappedEntries.size();
+}
+
+uint64_t Simulator::getTotalCycles() const {
+    return costModel.getTotalCycles();
+}
+
+ProcessCounters Simulator::getProcessCounters() const {
+    ProcessCounters counters = exitedCounters;
+    for (const auto& [pid, process] : processTable) {
+        process.addCounters(counters);
+    }
+    return counters;
+}
+
+void Simulator::displayStatistics() const {
+    *logStream << "\n--- Process Statistics ---" << endl;
+    for (const auto& entry : processTable) {
+        entry.second.displayStatistics();
+        if (entry.second.findPageTable()) {
+            entry.second.findPageTable()->displayStatistics();
+        }
+    }
+    if (exits > 0) {
+        *logStream << "Exited Processes Statistics:" << endl;
+        *logStream << "  Processes: " << exits << endl;
+        *logStream << "  Memory Access Attempts: " << exitedCounters.memoryAccesses << endl;
+        *logStream << "  TLB Hit Rate: " << exitedCounters.getTLBHitRate() * 100 << "%" << endl;
+        *logStream << "  Page Table Hit Rate: " << exitedCounters.getPageTableHitRate() * 100 << "%" << endl;
+        *logStream << "  Page Faults: " << exitedCounters.pageFaults << ", evictions: " << exitedCounters.evictions << endl;
+        *logStream << endl;
+    }
+    displayReclaimStatistics();
+    displaySwapStatistics();
+    displayTierStatistics();
+    displayNumaStatistics();
+    displayPageTableStatistics();
+    displaySharingStatistics();
+    displayCostStatistics();
+    displayCacheStatistics();
+    displayHeatStatistics();
+    displayCpuStatistics();
+}
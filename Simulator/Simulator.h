@@ -0,0 +1,243 @@
+#ifndef SIMULATOR_H
+#define SIMULATOR_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Process.h"
+#include "ProcessTable.h"
+#include "../PageTable/PageTable.h"
+#include "../PageTable/PhysicalFrameManager.h"
+#include "../Swap/SwapSpace.h"
+#include "../Swap/CompressedPool.h"
+#include "../Swap/helperFiles/PageCompressor.h"
+#include "../Tiering/TierManager.h"
+#include "../Numa/NumaManager.h"
+#include "../Cpu/Cpu.h"
+#include "../Cpu/TlbShootdown.h"
+#include "../CostModel/CostModel.h"
+#include "../Cache/CacheHierarchy.h"
+#include "../IntervalStats/IntervalStats.h"
+#include "../HeatProfiler/HeatProfiler.h"
+#include "../Allocator/NodeArena.h"
+
+using namespace std;
+
+// Kind of memory access, from the access_code, access_stak and access_heap trace commands
+enum class AccessType { Code, Stack, Heap };
+
+class Simulator {
+private:
+    // Pool for the nodes of every process's page table, clock and frame list, of the TLBs and of swap, so
+    // steady-state replay reuses freed nodes instead of going to the heap
+    shared_ptr<NodeArena> arena;
+    shared_ptr<const PageTableSettings> pageTableSettings; // What every process builds its page table from
+    ProcessTable processTable;
+    PhysicalFrameManager pfManager;
+    vector<Cpu> cpus;          // One TLB and running process per simulated core
+    uint32_t currentCpuId;     // Core executing the current trace instruction
+    uint32_t currentProcessId; // Process running on that core
+    TlbShootdown tlbShootdown;
+    uint32_t addressBits;
+    uint32_t physicalFrames;
+    uint32_t pageSize;
+    uint32_t tlbSize;
+    uint32_t offsetBits;
+
+    // Background reclaim (kswapd-style), woken every kswapdInterval accesses while below the low watermark
+    uint32_t kswapdInterval = 0; // 0 disables background reclaim
+    uint32_t accessesSinceKswapd = 0;
+    uint32_t reclaimCursor = 0; // Process to start the next reclaim round from
+    void tickBackgroundReclaim();
+
+    // Reclaim counters
+    uint32_t directReclaimStalls = 0;      // Faults that reclaimed from the global frame pool synchronously
+    uint32_t directReclaimedPages = 0;
+    uint32_t localReplacements = 0;        // Faults that replaced one of the process's own pages
+    uint32_t backgroundReclaimRuns = 0;
+    uint32_t backgroundReclaimedPages = 0;
+
+    // Range frees: a freed heap region is torn down in one pass, above unmapFlushCeiling pages the TLBs are flushed
+    static const uint32_t heapBase = 0x400000; // generator.py places the heap after its 4 MB code segment
+    uint32_t unmapFlushCeiling = 33;
+    uint64_t rangeFrees = 0;
+    uint64_t unmappedPages = 0;
+    uint64_t rangeFlushes = 0;
+    vector<pair<uint32_t, uint32_t>> unmappedEntries; // Scratch lists reused by every range free
+    vector<uint32_t> unmappedVpns;
+    vector<uint32_t> releasedFrames;
+    void unmapRange(uint32_t pid, Process& process, uint32_t firstVpn, uint32_t count);
+
+    // Swap: evicted pages go to the compressed pool when enabled, otherwise straight to the swap file
+    SwapSpace swapSpace;
+    unique_ptr<PageCompressor> pageCompressor;
+    unique_ptr<CompressedPool> compressedPool;
+    vector<uint32_t> poolFrames; // Physical frames reserved for the compressed pool
+
+    // Fault counters by where the faulting page was found
+    uint64_t minorFaults = 0; // First touch, the page is zero-filled
+    uint64_t poolFaults = 0;  // Refault served from the compressed pool
+    uint64_t majorFaults = 0; // Refault read back from the swap file
+
+    // Event-driven replay: modelled fault latencies, and the latency the faults of the current access add up to
+    uint64_t swapReadLatency = 0;
+    uint64_t poolLoadLatency = 0;
+    uint64_t zeroFillLatency = 0;
+    uint64_t faultCpuTime = 0; // Fault work done on the CPU, decompression and zero-fill
+    uint64_t faultIoTime = 0;  // Swap reads the process has to wait for
+
+    // Cycles spent on every access path, reported as average memory access time per process and access type
+    CostModel costModel;
+    static const uint32_t pageTableLevels = 2; // Memory references per page walk
+
+    // Optional hashed inverted page table shared by all processes, a walk then probes one or more buckets
+    shared_ptr<InvertedPageTable> invertedPageTable;
+    uint32_t getWalkReferences() const;
+
+    // Physically indexed caches fed with data accesses and the PTE fetches of page walks. Page tables are
+    // placed in a physical region above simulated memory, each process's tables in a region of its own
+    unique_ptr<CacheHierarchy> cacheHierarchy;
+    uint64_t pageTableBase = 0;
+    bool pageColoring = false; // Fault frames are chosen so their cache color matches the VPN's, offset per process
+    uint32_t pageColors = 1;
+
+    // Streaming per-page heat of every translated access, in fixed memory per process
+    unique_ptr<HeatProfiler> heatProfiler;
+
+    // Time series of per-process counters, a window ends every intervalInstructions instructions or,
+    // when intervalCycles is set, once the simulated cycles cross the next multiple of it
+    unique_ptr<IntervalStats> intervalStats;
+    string intervalStatsPath;
+    uint64_t intervalInstructions = 0;
+    uint64_t intervalCycles = 0;
+    uint64_t nextIntervalCycles = 0;
+    uint64_t instructionsReplayed = 0;
+    uint64_t instructionsInWindow = 0;
+    void recordInterval();
+
+    // Accesses replayed functionally by sampled simulation, outside the per-process counters
+    uint64_t fastForwardAccesses = 0;
+
+    // Tiered memory: hot pages are promoted to faster tiers and cold pages demoted, at most a few per scan
+    unique_ptr<TierManager> tierManager;
+
+    // NUMA: frames are split into per-node pools and processes allocate according to their placement policy
+    unique_ptr<NumaManager> numaManager;
+
+    // Sharing: fork maps the parent's frames copy-on-write, and with sharedCode every process maps one copy of each code page
+    bool sharedCode = false;
+    unordered_map<uint32_t, uint32_t> codePageCache; // Code VPN -> frame holding it, code pages are dropped instead of swapped
+    uint32_t forks = 0;
+    uint32_t exits = 0;
+    ProcessCounters exitedCounters; // Kept when a process exits, so totals over the run do not drop
+    uint64_t cowCopies = 0;        // Writes to shared pages that copied the frame
+    uint64_t cowReuses = 0;        // Writes to copy-on-write pages nobody else maps any more, made writable in place
+    uint64_t sharedCodeFaults = 0; // Code faults served by a frame another process already had
+    uint64_t protectionFaults = 0; // Writes to read-only pages that are not copy-on-write
+
+    // Static frame partitions: every process allocates from its own range of frames only, so
+    // processes never compete for memory and can be replayed independently
+    bool partitionedFrames = false;
+    static const uint32_t preAllocatedFrames = 8; // TODO: Make it configurable
+
+    uint32_t getPhysicalMemory();
+    Process& getCurrentProcess();
+    Cpu& getCurrentCpu();
+    bool invalidateTranslation(uint32_t pid, uint32_t vpn);
+    uint32_t translateVirtualAddress(uint32_t virtualAddress, AccessType type, bool isWrite);
+    uint32_t getPagesFromBytes(uint32_t size) const;
+    int allocateFrameForFault(Process& process, uint32_t vpn);
+    int getFrameForFault(Process& process, uint32_t vpn, bool& replaced);
+    void fetchPageTableEntries(uint32_t pid, uint32_t vpn);
+    uint32_t reclaimPages(uint32_t targetPages);
+    void runBackgroundReclaim();
+    int evictPage(uint32_t pid, Process& process);
+    void swapOutPage(uint32_t pid, uint32_t vpn);
+    void swapInPage(uint32_t pid, uint32_t vpn);
+    void mapPage(uint32_t pid, uint32_t vpn, uint32_t frame, bool writable = true);
+    bool mapSharedCodePage(uint32_t pid, Process& process, uint32_t vpn);
+    bool isCodeCacheFrame(uint32_t vpn, uint32_t frame) const;
+    bool handleWriteFault(Process& process, uint32_t vpn);
+    bool remapPage(uint64_t owner, uint32_t newFrame);
+    bool migratePage(uint32_t frame, uint32_t newFrame);
+    void exchangePages(uint32_t firstFrame, uint32_t secondFrame);
+    vector<uint32_t> collectTierPages(uint32_t tier, uint32_t minHeat) const;
+    void balanceTiers();
+    uint32_t allocateFrameFor(uint32_t pid);
+    uint32_t getPageColor(uint32_t pid, uint32_t vpn) const;
+    void recordFrameAccess(uint32_t frame);
+    void balanceNumaPage(uint32_t frame);
+    void checkCheckpointSupport() const;
+
+public:
+    Simulator(uint32_t addressBits, uint32_t pageSize, uint32_t numFrames, uint32_t tlbSize);
+    void createProcess(uint32_t pid, uint32_t numPages);
+    void accessMemory(uint32_t virtualAddress, AccessType type = AccessType::Heap, bool isWrite = false);
+    // Functional access for sampled simulation, see its definition
+    void fastForwardAccess(uint32_t virtualAddress, AccessType type = AccessType::Heap, bool isWrite = false);
+    uint64_t getFastForwardAccesses() const;
+    void switchProcess(uint32_t pid);
+    void setCpuCount(uint32_t count, uint32_t batchCeiling, bool lazy, uint32_t initiatorCost, uint32_t handlerCost);
+    void setCurrentCpu(uint32_t cpu);
+    void displayCpuStatistics() const;
+    void setFramePartitions(const vector<uint32_t>& processPages);
+    void mergeFrom(Simulator& worker, const vector<uint32_t>& pids);
+    void allocateMemory(uint32_t sizeInBytes);
+    void freeMemory(uint32_t virtualAddress);
+    bool handlePageFault(uint32_t vpn, AccessType type = AccessType::Heap);
+    void forkProcess(uint32_t parentPid, uint32_t childPid);
+    void spawnProcess(uint32_t parentPid, uint32_t childPid);
+    void exitProcess(uint32_t pid);
+    void enableSharedCode();
+    void enableHashedPageTable();
+    bool hasHashedPageTable() const;
+    void displayPageTableStatistics() const;
+    void displaySharingStatistics() const;
+    const ProcessTable& getProcessTable();
+    void setWatermarks(uint32_t minFrames, uint32_t lowFrames, uint32_t highFrames);
+    void setBackgroundReclaimInterval(uint32_t accesses);
+    void setUnmapFlushCeiling(uint32_t pages);
+    void displayReclaimStatistics() const;
+    void enableCompressedSwap(uint32_t poolFrameCount, uint32_t compressibility);
+    void displaySwapStatistics() const;
+    void setFaultLatency(uint64_t swapRead, uint64_t poolLoad, uint64_t zeroFill);
+    void takeFaultLatency(uint64_t& cpuTime, uint64_t& ioTime);
+    void setCycleCosts(const vector<uint32_t>& costs);
+    void displayCostStatistics() const;
+    void enableCaches(const vector<pair<uint64_t, uint32_t>>& levels, uint32_t lineSize, CacheInclusion inclusion, bool coloring);
+    void displayCacheStatistics() const;
+    void enableHeatProfile(uint32_t sketchWidth, uint32_t sketchDepth, uint32_t topK, uint32_t decayInterval, uint32_t regionPages);
+    void displayHeatStatistics() const;
+    void enableIntervalStats(const string& path, uint64_t instructions, uint64_t cycles, uint32_t bufferSamples);
+    // Count a replayed trace instruction, ending the current window when it is due
+    void completeInstruction();
+    // Record the last, partial window and write out every buffered sample
+    void finishIntervalStats();
+    void enableTiering(const vector<uint32_t>& tierFrames, const vector<uint32_t>& tierLatencies,
+                       uint32_t scanInterval, uint32_t migrationLimit, uint32_t promoteThreshold);
+    void displayTierStatistics() const;
+    void enableNuma(const vector<uint32_t>& nodeFrames, uint32_t localLatency, uint32_t remoteLatency, uint32_t balanceThreshold);
+    NumaManager& getNumaManager();
+    void displayNumaStatistics() const;
+    // Snapshot the processes, page tables, clocks, TLB, free frames, swap and counters after an instruction
+    void saveCheckpoint(const string& path, uint64_t instruction, uint64_t traceHash);
+    // Load a snapshot into a simulator without processes, returns the instruction to resume after
+    uint64_t restoreCheckpoint(const string& path, uint64_t& traceHash);
+
+    // Totals for embedders: trace instructions, faults by where the page was found and simulated cycles
+    uint64_t getInstructionsReplayed() const { return instructionsReplayed; }
+    uint64_t getMinorFaults() const { return minorFaults; }
+    uint64_t getPoolFaults() const { return poolFaults; }
+    uint64_t getMajorFaults() const { return majorFaults; }
+    uint64_t getTotalCycles() const;
+    // Counters of every process of the run, the exited ones included
+    ProcessCounters getProcessCounters() const;
+    // Every process's statistics, then those of the enabled components, as printed at the end of a replay
+    void displayStatistics() const;
+};
+
+#endif // SIMULATOR_H
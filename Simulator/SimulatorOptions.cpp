@@ -0,0 +1,172 @@
+#include "SimulatorOptions.h"
+#include <sstream>
+#include <stdexcept>
+
+using namespace std;
+
+// Split a delimited option value such as "min:low:high" into its fields
+vector<string> splitList(const string& value, char delimiter) {
+    vector<string> fields;
+    istringstream iss(value);
+    string field;
+    while (getline(iss, field, delimiter)) {
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+// Parse numeric fields separated by colons, the same format generator.py uses for process configs
+vector<uint32_t> parseColonList(const string& value) {
+    vector<uint32_t> numbers;
+    for (const string& field : splitList(value, ':')) {
+        numbers.push_back(stoul(field));
+    }
+    return numbers;
+}
+
+// Remove an option from the map and return its value, or the default if it was not given
+string takeOption(map<string, string>& options, const string& name, const string& defaultValue) {
+    auto it = options.find(name);
+    if (it == options.end()) {
+        return defaultValue;
+    }
+    string value = it->second;
+    options.erase(it);
+    return value;
+}
+
+// Remove a flag without value from the map and return whether it was given
+bool takeFlag(map<string, string>& options, const string& name) {
+    bool given = options.count(name) > 0;
+    takeOption(options, name, "");
+    return given;
+}
+
+// Apply the optional "--name=value" flags to the simulator
+void configureSimulator(Simulator& simulator, map<string, string> options) {
+    string watermarks = takeOption(options, "watermarks", "");
+    if (!watermarks.empty()) {
+        vector<uint32_t> marks = parseColonList(watermarks);
+        if (marks.size() != 3) {
+            throw runtime_error("Watermarks must be given as <min>:<low>:<high>");
+        }
+        simulator.setWatermarks(marks[0], marks[1], marks[2]);
+    }
+    simulator.setBackgroundReclaimInterval(stoul(takeOption(options, "kswapd-interval", "0")));
+    simulator.setUnmapFlushCeiling(stoul(takeOption(options, "unmap-flush-ceiling", "33")));
+
+    string pageTableBackend = takeOption(options, "page-table", "two-level");
+    if (pageTableBackend == "hashed") {
+        simulator.enableHashedPageTable();
+    } else if (pageTableBackend != "two-level") {
+        throw runtime_error("Unknown page table " + pageTableBackend + ", expected two-level or hashed");
+    }
+
+    // Tiers come before the compressed pool so the pool's frames are reserved from the fast tier
+    string tiers = takeOption(options, "tiers", "");
+    uint32_t tierScanInterval = stoul(takeOption(options, "tier-scan-interval", "1000"));
+    uint32_t tierMigrateLimit = stoul(takeOption(options, "tier-migrate-limit", "16"));
+    uint32_t tierPromoteThreshold = stoul(takeOption(options, "tier-promote-threshold", "4"));
+    if (!tiers.empty()) {
+        vector<uint32_t> tierFrames;
+        vector<uint32_t> tierLatencies;
+        for (const string& tier : splitList(tiers, ',')) {
+            vector<uint32_t> fields = parseColonList(tier);
+            if (fields.size() != 2) {
+                throw runtime_error("Memory tiers must be given as <frames>:<latency_ns>,<frames>:<latency_ns>,...");
+            }
+            tierFrames.push_back(fields[0]);
+            tierLatencies.push_back(fields[1]);
+        }
+        simulator.enableTiering(tierFrames, tierLatencies, tierScanInterval, tierMigrateLimit, tierPromoteThreshold);
+    }
+
+    string numaNodes = takeOption(options, "numa-nodes", "");
+    string numaPolicies = takeOption(options, "numa-policy", "");
+    string numaHomes = takeOption(options, "numa-home", "");
+    vector<uint32_t> numaLatency = parseColonList(takeOption(options, "numa-latency", "80:140"));
+    uint32_t numaBalanceThreshold = stoul(takeOption(options, "numa-balance", "0"));
+    if (!numaNodes.empty()) {
+        vector<uint32_t> nodeFrames;
+        for (const string& node : splitList(numaNodes, ',')) {
+            nodeFrames.push_back(stoul(node));
+        }
+        if (numaLatency.size() != 2) {
+            throw runtime_error("NUMA latency must be given as <local_ns>:<remote_ns>");
+        }
+        simulator.enableNuma(nodeFrames, numaLatency[0], numaLatency[1], numaBalanceThreshold);
+
+        // Policies and home nodes are listed by pid, a single policy applies to every process
+        NumaManager& numa = simulator.getNumaManager();
+        vector<string> policies = splitList(numaPolicies, ',');
+        for (uint32_t pid = 0; pid < policies.size(); pid++) {
+            NumaPolicy policy;
+            uint32_t policyNode;
+            NumaManager::parsePolicy(policies[pid], policy, policyNode);
+            if (policies.size() == 1) {
+                numa.setDefaultPolicy(policy, policyNode);
+            } else {
+                numa.setPolicy(pid, policy, policyNode);
+            }
+        }
+        vector<string> homes = splitList(numaHomes, ',');
+        for (uint32_t pid = 0; pid < homes.size(); pid++) {
+            numa.setHomeNode(pid, stoul(homes[pid]));
+        }
+    } else if (!numaPolicies.empty() || !numaHomes.empty() || numaBalanceThreshold > 0) {
+        throw runtime_error("NUMA options require --numa-nodes");
+    }
+
+    if (takeFlag(options, "shared-code")) {
+        simulator.enableSharedCode();
+    }
+
+    string cycleCosts = takeOption(options, "cycle-costs", "");
+    if (!cycleCosts.empty()) {
+        simulator.setCycleCosts(parseColonList(cycleCosts));
+    }
+
+    string caches = takeOption(options, "caches", "");
+    uint32_t cacheLine = stoul(takeOption(options, "cache-line", "64"));
+    string cacheInclusion = takeOption(options, "cache-inclusion", "non-inclusive");
+    bool pageColoring = takeFlag(options, "page-coloring");
+    if (!caches.empty()) {
+        vector<pair<uint64_t, uint32_t>> levels;
+        for (const string& level : splitList(caches, ',')) {
+            vector<uint32_t> fields = parseColonList(level);
+            if (fields.size() != 2) {
+                throw runtime_error("Caches must be given as <size_bytes>:<ways>,<size_bytes>:<ways>,..., L1 first");
+            }
+            levels.emplace_back(fields[0], fields[1]);
+        }
+        simulator.enableCaches(levels, cacheLine, CacheHierarchy::parseInclusion(cacheInclusion), pageColoring);
+    } else if (pageColoring) {
+        throw runtime_error("Page coloring requires --caches");
+    }
+
+    bool heatProfile = takeFlag(options, "heat-profile");
+    string heatSketch = takeOption(options, "heat-sketch", "");
+    string heatTop = takeOption(options, "heat-top", "");
+    string heatDecay = takeOption(options, "heat-decay", "");
+    string heatRegion = takeOption(options, "heat-region", "");
+    if (heatProfile) {
+        vector<uint32_t> sketch = parseColonList(heatSketch.empty() ? "1024:4" : heatSketch);
+        if (sketch.size() != 2) {
+            throw runtime_error("Heat sketch must be given as <width>:<depth>");
+        }
+        simulator.enableHeatProfile(sketch[0], sketch[1], stoul(heatTop.empty() ? "16" : heatTop),
+                                    stoul(heatDecay.empty() ? "0" : heatDecay), stoul(heatRegion.empty() ? "512" : heatRegion));
+    } else if (!heatSketch.empty() || !heatTop.empty() || !heatDecay.empty() || !heatRegion.empty()) {
+        throw runtime_error("Heat options require --heat-profile");
+    }
+
+    uint32_t zswapFrames = stoul(takeOption(options, "zswap-frames", "0"));
+    uint32_t compressibility = stoul(takeOption(options, "page-compressibility", "50"));
+    if (zswapFrames > 0) {
+        simulator.enableCompressedSwap(zswapFrames, compressibility);
+    }
+
+    if (!options.empty()) {
+        throw runtime_error("Unknown option --" + options.begin()->first);
+    }
+}
@@ -0,0 +1,19 @@
+#ifndef SIMULATOROPTIONS_H
+#define SIMULATOROPTIONS_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include "Simulator.h"
+
+// Parsing of the optional "--name=value" flags, shared by vmsimulator, vmsimd and embedders
+std::vector<std::string> splitList(const std::string& value, char delimiter);
+std::vector<uint32_t> parseColonList(const std::string& value);
+std::string takeOption(std::map<std::string, std::string>& options, const std::string& name, const std::string& defaultValue);
+bool takeFlag(std::map<std::string, std::string>& options, const std::string& name);
+
+// Apply the simulator-wide options, throws on an unknown one
+void configureSimulator(Simulator& simulator, std::map<std::string, std::string> options);
+
+#endif // SIMULATOROPTIONS_H
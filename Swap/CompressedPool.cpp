@@ -0,0 +1,169 @@
+#include "CompressedPool.h"
+#include <iostream>
+#include "../Log/Log.h"
+
+using namespace std;
+
+static const uint32_t NUM_SIZE_CLASSES = 32; // Size classes per page, coarser than zsmalloc to limit fragmentation in small pools
+
+CompressedPool::CompressedPool(uint32_t pageSize, uint32_t capacityFrames)
+    : pageSize(pageSize),
+      capacityFrames(capacityFrames),
+      classGranularity(max(pageSize / NUM_SIZE_CLASSES, 1u)),
+      maxStoredSize(pageSize * 3 / 4),
+      classObjects(NUM_SIZE_CLASSES + 1, 0)
+{
+}
+
+// Round a compressed size up to its size class
+uint32_t CompressedPool::getSizeClass(uint32_t compressedSize) const
+{
+    return (compressedSize + classGranularity - 1) / classGranularity;
+}
+
+// Frames needed to pack the given number of objects of one size class
+uint32_t CompressedPool::getClassFrames(uint32_t sizeClass, uint32_t objects) const
+{
+    uint64_t bytes = static_cast<uint64_t>(objects) * sizeClass * classGranularity;
+    return static_cast<uint32_t>((bytes + pageSize - 1) / pageSize);
+}
+
+// Pages that barely compress would take almost a frame each, so they go straight to disk
+bool CompressedPool::acceptsSize(uint32_t compressedSize) const
+{
+    return compressedSize <= maxStoredSize;
+}
+
+bool CompressedPool::hasRoomFor(uint32_t compressedSize) const
+{
+    if (!acceptsSize(compressedSize))
+    {
+        return false;
+    }
+    uint32_t sizeClass = getSizeClass(compressedSize);
+    uint32_t objects = classObjects[sizeClass];
+    uint32_t extraFrames = getClassFrames(sizeClass, objects + 1) - getClassFrames(sizeClass, objects);
+    return usedFrames + extraFrames <= capacityFrames;
+}
+
+bool CompressedPool::storePage(uint64_t key, uint32_t compressedSize)
+{
+    storeAttempts++;
+    if (!acceptsSize(compressedSize) || !hasRoomFor(compressedSize))
+    {
+        rejectedPages++;
+        return false;
+    }
+    invalidatePage(key); // a stale copy must not be counted twice
+
+    uint32_t sizeClass = getSizeClass(compressedSize);
+    usedFrames += getClassFrames(sizeClass, classObjects[sizeClass] + 1) - getClassFrames(sizeClass, classObjects[sizeClass]);
+    classObjects[sizeClass]++;
+
+    lruList.push_back(key);
+    storedPages[key] = StoredPage{prev(lruList.end()), sizeClass};
+
+    originalBytes += pageSize;
+    compressedBytes += compressedSize;
+    if (storedPages.size() > peakStoredPages)
+    {
+        peakStoredPages = storedPages.size();
+    }
+    return true;
+}
+
+// release the slot of a stored page and give back any frame its size class no longer needs
+void CompressedPool::removeStoredPage(unordered_map<uint64_t, StoredPage>::iterator it)
+{
+    uint32_t sizeClass = it->second.sizeClass;
+    usedFrames -= getClassFrames(sizeClass, classObjects[sizeClass]) - getClassFrames(sizeClass, classObjects[sizeClass] - 1);
+    classObjects[sizeClass]--;
+    lruList.erase(it->second.lruPosition);
+    storedPages.erase(it);
+}
+
+bool CompressedPool::loadPage(uint64_t key)
+{
+    auto it = storedPages.find(key);
+    if (it == storedPages.end())
+    {
+        return false;
+    }
+    removeStoredPage(it);
+    loadHits++;
+    return true;
+}
+
+bool CompressedPool::writeBackLRU(uint64_t &key)
+{
+    if (lruList.empty())
+    {
+        return false;
+    }
+    key = lruList.front();
+    removeStoredPage(storedPages.find(key));
+    writtenBackPages++;
+    return true;
+}
+
+void CompressedPool::invalidatePage(uint64_t key)
+{
+    auto it = storedPages.find(key);
+    if (it != storedPages.end())
+    {
+        removeStoredPage(it);
+    }
+}
+
+uint32_t CompressedPool::invalidateProcess(uint32_t pid)
+{
+    uint32_t invalidated = 0;
+    for (auto it = storedPages.begin(); it != storedPages.end();)
+    {
+        auto following = next(it);
+        if (static_cast<uint32_t>(it->first >> 32) == pid)
+        {
+            removeStoredPage(it);
+            invalidated++;
+        }
+        it = following;
+    }
+    return invalidated;
+}
+
+bool CompressedPool::containsPage(uint64_t key) const
+{
+    return storedPages.find(key) != storedPages.end();
+}
+
+uint32_t CompressedPool::getCapacityFrames() const
+{
+    return capacityFrames;
+}
+
+uint32_t CompressedPool::getUsedFrames() const
+{
+    return usedFrames;
+}
+
+uint32_t CompressedPool::getStoredPages() const
+{
+    return storedPages.size();
+}
+
+// diskReads are the refaults the pool missed and the swap file had to serve
+void CompressedPool::displayStatistics(uint64_t diskReads) const
+{
+    uint64_t refaults = loadHits + diskReads;
+    *logStream << "Compressed Swap Pool Statistics:" << endl;
+    *logStream << "  Pool Capacity: " << capacityFrames << " frames, in use: " << usedFrames << " frames" << endl;
+    *logStream << "  Stored Pages: " << storedPages.size() << " (peak " << peakStoredPages << ")" << endl;
+    *logStream << "  Store Attempts: " << storeAttempts << ", rejected: " << rejectedPages << endl;
+    *logStream << "  Written Back to Swap File: " << writtenBackPages << endl;
+    *logStream << "  Pool Hit Rate: " << (refaults > 0 ? static_cast<double>(loadHits) / refaults * 100 : 0.0) << "% ("
+         << loadHits << " of " << refaults << " swap refaults)" << endl;
+    *logStream << "  Compression Ratio: " << (compressedBytes > 0 ? static_cast<double>(originalBytes) / compressedBytes : 0.0) << endl;
+    *logStream << "  Effective Capacity Gain: "
+         << (usedFrames > 0 ? static_cast<double>(storedPages.size()) / usedFrames : 0.0) << " pages per pool frame" << endl;
+    *logStream << endl;
+}
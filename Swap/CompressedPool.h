@@ -0,0 +1,77 @@
+#ifndef COMPRESSEDPOOL_H
+#define COMPRESSEDPOOL_H
+
+#include <unordered_map>
+#include <list>
+#include <vector>
+#include <cstdint>
+
+// Compressed in-memory swap cache (zswap-like) backed by a size-class allocator.
+// Compressed pages are rounded up to a size class and packed into whole frames of that class,
+// the pool never uses more than capacityFrames frames.
+class CompressedPool
+{
+private:
+    struct StoredPage
+    {
+        std::list<uint64_t>::iterator lruPosition; // Position in the LRU list
+        uint32_t sizeClass;                        // Index of the size class holding the page
+    };
+
+    uint32_t pageSize;
+    uint32_t capacityFrames;    // Maximum number of frames the pool may occupy
+    uint32_t classGranularity;  // Bytes between consecutive size classes
+    uint32_t maxStoredSize;     // Pages compressing worse than this are rejected
+
+    std::vector<uint32_t> classObjects; // Number of objects stored in each size class
+    uint32_t usedFrames = 0;            // Frames currently occupied by all size classes
+
+    std::unordered_map<uint64_t, StoredPage> storedPages;
+    std::list<uint64_t> lruList; // Least recently stored pages at the front
+
+    // Statistics
+    uint64_t storeAttempts = 0;
+    uint64_t rejectedPages = 0;
+    uint64_t loadHits = 0;
+    uint64_t writtenBackPages = 0;
+    uint64_t originalBytes = 0;   // Uncompressed bytes of every accepted page
+    uint64_t compressedBytes = 0; // Compressed bytes of every accepted page
+    uint32_t peakStoredPages = 0;
+
+    uint32_t getSizeClass(uint32_t compressedSize) const;
+    uint32_t getClassFrames(uint32_t sizeClass, uint32_t objects) const;
+    void removeStoredPage(std::unordered_map<uint64_t, StoredPage>::iterator it);
+
+public:
+    CompressedPool(uint32_t pageSize, uint32_t capacityFrames);
+
+    // Check whether a page of the given compressed size is accepted by the pool at all
+    bool acceptsSize(uint32_t compressedSize) const;
+
+    // Check whether a page of the given compressed size fits without writing anything back
+    bool hasRoomFor(uint32_t compressedSize) const;
+
+    // Store a compressed page; returns false if it was rejected or does not fit
+    bool storePage(uint64_t key, uint32_t compressedSize);
+
+    // Load a page on refault, the pool copy is released; returns false on a pool miss
+    bool loadPage(uint64_t key);
+
+    // Remove the least recently stored page so it can be written back to the swap file
+    bool writeBackLRU(uint64_t &key);
+
+    // Drop a page without loading it (e.g. the page was freed)
+    void invalidatePage(uint64_t key);
+
+    // Drop every page of a process, keyed by makeSwapKey, and return how many there were
+    uint32_t invalidateProcess(uint32_t pid);
+
+    bool containsPage(uint64_t key) const;
+
+    uint32_t getCapacityFrames() const;
+    uint32_t getUsedFrames() const;
+    uint32_t getStoredPages() const;
+    void displayStatistics(uint64_t diskReads) const;
+};
+
+#endif // COMPRESSEDPOOL_H
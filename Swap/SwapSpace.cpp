@@ -0,0 +1,87 @@
+#include "SwapSpace.h"
+
+SwapSpace::SwapSpace(std::shared_ptr<NodeArena> arena)
+    : swappedPages(0, std::hash<uint64_t>(), std::equal_to<uint64_t>(), PoolAllocator<uint64_t>(arena))
+{
+}
+
+// write a page to the swap file, used when a victim page is evicted
+void SwapSpace::writePage(uint64_t key)
+{
+    swappedPages.insert(key);
+    pagesWritten++;
+}
+
+// read a page back on a major fault, the swap slot is released after the read
+bool SwapSpace::readPage(uint64_t key)
+{
+    if (swappedPages.erase(key) == 0)
+    {
+        return false;
+    }
+    pagesRead++;
+    return true;
+}
+
+void SwapSpace::discardPage(uint64_t key)
+{
+    swappedPages.erase(key);
+}
+
+uint32_t SwapSpace::discardProcess(uint32_t pid)
+{
+    uint32_t discarded = 0;
+    for (auto it = swappedPages.begin(); it != swappedPages.end();)
+    {
+        if (static_cast<uint32_t>(*it >> 32) == pid)
+        {
+            it = swappedPages.erase(it);
+            discarded++;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    return discarded;
+}
+
+void SwapSpace::merge(const SwapSpace &other)
+{
+    swappedPages.insert(other.swappedPages.begin(), other.swappedPages.end());
+    pagesWritten += other.pagesWritten;
+    pagesRead += other.pagesRead;
+}
+
+std::vector<uint64_t> SwapSpace::getPages() const
+{
+    return std::vector<uint64_t>(swappedPages.begin(), swappedPages.end());
+}
+
+void SwapSpace::restore(const std::vector<uint64_t> &pages, uint64_t written, uint64_t read)
+{
+    swappedPages.clear();
+    swappedPages.insert(pages.begin(), pages.end());
+    pagesWritten = written;
+    pagesRead = read;
+}
+
+bool SwapSpace::containsPage(uint64_t key) const
+{
+    return swappedPages.find(key) != swappedPages.end();
+}
+
+uint64_t SwapSpace::getStoredPages() const
+{
+    return swappedPages.size();
+}
+
+uint64_t SwapSpace::getPagesWritten() const
+{
+    return pagesWritten;
+}
+
+uint64_t SwapSpace::getPagesRead() const
+{
+    return pagesRead;
+}
@@ -0,0 +1,55 @@
+#ifndef SWAPSPACE_H
+#define SWAPSPACE_H
+
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+#include <memory>
+#include "../Allocator/PoolAllocator.h"
+
+// Build the key identifying a page of a process in swap
+inline uint64_t makeSwapKey(uint32_t pid, uint32_t VPN)
+{
+    return (static_cast<uint64_t>(pid) << 32) | VPN;
+}
+
+// Backing swap file, tracks which pages have been written out to disk
+class SwapSpace
+{
+private:
+    std::unordered_set<uint64_t, std::hash<uint64_t>, std::equal_to<uint64_t>, PoolAllocator<uint64_t>> swappedPages; // Keys of pages currently stored in the swap file
+
+    // Counters for disk traffic
+    uint64_t pagesWritten = 0;
+    uint64_t pagesRead = 0;
+
+public:
+    // The set of stored pages draws from arena, or from the heap without one
+    explicit SwapSpace(std::shared_ptr<NodeArena> arena = nullptr);
+
+    // Write a page to the swap file
+    void writePage(uint64_t key);
+
+    // Read a page back from the swap file; returns false if the page is not in swap
+    bool readPage(uint64_t key);
+
+    // Drop a page from the swap file without reading it (e.g. the page was freed)
+    void discardPage(uint64_t key);
+
+    // Drop every page of a process, e.g. on exit, and return how many there were
+    uint32_t discardProcess(uint32_t pid);
+
+    // Add the pages and traffic of another swap file holding different processes
+    void merge(const SwapSpace &other);
+
+    // Checkpoints: the stored pages, and the contents and counters to put back
+    std::vector<uint64_t> getPages() const;
+    void restore(const std::vector<uint64_t> &pages, uint64_t written, uint64_t read);
+
+    bool containsPage(uint64_t key) const;
+    uint64_t getStoredPages() const;
+    uint64_t getPagesWritten() const;
+    uint64_t getPagesRead() const;
+};
+
+#endif // SWAPSPACE_H
@@ -0,0 +1,109 @@
+#include "PageCompressor.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+static const uint32_t CHUNK_SIZE = 64;      // Granularity at which page contents are made repetitive or random
+static const uint32_t MIN_MATCH = 4;        // Shortest match the compressor will encode
+static const uint32_t HASH_BITS = 12;
+
+PageCompressor::PageCompressor(uint32_t pageSize, uint32_t compressibility)
+    : pageSize(pageSize), compressibility(compressibility), pageBuffer(pageSize), hashTable(1 << HASH_BITS)
+{
+    if (compressibility > 100)
+    {
+        throw invalid_argument("Invalid compressibility: " + to_string(compressibility) + "%");
+    }
+    if (pageSize > 65536)
+    {
+        throw invalid_argument("Page size too large for the compressor: " + to_string(pageSize));
+    }
+}
+
+// splitmix64, cheap and deterministic per-page randomness
+static uint64_t nextRandom(uint64_t &state)
+{
+    uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Each chunk is either a repeated word (zeros, counters, pointers) or random bytes,
+// the share of repetitive chunks is given by the compressibility percentage
+void PageCompressor::generatePage(uint64_t key)
+{
+    uint64_t state = key;
+    for (uint32_t offset = 0; offset < pageSize; offset += CHUNK_SIZE)
+    {
+        uint32_t length = min(CHUNK_SIZE, pageSize - offset);
+        uint64_t choice = nextRandom(state);
+        if (choice % 100 < compressibility)
+        {
+            uint32_t word = (choice >> 32) % 4 == 0 ? 0 : static_cast<uint32_t>(choice >> 40);
+            for (uint32_t i = 0; i < length; i++)
+            {
+                pageBuffer[offset + i] = static_cast<uint8_t>(word >> (8 * (i % 4)));
+            }
+        }
+        else
+        {
+            for (uint32_t i = 0; i < length; i += 8)
+            {
+                uint64_t bytes = nextRandom(state);
+                memcpy(&pageBuffer[offset + i], &bytes, min(8u, length - i));
+            }
+        }
+    }
+}
+
+// Greedy LZ77 with a single-entry hash table, using the LZ4 sequence layout for sizing:
+// a token byte, extra literal/match length bytes, the literals and a 2-byte offset per match
+uint32_t PageCompressor::compressedSize(uint64_t key)
+{
+    generatePage(key);
+    fill(hashTable.begin(), hashTable.end(), 0);
+
+    const uint8_t *data = pageBuffer.data();
+    uint32_t size = 0;
+    uint32_t anchor = 0; // Start of pending literals
+    uint32_t pos = 0;
+    while (pos + MIN_MATCH <= pageSize)
+    {
+        uint32_t sequence;
+        memcpy(&sequence, data + pos, sizeof(sequence));
+        uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+        uint32_t candidate = hashTable[hash];
+        hashTable[hash] = static_cast<uint16_t>(pos);
+
+        if (candidate < pos && memcmp(data + candidate, data + pos, MIN_MATCH) == 0)
+        {
+            uint32_t matchLength = MIN_MATCH;
+            while (pos + matchLength < pageSize && data[candidate + matchLength] == data[pos + matchLength])
+            {
+                matchLength++;
+            }
+            uint32_t literals = pos - anchor;
+            size += 1 + literals + (literals >= 15 ? (literals - 15) / 255 + 1 : 0);
+            size += 2 + (matchLength - MIN_MATCH >= 15 ? (matchLength - MIN_MATCH - 15) / 255 + 1 : 0);
+            pos += matchLength;
+            anchor = pos;
+        }
+        else
+        {
+            pos++;
+        }
+    }
+
+    // trailing literals
+    uint32_t literals = pageSize - anchor;
+    size += 1 + literals + (literals >= 15 ? (literals - 15) / 255 + 1 : 0);
+    return size;
+}
+
+uint32_t PageCompressor::getCompressibility() const
+{
+    return compressibility;
+}
@@ -0,0 +1,29 @@
+#ifndef PAGECOMPRESSOR_H
+#define PAGECOMPRESSOR_H
+
+#include <cstdint>
+#include <vector>
+
+// Generates synthetic page contents and compresses them with a small LZ4-style compressor
+class PageCompressor
+{
+private:
+    uint32_t pageSize;
+    uint32_t compressibility; // Percentage (0 to 100) of a page filled with repetitive data
+
+    std::vector<uint8_t> pageBuffer;   // Scratch buffer for the synthetic page
+    std::vector<uint16_t> hashTable;   // Last position seen for each 4-byte hash
+
+    // Fill pageBuffer with deterministic contents for the given page
+    void generatePage(uint64_t key);
+
+public:
+    PageCompressor(uint32_t pageSize, uint32_t compressibility);
+
+    // Return the compressed size in bytes of the page identified by key
+    uint32_t compressedSize(uint64_t key);
+
+    uint32_t getCompressibility() const;
+};
+
+#endif // PAGECOMPRESSOR_H
@@ -3,12 +3,15 @@
 #include <climits>
 #include <iostream>
 #include <chrono>
+#include "../Profiler/Profiler.h"
 
 // Constructor for TLB, initializing with the given size
-TLB::TLB(uint32_t size) : size(size) {}
+TLB::TLB(uint32_t size, std::shared_ptr<NodeArena> arena)
+    : size(size), entries(0, std::hash<uint32_t>(), std::equal_to<uint32_t>(), PoolAllocator<std::pair<const uint32_t, TLBEntry>>(arena)) {}
 
 // Lookup function to check if a VPN is in TLB
 int TLB::lookupTLB(uint32_t vpn) {
+    PROFILE_STAGE(TlbLookup);
     auto expectEntry = entries.find(vpn);
     // Checks if the VPN was found in the map and if the entry is valid.
     if (expectEntry != entries.end() && expectEntry->second.valid) {
@@ -31,6 +34,12 @@ void TLB::updateTLB(uint32_t vpn, uint32_t pfn, bool read, bool write, bool exec
                             std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now().time_since_epoch()).count());
 }
 
+// Check the write permission cached with the translation, a write to a read-only entry is a protection fault
+bool TLB::isWritable(uint32_t vpn) const {
+    auto entry = entries.find(vpn);
+    return entry != entries.end() && entry->second.write;
+}
+
 // Delete one entry from the TLB by VPN
 void TLB::deleteTLB(uint32_t vpn) {
     entries.erase(vpn);
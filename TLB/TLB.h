@@ -3,14 +3,18 @@
 
 #include <unordered_map>
 #include <cstdint>
+#include <memory>
 #include "TLBEntry.h"
+#include "../Allocator/PoolAllocator.h"
 
 class TLB {
 public:
     uint32_t size;  // TLB size
-    std::unordered_map<uint32_t, TLBEntry> entries;  // Unordered map to simulate the TLB
+    std::unordered_map<uint32_t, TLBEntry, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                       PoolAllocator<std::pair<const uint32_t, TLBEntry>>> entries;  // Unordered map to simulate the TLB
 
-    TLB(uint32_t size);
+    // Entries are allocated from arena, or from the heap without one
+    TLB(uint32_t size, std::shared_ptr<NodeArena> arena = nullptr);
 
     // Lookup function to check if a VPN is in TLB
     int lookupTLB(uint32_t vpn);
@@ -18,6 +22,9 @@ public:
     // Update TLB with a new entry or modify an existing one
     void updateTLB(uint32_t vpn, uint32_t pfn, bool read, bool write, bool execute);
 
+    // Check whether the cached translation of a VPN allows writes
+    bool isWritable(uint32_t vpn) const;
+
     // Delete one entry from the TLB by VPN
     void deleteTLB(uint32_t vpn);
 
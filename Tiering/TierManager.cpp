@@ -0,0 +1,130 @@
+#include "TierManager.h"
+#include <iostream>
+#include "../Log/Log.h"
+#include <utility>
+
+using namespace std;
+
+TierManager::TierManager(const vector<uint32_t> &tierLatency, uint32_t totalFrames,
+                         uint32_t scanInterval, uint32_t migrationLimit, uint32_t promoteThreshold)
+    : tierLatency(tierLatency),
+      tierAccesses(tierLatency.size(), 0),
+      frameHeat(totalFrames, 0),
+      scanInterval(scanInterval),
+      migrationLimit(migrationLimit),
+      promoteThreshold(promoteThreshold)
+{
+}
+
+void TierManager::recordAccess(uint32_t frame, uint32_t tier)
+{
+    tierAccesses[tier]++;
+    if (frameHeat[frame] < UINT32_MAX)
+    {
+        frameHeat[frame]++;
+    }
+}
+
+bool TierManager::isScanDue()
+{
+    if (scanInterval == 0 || ++accessesSinceScan < scanInterval)
+    {
+        return false;
+    }
+    accessesSinceScan = 0;
+    return true;
+}
+
+void TierManager::ageHeat()
+{
+    for (uint32_t &heat : frameHeat)
+    {
+        heat >>= 1;
+    }
+}
+
+uint32_t TierManager::getHeat(uint32_t frame) const
+{
+    return frameHeat[frame];
+}
+
+// a newly mapped page starts cold
+void TierManager::resetHeat(uint32_t frame)
+{
+    frameHeat[frame] = 0;
+}
+
+// the heat follows the page when it migrates
+void TierManager::moveHeat(uint32_t fromFrame, uint32_t toFrame)
+{
+    frameHeat[toFrame] = frameHeat[fromFrame];
+    frameHeat[fromFrame] = 0;
+}
+
+// two pages exchanged their frames
+void TierManager::swapHeat(uint32_t firstFrame, uint32_t secondFrame)
+{
+    swap(frameHeat[firstFrame], frameHeat[secondFrame]);
+}
+
+uint32_t TierManager::getMigrationLimit() const
+{
+    return migrationLimit;
+}
+
+uint32_t TierManager::getPromoteThreshold() const
+{
+    return promoteThreshold;
+}
+
+void TierManager::recordScan()
+{
+    scans++;
+}
+
+void TierManager::recordPromotion()
+{
+    promotions++;
+}
+
+void TierManager::recordDemotion()
+{
+    demotions++;
+}
+
+void TierManager::recordTLBInvalidation()
+{
+    tlbInvalidations++;
+}
+
+void TierManager::recordRateLimited(uint64_t pages)
+{
+    rateLimitedPromotions += pages;
+}
+
+void TierManager::displayStatistics(const vector<uint32_t> &tierFrames, uint32_t pageSize) const
+{
+    uint64_t totalAccesses = 0;
+    uint64_t totalLatency = 0;
+    for (uint32_t tier = 0; tier < tierAccesses.size(); tier++)
+    {
+        totalAccesses += tierAccesses[tier];
+        totalLatency += tierAccesses[tier] * tierLatency[tier];
+    }
+
+    *logStream << "--- Memory Tier Statistics ---" << endl;
+    for (uint32_t tier = 0; tier < tierAccesses.size(); tier++)
+    {
+        *logStream << "  Tier " << tier << ": " << tierFrames[tier] << " frames, " << tierLatency[tier] << " ns, "
+             << tierAccesses[tier] << " accesses ("
+             << (totalAccesses > 0 ? static_cast<double>(tierAccesses[tier]) / totalAccesses * 100 : 0.0) << "%)" << endl;
+    }
+    *logStream << "  Average Memory Access Latency: "
+         << (totalAccesses > 0 ? static_cast<double>(totalLatency) / totalAccesses : 0.0) << " ns" << endl;
+    *logStream << "  Migration Scans: " << scans << endl;
+    *logStream << "  Promotions: " << promotions << ", Demotions: " << demotions << endl;
+    *logStream << "  Migration Traffic: " << (promotions + demotions) * pageSize << " bytes" << endl;
+    *logStream << "  Promotions Deferred by Rate Limit: " << rateLimitedPromotions << endl;
+    *logStream << "  TLB Invalidations from Migration: " << tlbInvalidations << endl;
+    *logStream << endl;
+}
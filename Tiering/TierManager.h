@@ -0,0 +1,58 @@
+#ifndef TIERMANAGER_H
+#define TIERMANAGER_H
+
+#include <vector>
+#include <cstdint>
+
+// Tracks page hotness and access costs for tiered memory, and decides which pages to migrate.
+// Hotness is a per-frame access histogram that is halved after every scan, so it follows recent use.
+class TierManager
+{
+private:
+    std::vector<uint32_t> tierLatency;  // Access cost of each tier in ns, tier 0 is the fastest
+    std::vector<uint64_t> tierAccesses; // Number of accesses served by each tier
+    std::vector<uint32_t> frameHeat;    // Decayed access count of the page in each frame
+
+    uint32_t scanInterval;     // Accesses between two migration scans
+    uint32_t migrationLimit;   // Maximum number of pages migrated per scan
+    uint32_t promoteThreshold; // Minimum heat for a page to be promoted
+    uint32_t accessesSinceScan = 0;
+
+    // Migration statistics
+    uint64_t scans = 0;
+    uint64_t promotions = 0;
+    uint64_t demotions = 0;
+    uint64_t tlbInvalidations = 0;
+    uint64_t rateLimitedPromotions = 0; // Hot pages left in a slow tier because the scan ran out of budget
+
+public:
+    TierManager(const std::vector<uint32_t>& tierLatency, uint32_t totalFrames,
+                uint32_t scanInterval, uint32_t migrationLimit, uint32_t promoteThreshold);
+
+    // Count an access to a frame of the given tier
+    void recordAccess(uint32_t frame, uint32_t tier);
+
+    // Returns true once every scanInterval accesses, when a migration scan is due
+    bool isScanDue();
+
+    // Halve the heat of every frame after a scan
+    void ageHeat();
+
+    uint32_t getHeat(uint32_t frame) const;
+    void resetHeat(uint32_t frame);
+    void moveHeat(uint32_t fromFrame, uint32_t toFrame);
+    void swapHeat(uint32_t firstFrame, uint32_t secondFrame);
+
+    uint32_t getMigrationLimit() const;
+    uint32_t getPromoteThreshold() const;
+
+    void recordScan();
+    void recordPromotion();
+    void recordDemotion();
+    void recordTLBInvalidation();
+    void recordRateLimited(uint64_t pages);
+
+    void displayStatistics(const std::vector<uint32_t>& tierFrames, uint32_t pageSize) const;
+};
+
+#endif // TIERMANAGER_H
@@ -0,0 +1,69 @@
+#include "SyntheticWorkload.h"
+#include <stdexcept>
+
+using namespace std;
+
+SyntheticWorkload::SyntheticWorkload(const vector<string> &specs, const vector<uint32_t> &processMemory, const WorkloadOptions &options)
+    : scheduleRandom(options.seed), switchProbability(options.switchProbability), remaining(options.instructions)
+{
+    if (processMemory.empty())
+    {
+        throw invalid_argument("A workload needs at least one process");
+    }
+    if (specs.size() != 1 && specs.size() != processMemory.size())
+    {
+        throw invalid_argument("Give one workload model for every process, or one for all of them");
+    }
+    if (!(options.switchProbability >= 0 && options.switchProbability <= 1))
+    {
+        throw invalid_argument("The switch probability must be between 0 and 1");
+    }
+    if (!(options.parameters.allocZipf > 1))
+    {
+        throw invalid_argument("The Zipf exponent of allocation sizes must be above 1");
+    }
+    for (uint32_t pid = 0; pid < processMemory.size(); pid++)
+    {
+        uint64_t processSeed = options.seed + (pid + 1) * 0x9E3779B97F4A7C15ULL;
+        models.push_back(makeWorkloadModel(specs[specs.size() == 1 ? 0 : pid], pid, processMemory[pid], processSeed, options.parameters));
+        processRandom.emplace_back(processSeed);
+    }
+    currentProcess = scheduleRandom.below(models.size());
+}
+
+size_t SyntheticWorkload::next(TraceOp *ops, size_t capacity)
+{
+    size_t count = 0;
+    while (count < capacity && remaining > 0)
+    {
+        if (pendingIndex < pending.size())
+        {
+            ops[count++] = pending[pendingIndex++];
+            remaining--;
+            continue;
+        }
+        pending.clear();
+        pendingIndex = 0;
+
+        // Like generator.py, a trace starts by switching to its first process
+        bool switching = !started || (models.size() > 1 && scheduleRandom.uniform() < switchProbability);
+        if (switching)
+        {
+            if (started)
+            {
+                uint32_t next = scheduleRandom.below(models.size() - 1);
+                currentProcess = next < currentProcess ? next : next + 1;
+            }
+            started = true;
+            TraceOp op;
+            op.pid = currentProcess;
+            op.command = TraceCommand::Switch;
+            pending.push_back(op);
+        }
+        else
+        {
+            models[currentProcess]->step(processRandom[currentProcess], pending);
+        }
+    }
+    return count;
+}
@@ -0,0 +1,44 @@
+#ifndef SYNTHETICWORKLOAD_H
+#define SYNTHETICWORKLOAD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../Simulator/Instruction.h"
+#include "helperFiles/WorkloadModels.h"
+
+struct WorkloadOptions
+{
+    uint64_t instructions = 1000000;
+    uint64_t seed = 1;
+    double switchProbability = 0.01; // Chance of a switch before every step, generator.py's share by default
+    WorkloadParameters parameters;
+};
+
+// Trace source generated in process instead of read from a file: one model per process, and a switch
+// to another process at random between steps. The same seed, models and options always produce the
+// same instructions
+class SyntheticWorkload
+{
+private:
+    std::vector<std::unique_ptr<WorkloadModel>> models;
+    std::vector<WorkloadRandom> processRandom; // Each process draws from its own stream
+    WorkloadRandom scheduleRandom;
+    double switchProbability;
+    uint64_t remaining;
+    uint32_t currentProcess;
+    bool started = false;
+    std::vector<TraceOp> pending; // Instructions of the current step not handed out yet
+    size_t pendingIndex = 0;
+
+public:
+    // One model spec per process, see makeWorkloadModel, or a single one for every process
+    SyntheticWorkload(const std::vector<std::string> &specs, const std::vector<uint32_t> &processMemory, const WorkloadOptions &options);
+
+    // Fill ops with the next instructions, returns how many, 0 once the instruction budget is used up
+    size_t next(TraceOp *ops, size_t capacity);
+};
+
+#endif // SYNTHETICWORKLOAD_H
@@ -0,0 +1,550 @@
+#include "WorkloadModels.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "../../Simulator/SimulatorOptions.h"
+
+using namespace std;
+
+// generator.py's address space: the heap starts above a 4 MB code segment and the stack grows down
+// from the top of the address space, at most 4 MB deep
+static const uint64_t CODE_SIZE = 4 * 1024 * 1024;
+static const uint64_t STACK_SPACE = 4 * 1024 * 1024;
+static const uint64_t ALLOC_PAGE = 4096;       // Unit of allocation and free sizes
+static const uint64_t HEAP_CHUNK = 64 * 1024;  // Allocation size of the models that allocate their heap up front
+static const uint64_t CACHE_LINE = 64;
+
+// splitmix64 finalizer, for the fixed structure the models derive from their seed
+static uint64_t mix(uint64_t value)
+{
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+WorkloadRandom::WorkloadRandom(uint64_t seed)
+{
+    for (uint64_t &word : state)
+    {
+        seed = mix(seed);
+        word = seed;
+    }
+}
+
+uint64_t WorkloadRandom::next()
+{
+    uint64_t result = state[1] * 5;
+    result = (result << 7 | result >> 57) * 9;
+    uint64_t shifted = state[1] << 17;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = state[3] << 45 | state[3] >> 19;
+    return result;
+}
+
+uint64_t WorkloadRandom::zipf(double exponent)
+{
+    double am1 = exponent - 1.0;
+    double b = pow(2.0, am1);
+    while (true)
+    {
+        double u = 1.0 - uniform();
+        double v = uniform();
+        double x = floor(pow(u, -1.0 / am1));
+        if (x < 1.0 || x > 9.0e18)
+        {
+            continue;
+        }
+        double t = pow(1.0 + 1.0 / x, am1);
+        if (v * x * (t - 1.0) / (b - 1.0) <= t / b)
+        {
+            return static_cast<uint64_t>(x);
+        }
+    }
+}
+
+ZipfianRanks::ZipfianRanks(uint64_t items, double skew) : items(items), skew(skew)
+{
+    if (items == 0 || !(skew > 0 && skew < 1))
+    {
+        throw invalid_argument("Zipfian ranks need at least one item and a skew between 0 and 1");
+    }
+    zetaItems = 0;
+    for (uint64_t i = 1; i <= items; i++)
+    {
+        zetaItems += 1.0 / pow(static_cast<double>(i), skew);
+    }
+    alpha = 1.0 / (1.0 - skew);
+    double zetaTwo = 1.0 + pow(0.5, skew);
+    eta = items > 2 ? (1.0 - pow(2.0 / items, 1.0 - skew)) / (1.0 - zetaTwo / zetaItems) : 0;
+}
+
+uint64_t ZipfianRanks::next(WorkloadRandom &random)
+{
+    double u = random.uniform();
+    double uz = u * zetaItems;
+    if (uz < 1.0 || items == 1)
+    {
+        return 0;
+    }
+    if (uz < 1.0 + pow(0.5, skew) || items == 2)
+    {
+        return 1;
+    }
+    return min(items - 1, static_cast<uint64_t>(items * pow(eta * u - eta + 1.0, alpha)));
+}
+
+static void pushAccess(vector<TraceOp> &ops, uint32_t pid, AccessType type, uint64_t address, bool isWrite)
+{
+    TraceOp op;
+    op.pid = pid;
+    op.command = TraceCommand::Access;
+    op.type = type;
+    op.isWrite = isWrite;
+    op.operand = static_cast<uint32_t>(address);
+    ops.push_back(op);
+}
+
+static void pushCommand(vector<TraceOp> &ops, uint32_t pid, TraceCommand command, uint64_t operand)
+{
+    TraceOp op;
+    op.pid = pid;
+    op.command = command;
+    op.operand = static_cast<uint32_t>(operand);
+    ops.push_back(op);
+}
+
+namespace
+{
+// generator.py's process: code fetches run on sequentially, loop back or call far away, stack accesses
+// stay near the stack pointer around calls and returns, heap accesses step next to the last one with
+// the locality's probability and are random otherwise, and the heap grows and shrinks by Zipf sizes
+class MixedModel : public WorkloadModel
+{
+private:
+    uint32_t pid;
+    double locality;
+    uint64_t maxMemory;
+    WorkloadParameters parameters;
+    uint64_t maxAddress;
+    uint64_t codePointer = 0;
+    vector<uint64_t> returnAddresses;
+    uint64_t stackPointer;
+    vector<uint64_t> stackBases;
+    uint64_t heapPointer = CODE_SIZE;
+    uint64_t heapSize = 0;
+
+    uint64_t clampStack(int64_t address) const
+    {
+        return static_cast<uint64_t>(max<int64_t>(min<int64_t>(address, maxAddress), maxAddress - STACK_SPACE));
+    }
+
+    uint64_t clampHeap(int64_t address) const
+    {
+        int64_t end = static_cast<int64_t>(CODE_SIZE + heapSize);
+        return static_cast<uint64_t>(max<int64_t>(min<int64_t>(address, end - 1), CODE_SIZE));
+    }
+
+    void accessCode(WorkloadRandom &random, vector<TraceOp> &ops)
+    {
+        double p = random.uniform();
+        if (p < 0.8)
+        {
+            codePointer++;
+        }
+        else if (p < 0.95)
+        {
+            // Loop back at most 128 instructions
+            if (codePointer > 0)
+            {
+                codePointer -= random.between(1, min<uint64_t>(codePointer, 8 * 128));
+            }
+        }
+        else
+        {
+            codePointer = random.between(0, CODE_SIZE);
+        }
+        pushAccess(ops, pid, AccessType::Code, codePointer, false);
+    }
+
+    void accessStack(WorkloadRandom &random, vector<TraceOp> &ops)
+    {
+        const double stackWrites = 0.5;
+        double p = random.uniform();
+        if (p < 0.475)
+        {
+            pushAccess(ops, pid, AccessType::Stack, stackPointer, random.uniform() < stackWrites);
+        }
+        else if (p < 0.95)
+        {
+            stackPointer = clampStack(static_cast<int64_t>(stackPointer) + random.between(-8 * 16, 8 * 16));
+            pushAccess(ops, pid, AccessType::Stack, stackPointer, random.uniform() < stackWrites);
+        }
+        else if (p < 0.975)
+        {
+            // A call pushes its arguments and return address, then jumps to its code and frame
+            int64_t pushes = random.between(0, 5) + 1;
+            for (int64_t i = 0; i < pushes; i++)
+            {
+                stackPointer = clampStack(static_cast<int64_t>(stackPointer) - 1);
+                pushAccess(ops, pid, AccessType::Stack, stackPointer, random.uniform() < stackWrites);
+            }
+            returnAddresses.push_back(codePointer);
+            codePointer = random.between(0, CODE_SIZE);
+            stackBases.push_back(stackPointer);
+            stackPointer = clampStack(static_cast<int64_t>(stackPointer) - 8 * 32);
+        }
+        else if (!returnAddresses.empty())
+        {
+            codePointer = returnAddresses.back();
+            returnAddresses.pop_back();
+            stackPointer = stackBases.back();
+            stackBases.pop_back();
+            pushAccess(ops, pid, AccessType::Stack, stackPointer, random.uniform() < stackWrites);
+        }
+    }
+
+    void accessHeap(WorkloadRandom &random, vector<TraceOp> &ops)
+    {
+        if (heapSize == 0)
+        {
+            allocate(random, ops);
+            return;
+        }
+        if (random.uniform() < locality)
+        {
+            heapPointer = clampHeap(static_cast<int64_t>(heapPointer) + random.between(-1, 1));
+        }
+        else if (random.uniform() < 0.5)
+        {
+            heapPointer = clampHeap(random.between(CODE_SIZE, CODE_SIZE + heapSize));
+        }
+        else
+        {
+            // Anywhere the heap could grow to, clamped to its end, which makes the end of the heap hot
+            heapPointer = clampHeap(random.between(CODE_SIZE, CODE_SIZE + maxMemory));
+        }
+        pushAccess(ops, pid, AccessType::Heap, heapPointer, random.uniform() < parameters.writeShare);
+    }
+
+    uint64_t zipfSize(WorkloadRandom &random, uint64_t limit)
+    {
+        uint64_t pages = min(random.zipf(parameters.allocZipf), limit / ALLOC_PAGE + 1);
+        return min(pages * ALLOC_PAGE, limit);
+    }
+
+    void allocate(WorkloadRandom &random, vector<TraceOp> &ops)
+    {
+        if (heapSize == maxMemory)
+        {
+            return;
+        }
+        uint64_t size = zipfSize(random, maxMemory - heapSize);
+        heapSize += size;
+        pushCommand(ops, pid, TraceCommand::Alloc, size);
+    }
+
+    void release(WorkloadRandom &random, vector<TraceOp> &ops)
+    {
+        if (heapSize == 0)
+        {
+            return;
+        }
+        uint64_t size = zipfSize(random, heapSize);
+        heapSize -= size;
+        if (heapPointer > CODE_SIZE + heapSize)
+        {
+            heapPointer = random.between(CODE_SIZE, CODE_SIZE + heapSize);
+        }
+        pushCommand(ops, pid, TraceCommand::Free, size);
+    }
+
+public:
+    MixedModel(uint32_t pid, double locality, uint64_t maxMemory, const WorkloadParameters &parameters)
+        : pid(pid), locality(locality), maxMemory(maxMemory), parameters(parameters),
+          maxAddress((1ULL << parameters.addressBits) - 1), stackPointer(maxAddress)
+    {
+    }
+
+    void step(WorkloadRandom &random, vector<TraceOp> &ops) override
+    {
+        // generator.py's mix of operations, without its 1% of switches, which the workload draws itself
+        double p = random.uniform() * 0.99;
+        if (p < 0.3)
+        {
+            accessCode(random, ops);
+        }
+        else if (p < 0.6)
+        {
+            accessStack(random, ops);
+        }
+        else if (p < 0.9)
+        {
+            accessHeap(random, ops);
+        }
+        else if (p < 0.98)
+        {
+            allocate(random, ops);
+        }
+        else
+        {
+            release(random, ops);
+        }
+    }
+};
+
+// Models working on a heap of the process's whole memory, allocated in chunks before the first access
+class HeapModel : public WorkloadModel
+{
+private:
+    uint64_t allocated = 0;
+
+protected:
+    uint32_t pid;
+    uint64_t heapBytes;
+    double writeShare;
+
+    void access(vector<TraceOp> &ops, uint64_t offset, bool isWrite)
+    {
+        pushAccess(ops, pid, AccessType::Heap, CODE_SIZE + offset, isWrite);
+    }
+
+    virtual void accessHeap(WorkloadRandom &random, vector<TraceOp> &ops) = 0;
+
+public:
+    HeapModel(uint32_t pid, uint64_t heapBytes, double writeShare) : pid(pid), heapBytes(heapBytes), writeShare(writeShare) {}
+
+    void step(WorkloadRandom &random, vector<TraceOp> &ops) override
+    {
+        if (allocated < heapBytes)
+        {
+            uint64_t size = min(HEAP_CHUNK, heapBytes - allocated);
+            allocated += size;
+            pushCommand(ops, pid, TraceCommand::Alloc, size);
+            return;
+        }
+        accessHeap(random, ops);
+    }
+};
+
+// Sweeps over the heap with a fixed stride, wrapping around at its end
+class StridedModel : public HeapModel
+{
+private:
+    uint64_t stride;
+    uint64_t offset = 0;
+
+protected:
+    void accessHeap(WorkloadRandom &random, vector<TraceOp> &ops) override
+    {
+        access(ops, offset, random.uniform() < writeShare);
+        offset = (offset + stride) % heapBytes;
+    }
+
+public:
+    StridedModel(uint32_t pid, uint64_t heapBytes, double writeShare, uint64_t stride)
+        : HeapModel(pid, heapBytes, writeShare), stride(stride)
+    {
+    }
+};
+
+// Follows next pointers through the heap's nodes in a random order that visits every node once per
+// round, like a shuffled linked list. The order is a bijection on the next power of two above the node
+// count, values past the last node are skipped, so it takes no memory however many nodes there are
+class PointerChaseModel : public HeapModel
+{
+private:
+    uint64_t nodeBytes;
+    uint64_t nodes;
+    uint64_t mask;
+    uint32_t shift;
+    uint64_t multipliers[2];
+    uint64_t key;
+    uint64_t position = 0;
+
+    uint64_t permute(uint64_t value) const
+    {
+        value = (value ^ key) & mask;
+        value = (value * multipliers[0]) & mask;
+        value ^= value >> shift;
+        value = (value * multipliers[1]) & mask;
+        return value ^ (value >> shift);
+    }
+
+protected:
+    void accessHeap(WorkloadRandom &, vector<TraceOp> &ops) override
+    {
+        uint64_t node;
+        do
+        {
+            position = (position + 1) & mask;
+            node = permute(position);
+        } while (node >= nodes);
+        access(ops, node * nodeBytes, false);
+    }
+
+public:
+    PointerChaseModel(uint32_t pid, uint64_t heapBytes, uint64_t seed, uint64_t nodeBytes)
+        : HeapModel(pid, heapBytes, 0), nodeBytes(nodeBytes), nodes(max<uint64_t>(heapBytes / nodeBytes, 1))
+    {
+        uint32_t bits = 1;
+        while ((1ULL << bits) < nodes)
+        {
+            bits++;
+        }
+        mask = (1ULL << bits) - 1;
+        shift = max<uint32_t>(bits / 2, 1);
+        multipliers[0] = mix(seed) | 1;
+        multipliers[1] = mix(seed + 1) | 1;
+        key = mix(seed + 2);
+    }
+};
+
+// Random walk with restarts over a graph stored as compressed sparse rows: an offset per vertex, the
+// edge lists and a property per vertex. A step reads the vertex's offset, its edges and the property
+// of every neighbor, then writes its own property, like a pull-based PageRank iteration. Degrees and
+// neighbors are hashed from the seed, half of the neighbors are close to the vertex and half anywhere
+class GraphModel : public HeapModel
+{
+private:
+    uint64_t seed;
+    uint64_t degree;
+    uint64_t vertices;
+    uint64_t edgeBase;
+    uint64_t propertyBase;
+    uint64_t vertex = 0;
+
+    uint64_t getDegree(uint64_t from) const
+    {
+        return min(1 + mix(seed ^ from) % (2 * degree - 1), vertices * degree);
+    }
+
+    uint64_t getNeighbor(uint64_t from, uint64_t edge) const
+    {
+        uint64_t hash = mix(seed + from * 0x9E3779B97F4A7C15ULL + edge);
+        if (hash & 1)
+        {
+            return (from + vertices * 64 + (hash >> 1) % 129 - 64) % vertices;
+        }
+        return (hash >> 8) % vertices;
+    }
+
+protected:
+    void accessHeap(WorkloadRandom &random, vector<TraceOp> &ops) override
+    {
+        access(ops, vertex * 8, false);
+        uint64_t edges = getDegree(vertex);
+        uint64_t firstEdge = min(vertex * degree, vertices * degree - edges);
+        for (uint64_t edge = 0; edge < edges; edge++)
+        {
+            access(ops, edgeBase + (firstEdge + edge) * 4, false);
+            access(ops, propertyBase + getNeighbor(vertex, edge) * 8, false);
+        }
+        access(ops, propertyBase + vertex * 8, true);
+        vertex = random.uniform() < 0.15 ? random.below(vertices) : getNeighbor(vertex, random.below(edges));
+    }
+
+public:
+    GraphModel(uint32_t pid, uint64_t heapBytes, uint64_t seed, uint64_t degree)
+        : HeapModel(pid, heapBytes, 0), seed(seed), degree(degree), vertices(max<uint64_t>(heapBytes / (16 + 4 * degree), 1))
+    {
+        edgeBase = vertices * 8;
+        propertyBase = edgeBase + vertices * degree * 4;
+    }
+};
+
+// Lookups in a hash table of fixed-size values, keys drawn with Zipfian popularity and scattered over
+// the table. A lookup reads the key's bucket, then reads or, with the write share, writes its value
+class KeyValueModel : public HeapModel
+{
+private:
+    uint64_t seed;
+    uint64_t valueBytes;
+    uint64_t keys;
+    ZipfianRanks ranks;
+
+protected:
+    void accessHeap(WorkloadRandom &random, vector<TraceOp> &ops) override
+    {
+        uint64_t key = mix(seed ^ ranks.next(random)) % keys;
+        access(ops, mix(seed + key) % keys * 8, false);
+        bool isWrite = random.uniform() < writeShare;
+        uint64_t value = keys * 8 + key * valueBytes;
+        for (uint64_t offset = 0; offset < valueBytes; offset += CACHE_LINE)
+        {
+            access(ops, value + offset, isWrite);
+        }
+    }
+
+public:
+    KeyValueModel(uint32_t pid, uint64_t heapBytes, double writeShare, uint64_t seed, uint64_t valueBytes, double skew)
+        : HeapModel(pid, heapBytes, writeShare), seed(seed), valueBytes(valueBytes),
+          keys(max<uint64_t>(heapBytes / (8 + valueBytes), 1)), ranks(keys, skew)
+    {
+    }
+};
+}
+
+unique_ptr<WorkloadModel> makeWorkloadModel(const string &spec, uint32_t pid, uint32_t memoryBytes, uint64_t seed,
+                                            const WorkloadParameters &parameters)
+{
+    vector<string> fields = splitList(spec, ':');
+    string name = fields.empty() ? "" : fields[0];
+    auto parameter = [&](size_t index, const string &defaultValue) {
+        return stod(index < fields.size() ? fields[index] : defaultValue);
+    };
+    if (CODE_SIZE + memoryBytes + STACK_SPACE > (1ULL << parameters.addressBits))
+    {
+        throw invalid_argument("The heap of process " + to_string(pid) + " does not fit in the address space");
+    }
+
+    if (name == "mixed")
+    {
+        return unique_ptr<WorkloadModel>(new MixedModel(pid, parameter(1, "0.5"), memoryBytes, parameters));
+    }
+    if (memoryBytes == 0)
+    {
+        throw invalid_argument("Workload model " + name + " needs process memory for its heap");
+    }
+    if (name == "strided")
+    {
+        uint64_t stride = static_cast<uint64_t>(parameter(1, "64"));
+        if (stride == 0)
+        {
+            throw invalid_argument("The stride must be at least one byte");
+        }
+        return unique_ptr<WorkloadModel>(new StridedModel(pid, memoryBytes, parameters.writeShare, stride));
+    }
+    if (name == "pointer-chase")
+    {
+        uint64_t nodeBytes = static_cast<uint64_t>(parameter(1, "64"));
+        if (nodeBytes == 0)
+        {
+            throw invalid_argument("Pointer-chase nodes must be at least one byte");
+        }
+        return unique_ptr<WorkloadModel>(new PointerChaseModel(pid, memoryBytes, seed, nodeBytes));
+    }
+    if (name == "graph")
+    {
+        uint64_t degree = static_cast<uint64_t>(parameter(1, "8"));
+        if (degree == 0)
+        {
+            throw invalid_argument("The graph degree must be at least 1");
+        }
+        return unique_ptr<WorkloadModel>(new GraphModel(pid, memoryBytes, seed, degree));
+    }
+    if (name == "key-value")
+    {
+        uint64_t valueBytes = static_cast<uint64_t>(parameter(1, "256"));
+        if (valueBytes == 0)
+        {
+            throw invalid_argument("Key-value values must be at least one byte");
+        }
+        return unique_ptr<WorkloadModel>(new KeyValueModel(pid, memoryBytes, parameters.writeShare, seed, valueBytes, parameter(2, "0.99")));
+    }
+    throw invalid_argument("Unknown workload model " + spec + ", expected mixed, strided, pointer-chase, graph or key-value");
+}
@@ -0,0 +1,77 @@
+#ifndef WORKLOADMODELS_H
+#define WORKLOADMODELS_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "../../Simulator/Instruction.h"
+
+// xoshiro256** seeded through splitmix64. Draws are computed here instead of with the standard
+// distributions, whose results differ between standard libraries, so a seed generates the same
+// workload everywhere
+class WorkloadRandom
+{
+private:
+    uint64_t state[4];
+
+public:
+    explicit WorkloadRandom(uint64_t seed);
+    uint64_t next();
+
+    // Uniform in [0, 1)
+    double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+    // Uniform in [0, bound), bound below 2^53
+    uint64_t below(uint64_t bound) { return static_cast<uint64_t>(uniform() * bound); }
+    // Uniform in [low, high]
+    int64_t between(int64_t low, int64_t high) { return low + static_cast<int64_t>(below(high - low + 1)); }
+    // Unbounded Zipf with an exponent above 1, the rejection sampler numpy.random.zipf uses
+    uint64_t zipf(double exponent);
+};
+
+// Ranks 0 to items - 1 drawn with probability proportional to 1 / (rank + 1)^skew, skew in (0, 1), in
+// constant time per draw after an O(items) setup (Gray et al., Quickly Generating Billion-Record
+// Synthetic Databases). Rank 0 is the most popular
+class ZipfianRanks
+{
+private:
+    uint64_t items;
+    double skew;
+    double alpha;
+    double zetaItems;
+    double eta;
+
+public:
+    ZipfianRanks(uint64_t items, double skew);
+    uint64_t next(WorkloadRandom &random);
+};
+
+// Knobs shared by every model
+struct WorkloadParameters
+{
+    uint32_t addressBits = 32;
+    double writeShare = 0.3;  // Share of data accesses that are writes, where the model does not fix it
+    double allocZipf = 2.0;   // Exponent of the Zipf distribution of allocation and free sizes, in pages
+};
+
+// Access pattern of one process. A step appends the instructions of one step of the process to ops,
+// possibly none. Models only emit accesses, allocations and frees of their own process
+class WorkloadModel
+{
+public:
+    virtual ~WorkloadModel() = default;
+    virtual void step(WorkloadRandom &random, std::vector<TraceOp> &ops) = 0;
+};
+
+// A model from its spec, "<name>[:<parameter>...]":
+//   mixed[:<locality>]                   generator.py's code, stack and heap model (default 0.5)
+//   strided[:<stride_bytes>]             sequential sweeps over the heap (default 64)
+//   pointer-chase[:<node_bytes>]         a random cycle through heap nodes (default 64)
+//   graph[:<degree>]                     random walk over a CSR graph, reading every neighbor (default 8)
+//   key-value[:<value_bytes>[:<skew>]]   Zipf-popular lookups in a hash table (default 256:0.99)
+// memoryBytes is the process's memory, the heap every model but mixed allocates up front. The seed fixes
+// the structure a model derives from it, such as the graph or the pointer-chase order
+std::unique_ptr<WorkloadModel> makeWorkloadModel(const std::string &spec, uint32_t pid, uint32_t memoryBytes, uint64_t seed,
+                                                 const WorkloadParameters &parameters);
+
+#endif // WORKLOADMODELS_H
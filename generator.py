@@ -1,3 +1,4 @@
+import copy
 import random
 import sys
 from typing import List, Tuple, Union
@@ -5,9 +6,11 @@ from io import TextIOWrapper
 import numpy as np
 import argparse
 '''
-Usage: python test_generator.py <num_instructions> <process list>
+Usage: python test_generator.py [--prefork N] <num_instructions> <process list>
 E.g.: python3 test_generator.py 10000 0.5:1024 0.6:102400 0.95:`expr 1024 \\* 1024 \\* 1024`
 For each process, two parameters are needed to be specified: locality and max memory usage
+With --prefork N, the first process runs alone for a while and then forks N workers that start
+from a copy of its state, like a pre-fork server
 Locality means the chance of the address of a heap access is adjacent to the previous access.
 High locality program example: matrix multiplication application, sequential memory access
 Low locality program example:  graph application, such as compilers and social media analysis apps, random memory access
@@ -18,6 +21,7 @@ For each time step, it could generate one of the following operations
 4. access heap memory (that's where the access pattern plays a role in)
 5. allocate memory
 6. free memory
+Stack and heap accesses are marked as reads (r) or writes (w)
 For each access to code segment, it could be
 1. fetch next instruction (sequential execution)
 2. jump to a location near the current location (loop)
@@ -35,6 +39,9 @@ MAX_ADDR = 0xffffffff
 MIN_STACK_ADDR = MAX_ADDR - 4 * 1024 * 1024  # 4 MB max stack space
 CODE_SIZE = 4 * 1024 * 1024  # 4 MB static data
 MIN_PAGE_SIZE = 4096
+STACK_WRITE = 0.5  # share of stack accesses that are writes
+HEAP_WRITE = 0.3  # share of heap accesses that are writes
+PREFORK_WARMUP = 0.1  # share of the instructions the parent runs before forking its workers
 
 
 class Process:
@@ -176,13 +183,14 @@ def parse_process_params(config: str) -> Tuple[float, int]:
             "Processes must be defined in the format 'locality:max_memory' where locality is a float and max_memory is a int."
         )
 
-def write_access_mem(f: TextIOWrapper, id: int, addr: Union[int, List[int]], type: str) -> None:
-    if isinstance(addr, List):
-        addrs = addr
-        for addr in addrs:
+def write_access_mem(f: TextIOWrapper, id: int, addr: Union[int, List[int]], type: str, write_ratio: float = -1) -> None:
+    addrs = addr if isinstance(addr, List) else [addr]
+    for addr in addrs:
+        if write_ratio < 0:
             f.write(f'{id}\taccess_{type}\t{hex(addr)}\n')
-    else:
-        f.write(f'{id}\taccess_{type}\t{hex(addr)}\n')
+        else:
+            mode = 'w' if random.random() < write_ratio else 'r'
+            f.write(f'{id}\taccess_{type}\t{hex(addr)}\t{mode}\n')
 
 def write_alloc_mem(f: TextIOWrapper, id: int, size: int) -> None:
     f.write(f'{id}\talloc\t\t{hex(size)}\n')
@@ -193,10 +201,14 @@ def write_free_mem(f: TextIOWrapper, id: int, addr: int) -> None:
 def write_switch_proc(f: TextIOWrapper, id: int) -> None:
     f.write(f'{id}\tswitch\t\n')
 
+def write_fork_proc(f: TextIOWrapper, id: int, child_id: int) -> None:
+    f.write(f'{id}\tfork\t\t{child_id}\n')
+
 def main() -> None:
     parser = argparse.ArgumentParser()
     parser.add_argument('num_tests', type = int, help='Num of tests generated')
     parser.add_argument('process_configs', nargs='+', type=parse_process_params)
+    parser.add_argument('--prefork', type = int, default = 0, help='Workers forked from the first process')
 
     args = parser.parse_args()
     num_tests = args.num_tests
@@ -211,21 +223,30 @@ def main() -> None:
     ALLOC = 0.98
     FREE = 0.99
     SWITCH = 1
+    # Workers get the next free ids, the simulator creates them on fork
+    fork_at = int(num_tests * PREFORK_WARMUP) if args.prefork > 0 else -1
     with sys.stdout as f:
-        current_process: Process = random.choice(processes)
+        current_process: Process = processes[0] if args.prefork > 0 else random.choice(processes)
         write_switch_proc(f, current_process.id)
         for i in range(num_tests):
+            if i == fork_at:
+                parent = processes[0]
+                for _ in range(args.prefork):
+                    worker = copy.deepcopy(parent)
+                    worker.id = len(processes)
+                    write_fork_proc(f, parent.id, worker.id)
+                    processes.append(worker)
             p = random.random()
             if p < FETCH:
                 addr = current_process.access_code()
                 write_access_mem(f, current_process.id, addr, 'code')
             elif p < STACK:
                 addr = current_process.access_stack()
-                write_access_mem(f, current_process.id, addr, 'stak')
+                write_access_mem(f, current_process.id, addr, 'stak', STACK_WRITE)
             elif p < HEAP:
                 addr = current_process.access_heap()
                 if addr != -1:
-                    write_access_mem(f, current_process.id, addr, 'heap')
+                    write_access_mem(f, current_process.id, addr, 'heap', HEAP_WRITE)
                 else:
                     size = current_process.allocate_mem()
                     if size != 0:
@@ -239,6 +260,9 @@ def main() -> None:
                 if addr != 0:
                     write_free_mem(f, current_process.id, addr)
             elif p < SWITCH:
+                # Before the fork the parent has nobody to switch to
+                if 0 <= i < fork_at:
+                    continue
                 proc: Process = random.choice(processes)
                 while proc.id == current_process.id and len(processes) != 1:
                     proc = random.choice(processes)
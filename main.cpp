@@ -4,404 +4,662 @@
 #include <string>
 #include <cmath>
 #include <map>
-#include <list>
 #include <vector>
 #include <cstdint>
-#include "PageTable/PageTable.h"
-#include "TLB/TLB.h"
-#include "PageTable/PhysicalFrameManager.h"
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include "Simulator/Simulator.h"
+#include "Simulator/SimulatorOptions.h"
+#include "Simulator/Instruction.h"
+#include "Workload/SyntheticWorkload.h"
+#include "PageTable/PageGeometry.h"
+#include "Scheduler/Scheduler.h"
+#include "Log/Log.h"
+#include "Profiler/Profiler.h"
+#include "Sampling/SampleStats.h"
+#include "Sampling/SimPoint.h"
 
 using namespace std;
 
-class Process {
-private:
-    uint32_t id;
-    uint32_t addressBits;
-    uint32_t pageSize;
-    PageTable* pageTable;
-    list<uint32_t> availableFrames; // A list of physical frames to use
-    uint32_t maxFrames; // Max number of frames for this process
-    uint32_t allocatedFrames;  // Number of frames assigned to this process, should never exceed maxFrames
-
-    // Counters for tracking individual process statistics
-    uint32_t tlbHits = 0;
-    uint32_t tlbMisses = 0;
-    uint32_t pageTableHits = 0;
-    uint32_t pageTableMisses = 0;
-    uint32_t memoryAccessAttempts = 0;
-
-public:
-    Process(uint32_t pid, uint32_t addressBits, uint32_t pageSize, uint32_t numPages, list<uint32_t> allocatedFrames);
-    uint32_t getPid();
-    uint32_t getMaxFrames();
-    uint32_t getAllocationQuota();
-    PageTable* getPageTable();
-    void allocateMemory(list<uint32_t> allocatedFrames);
-    void freeMemory(uint32_t frameNumber);
-    uint32_t getAFrame();
-    void returnAFrame(uint32_t frame);
-
-    // Functions to increment counters
-    void incrementTLBHit() { tlbHits++; }
-    void incrementTLBMiss() { tlbMisses++; }
-    void incrementPageTableHit() { pageTableHits++; }
-    void incrementPageTableMiss() { pageTableMisses++; }
-    void incrementMemoryAccess() { memoryAccessAttempts++; }
-
-    // Functions to calculate hit rates
-    double getTLBHitRate() const;
-    double getPageTableHitRate() const;
-    PageTable* getPageTable() const;
-    // Display statistics for the process
-    void displayStatistics() const;
-};
-
-Process::Process(uint32_t pid, uint32_t virtualAddressLen, uint32_t pageSize_, uint32_t numPages, list<uint32_t> frames): id(pid), addressBits(virtualAddressLen), pageSize(pageSize_), maxFrames(numPages), availableFrames(frames), allocatedFrames(frames.size()), pageTable(new PageTable(virtualAddressLen, pageSize_)) {}
-
-uint32_t Process::getPid() {
-    return id;
-}
-uint32_t Process::getMaxFrames() {
-    return maxFrames;
-}
-
-uint32_t Process::getAllocationQuota() {
-    return maxFrames - allocatedFrames;
-}
-
-PageTable* Process::getPageTable() {
-    return pageTable;
-}
-
-void Process::allocateMemory(list<uint32_t> frames) {
-    while (!frames.empty()) {
-        availableFrames.push_back(frames.front());
-        frames.pop_front();
+// Replay every process's instructions on worker threads. With partitioned frames processes share nothing,
+// so each worker runs its own simulator for its processes, the per-line output is written back in trace
+// order and the workers' processes and statistics are merged into the main simulator afterwards
+static void replayInParallel(Simulator& simulator, const function<unique_ptr<Simulator>()>& makeSimulator,
+                             const vector<uint32_t>& processPages, const string& traceFile, uint32_t threadCount) {
+    ifstream inFile(traceFile);
+    if (!inFile) {
+        throw runtime_error("Cannot open instruction file " + traceFile);
     }
-    allocatedFrames = availableFrames.size();
-}
 
-void Process::freeMemory(uint32_t frameNumber) {
-    allocatedFrames--;
-}
-
-uint32_t Process::getAFrame() {
-    if (availableFrames.size() < 1) {
-        return -1;
+    // Split the trace by pid, lines without one stay with the process of the previous line
+    vector<string> lines;
+    vector<vector<size_t>> processLines(processPages.size());
+    uint32_t owner = 0;
+    string line;
+    while (getline(inFile, line)) {
+        istringstream iss(line);
+        uint32_t pid;
+        if (iss >> pid) {
+            if (pid >= processPages.size()) {
+                throw runtime_error("Instruction for unknown process " + to_string(pid) + ": " + line);
+            }
+            owner = pid;
+        }
+        processLines[owner].push_back(lines.size());
+        lines.push_back(line);
     }
-    uint32_t frame = availableFrames.front();
-    availableFrames.pop_front();
-    return frame;
-}
-
-void Process::returnAFrame(uint32_t frame) {
-    availableFrames.push_back(frame);
-}
-
-double Process::getTLBHitRate() const {
-    return memoryAccessAttempts > 0 ? static_cast<double>(tlbHits) / memoryAccessAttempts : 0.0;
-}
-
-double Process::getPageTableHitRate() const {
-    return tlbMisses > 0 ? static_cast<double>(pageTableHits) / tlbMisses : 0.0;
-}
-
-PageTable* Process::getPageTable() const {
-    return pageTable;
-}
-
-void Process::displayStatistics() const {
-    cout << "Process " << id << " Statistics:" << endl;
-    // cout << "  Memory Access Attempts: " << memoryAccessAttempts << endl;
-    cout << "  Memory Access Attempts: " << std::dec << memoryAccessAttempts << endl;
-    cout << "  TLB Hit Rate: " << getTLBHitRate() * 100 << "%" << endl;
-    cout << "  Page Table Hit Rate: " << getPageTableHitRate() * 100 << "%" << endl;
-    cout << endl;
-}
-
-class Simulator {
-private:
-    map<uint32_t, Process> processTable;
-    PhysicalFrameManager pfManager;
-    TLB tlb;
-    uint32_t currentProcessId;
-    uint32_t physicalFrames;
-    uint32_t pageSize;
-    uint32_t tlbSize;
-    uint32_t offsetBits;
-    uint32_t getPhysicalMemory();
-    Process& getCurrentProcess();
-    bool createProcess(uint32_t pid, uint32_t numPages);
-    uint32_t translateVirtualAddress(uint32_t virtualAddress);
-    uint32_t getPagesFromBytes(uint32_t size) const;
-
-public:
-    Simulator(uint32_t addressBits, uint32_t pageSize, uint32_t numFrames, uint32_t tlbSize, const vector<uint32_t>& processMemSizes);
-    void accessMemory(uint32_t virtualAddress);
-    void switchProcess(uint32_t pid);
-    void allocateMemory(uint32_t sizeInBytes);
-    void freeMemory(uint32_t virtualAddress);
-    bool handlePageFault(uint32_t vpn);
-    const map<uint32_t, Process>& getProcessTable();
-};
-
-const map<uint32_t, Process>& Simulator::getProcessTable() {
-    return processTable;
-}
-
-uint32_t Simulator::getPhysicalMemory(){
-    return pageSize * physicalFrames;
-}
-
-Process& Simulator::getCurrentProcess() {
-    return processTable.at(currentProcessId);
-}
 
-uint32_t Simulator::getPagesFromBytes(uint32_t size) const {
-    return (size + pageSize - 1) / pageSize;
-}
-
-bool Simulator::handlePageFault(uint32_t vpn) {
-    // Get the current process's page table
-    Process process = processTable.at(currentProcessId);
-    PageTable* pageTable = process.getPageTable();
-
-    // Use PageTable's isValidRange function to check if the VPN is valid
-    if (!pageTable->isValidRange(vpn)) {
-        cerr << "Invalid VPN: " << vpn << ". Out of range." << endl;
-        return false;
+    // Balance the workers by instruction count, busiest processes first
+    vector<uint32_t> pids;
+    for (uint32_t pid = 0; pid < processPages.size(); pid++) {
+        pids.push_back(pid);
     }
-
-    // Try to allocate a new frame for the page
-    int newFrame = process.getAFrame();
-    if (newFrame != -1) {
-        // Free frame available, update page table with new mapping
-        pageTable->updatePageTable(vpn, newFrame, true, false, true, true, true, 0);
-        cout << "Page fault handled. Assigned new frame " << newFrame << " to VPN " << vpn << endl;
-        return true;
-    } else {
-        // No free frames, attempt page replacement using the Clock Algorithm
-        bool replaced = pageTable->replacePageUsingClockAlgo(vpn);
-
-        if (replaced) {
-            cout << "Page fault handled by page replacement for VPN " << vpn << endl;
-            return true;
-        } else {
-            cerr << "Error: Failed to handle page fault for VPN " << vpn << " - page replacement failed." << endl;
-            return false;
-        }
+    stable_sort(pids.begin(), pids.end(), [&](uint32_t a, uint32_t b) { return processLines[a].size() > processLines[b].size(); });
+    threadCount = min<uint32_t>(threadCount, max<size_t>(pids.size(), 1));
+    vector<vector<uint32_t>> workerPids(threadCount);
+    vector<size_t> workerLoad(threadCount, 0);
+    for (uint32_t pid : pids) {
+        size_t worker = min_element(workerLoad.begin(), workerLoad.end()) - workerLoad.begin();
+        workerPids[worker].push_back(pid);
+        workerLoad[worker] += processLines[pid].size();
     }
-}
-
 
-uint32_t Simulator::translateVirtualAddress(uint32_t virtualAddress) {
-    // Get the current process
-    Process& process = processTable.at(currentProcessId);
-    process.incrementMemoryAccess();
-
-    // Constants for address components based on page size
-    const int pageOffsetBits = offsetBits;
-    const uint32_t pageOffsetMask = pageSize - 1;
-
-    // Calculate VPN (Virtual Page Number) and offset within the page
-    uint32_t vpn = virtualAddress >> pageOffsetBits;
-    uint32_t offset = virtualAddress & pageOffsetMask;
-
-    // 1. Check the TLB first for the VPN
-    int pfn = tlb.lookupTLB(vpn);
-    if (pfn != -1) {
-        // TLB hit - construct the physical address
-        process.incrementTLBHit();
-        cout << "TLB hit for VPN " << vpn << ", PFN: " << pfn << endl;
-        return (pfn << pageOffsetBits) | offset;
-    } else {
-        // TLB miss - increment TLB miss counter for this process
-        process.incrementTLBMiss();
+    vector<string> output(lines.size());
+    vector<string> errorOutput(lines.size());
+    unique_ptr<atomic<bool>[]> ready(new atomic<bool>[lines.size()]());
+    atomic<size_t> firstFailure(SIZE_MAX);
+    vector<exception_ptr> failures(threadCount);
+    vector<size_t> failureIndex(threadCount, SIZE_MAX);
+    vector<unique_ptr<Simulator>> workers(threadCount);
+    vector<thread> threads;
+    for (uint32_t w = 0; w < threadCount; w++) {
+        threads.emplace_back([&, w]() {
+            ostringstream discard;
+            logStream = &discard;
+            errorStream = &discard;
+            workers[w] = makeSimulator();
+            sort(workerPids[w].begin(), workerPids[w].end());
+            for (uint32_t pid : workerPids[w]) {
+                workers[w]->createProcess(pid, processPages[pid]);
+            }
+            for (uint32_t pid : workerPids[w]) {
+                for (size_t index : processLines[pid]) {
+                    // Serial replay would have stopped at an earlier failure
+                    if (index > firstFailure.load()) {
+                        return;
+                    }
+                    ostringstream out;
+                    ostringstream err;
+                    logStream = &out;
+                    errorStream = &err;
+                    out << "Execute instruction: " << lines[index] << endl;
+                    try {
+                        executeInstruction(*workers[w], lines[index]);
+                        out << "----------" << endl;
+                    } catch (...) {
+                        failures[w] = current_exception();
+                        failureIndex[w] = index;
+                        size_t expected = firstFailure.load();
+                        while (index < expected && !firstFailure.compare_exchange_weak(expected, index)) {
+                        }
+                    }
+                    output[index] = out.str();
+                    errorOutput[index] = err.str();
+                    ready[index].store(true, memory_order_release);
+                    if (failures[w]) {
+                        return;
+                    }
+                }
+            }
+        });
     }
 
-    // 2. TLB miss - check the page table
-    PageTable* pageTable = process.getPageTable();
-    pfn = pageTable->lookupPageTable(vpn);
-    if (pfn != -1) {
-        // Page table hit - update TLB and return physical address
-        process.incrementPageTableHit();
-        cout << "Page table hit for VPN " << vpn << ", PFN: " << pfn << endl;
-        tlb.updateTLB(vpn, pfn, true, true, true); // Update TLB with permissions as needed
-        return (pfn << pageOffsetBits) | offset;
-    } else {
-        // Page table miss - increment page table miss counter for this process
-        process.incrementPageTableMiss();
+    // Write the output back in trace order while the workers run
+    for (size_t index = 0; index < lines.size(); index++) {
+        while (!ready[index].load(memory_order_acquire)) {
+            this_thread::yield();
+        }
+        cout << output[index];
+        cerr << errorOutput[index];
+        string().swap(output[index]);
+        string().swap(errorOutput[index]);
+        if (index == firstFailure.load()) {
+            break;
+        }
     }
-
-
-    // 3. Page fault - Handle page fault
-    cout << "Page fault for VPN " << vpn << endl;
-    if (!handlePageFault(vpn)) {
-        cerr << "Error: Unable to handle page fault for VPN " << vpn << endl;
-        return UINT32_MAX; // Return an error if page fault handling fails
+    for (thread& worker : threads) {
+        worker.join();
     }
-
-    // Retry after handling page fault
-    pfn = pageTable->lookupPageTable(vpn);
-    if (pfn != -1) {
-        tlb.updateTLB(vpn, pfn, true, true, true); // Update TLB after page fault resolution
-        return (pfn << pageOffsetBits) | offset;
+    // Report the failure serial replay would have hit first
+    for (uint32_t w = 0; w < threadCount; w++) {
+        if (failures[w] && failureIndex[w] == firstFailure.load()) {
+            rethrow_exception(failures[w]);
+        }
+    }
+    for (uint32_t w = 0; w < threadCount; w++) {
+        simulator.mergeFrom(*workers[w], workerPids[w]);
     }
-
-    // If we still can't resolve the address, return an error
-    cerr << "Error: Failed to translate virtual address " << virtualAddress << endl;
-    return UINT32_MAX;
 }
 
-Simulator::Simulator(uint32_t addressBits, uint32_t pageSize, uint32_t numFrames,
-                     uint32_t tlbSize, const vector<uint32_t>& processMemSizes) : processTable(), pfManager(PhysicalFrameManager(numFrames)), tlb(TLB(tlbSize)), currentProcessId(-1), physicalFrames(numFrames), pageSize(pageSize), tlbSize(tlbSize), offsetBits(int(log(pageSize)/log(2))) {
-
-    // Create processes
-    for (uint32_t i = 0; i < processMemSizes.size(); i++) {
-        uint32_t memSize = processMemSizes[i];
-        uint32_t numPages = static_cast<uint32_t>(ceil(static_cast<double>(memSize) / pageSize));
+// Replay the trace under the event-driven scheduler. Every process's instructions form their own stream,
+// consumed through a cursor whenever the scheduler runs the process, so switch lines are left out
+static void replayEventDriven(Simulator& simulator, Scheduler& scheduler, const string& traceFile, uint64_t instructionTime) {
+    ifstream inFile(traceFile);
+    if (!inFile) {
+        throw runtime_error("Cannot open instruction file " + traceFile);
+    }
+    map<uint32_t, vector<string>> processLines;
+    map<uint32_t, size_t> cursors;
+    string line;
+    while (getline(inFile, line)) {
+        istringstream iss(line);
+        uint32_t pid;
+        string command;
+        if (iss >> pid >> command && command != "switch") {
+            processLines[pid].push_back(line);
+        }
+    }
 
-        // NOTE: Here we only check if physical memory is enough for every single process
-        if (numPages > numFrames) {
-            throw runtime_error("Not enough physical memory for process " + to_string(i));
+    for (const auto& [pid, process] : simulator.getProcessTable()) {
+        scheduler.addProcess(pid);
+    }
+    uint32_t pid;
+    uint32_t contextPid = -1; // Process the simulator runs, its TLB is flushed when another one is dispatched
+    while (scheduler.pickNext(pid)) {
+        const vector<string>& lines = processLines[pid];
+        size_t& cursor = cursors[pid];
+        if (cursor == lines.size()) {
+            scheduler.finish();
+            continue;
         }
-        list<uint32_t> frames;
-        int preAllocatedFrames = 8; // TODO: Make it configurable
-        for (uint32_t j = 0; j < preAllocatedFrames; j++) {
-            frames.push_back(pfManager.allocateFrame());
+        if (pid != contextPid) {
+            simulator.switchProcess(pid);
+            contextPid = pid;
         }
-        Process process(i, addressBits, pageSize, numPages, frames);
 
-        //manually pre-allocate some frames for process
-        PageTable* pageTable = process.getPageTable();
-        uint32_t vpn = 0;
-        for (uint32_t k = 0; k < preAllocatedFrames; k++) {
-            int frame = process.getAFrame();
-            pageTable->updatePageTable(vpn, frame, true, false, true, true, true, 0);
-            vpn++;
+        const string& instruction = lines[cursor++];
+        cout << "Execute instruction at " << scheduler.getClock() << " ns: " << instruction << endl;
+        executeInstruction(simulator, instruction);
+        uint64_t cpuTime;
+        uint64_t ioTime;
+        simulator.takeFaultLatency(cpuTime, ioTime);
+        scheduler.runInstruction(instructionTime + cpuTime);
+
+        // A forked or spawned child runs from the next scheduling decision on
+        istringstream iss(instruction);
+        uint32_t parentPid;
+        string command;
+        uint32_t childPid;
+        if (iss >> parentPid >> command >> childPid && (command == "fork" || command == "spawn")
+            && simulator.getProcessTable().contains(childPid) && !scheduler.hasProcess(childPid)) {
+            scheduler.addProcess(childPid);
+        }
+        if (ioTime > 0) {
+            cout << "Process " << pid << " blocked on swap I/O until " << scheduler.block(ioTime) << " ns" << endl;
         }
-        processTable.insert({i, std::move(process)});
+        cout << "----------" << endl;
     }
-    cout << "Virtual memory simulator created with page size " << pageSize << ", physical memory " << getPhysicalMemory() << endl;
-    cout << "==========" << endl;
-}
 
-void Simulator::accessMemory(uint32_t virtualAddress) {
-    uint32_t physicalAddress = translateVirtualAddress(virtualAddress);
-    if (physicalAddress != UINT32_MAX) {
-        cout << "Translated Virtual Address " << std::hex << virtualAddress
-                << " to Physical Address " << physicalAddress << std::dec << endl;
-    } else {
-        cerr << "Error: Translation failed for Virtual Address " << std::hex << virtualAddress << std::dec << endl;
+    for (const auto& [pid, lines] : processLines) {
+        if (cursors[pid] < lines.size()) {
+            cerr << "Warning: process " << pid << " never ran, " << lines.size() - cursors[pid] << " instructions not replayed" << endl;
+        }
     }
 }
 
-void Simulator::switchProcess(uint32_t pid){
-    cout << "Switched current process to " << pid << endl;
-    currentProcessId = pid;
-    tlb.flush();
-    // TODO: better if we can check TLB status
+// Per-access counters of all processes, the boundaries of a sampled window
+static SampleWindow countAccesses(Simulator& simulator) {
+    ProcessCounters processes = simulator.getProcessCounters();
+    SampleWindow counters;
+    counters.accesses = processes.memoryAccesses;
+    counters.tlbHits = processes.tlbHits;
+    counters.faults = processes.pageFaults;
+    return counters;
 }
 
-void Simulator::allocateMemory(uint32_t sizeInBytes){
-    int requestedPages = getPagesFromBytes(sizeInBytes);
-    Process process = getCurrentProcess();
-    uint32_t quota = process.getAllocationQuota();
-    if (requestedPages > quota) {
-        cout << "Requested memory exceeds maximum memory for the process: " << process.getMaxFrames() << endl;
-        return;
+// Sampled replay: the trace is split into intervals, and a window at the start of each interval is simulated
+// in detail after warmup detailed instructions at the end of the previous one. Everything else is
+// fast-forwarded without output. With SimPoint clusters, a first pass over the trace picks the intervals
+// whose windows are simulated, the others are fast-forwarded entirely
+static void replaySampled(Simulator& simulator, SampleStats& stats, const string& traceFile, uint64_t window,
+                          uint64_t interval, uint64_t warmup, uint32_t simpointClusters, uint32_t offsetBits) {
+    ifstream inFile(traceFile);
+    if (!inFile) {
+        throw runtime_error("Cannot open instruction file " + traceFile);
     }
-    uint32_t frames = pfManager.getFreeFrames();
-    if (requestedPages > frames) {
-        cout << "Requested memory exceeds available physical memory: " << frames << " frames" << endl;
-        return;
+    string line;
+
+    // Weight of every interval's window, periodic sampling measures them all equally
+    vector<double> weights;
+    if (simpointClusters > 0) {
+        SimPoint simpoint(interval);
+        while (getline(inFile, line)) {
+            istringstream iss(line);
+            uint32_t pid;
+            string command;
+            string operand;
+            if (iss >> pid >> command >> operand && command.substr(0, 6) == "access") {
+                simpoint.recordAccess(pid, stoul(operand, nullptr, 16) >> offsetBits);
+            }
+            simpoint.completeInstruction();
+        }
+        for (const SimPoint::Choice& choice : simpoint.choose(simpointClusters)) {
+            weights.resize(choice.interval + 1, 0);
+            weights[choice.interval] = choice.weight;
+        }
+        inFile.clear();
+        inFile.seekg(0);
     }
-    list<uint32_t> allocatedFrames;
-    for (uint32_t i = 0; i < requestedPages; i++) {
-        allocatedFrames.push_back(pfManager.allocateFrame());
+    auto weightOf = [&](uint64_t index) { return simpointClusters == 0 ? 1.0 : index < weights.size() ? weights[index] : 0.0; };
+
+    // A stream without buffer fails every write before formatting it, so fast-forwarded output costs nothing
+    ostream quiet(nullptr);
+    ostream* detailedLog = logStream;
+    SampleWindow start;
+    bool measuring = false;
+    uint64_t index = 0;
+    while (getline(inFile, line)) {
+        uint64_t current = index / interval;
+        uint64_t offset = index % interval;
+        bool measured = offset < window && weightOf(current) > 0;
+        bool warming = !measured && warmup > 0 && offset >= interval - warmup && weightOf(current + 1) > 0;
+        if (measured && offset == 0) {
+            start = countAccesses(simulator);
+            start.start = index;
+            start.weight = weightOf(current);
+            measuring = true;
+        }
+
+        if (measured || warming) {
+            cout << "Execute instruction: " << line << endl;
+            executeInstruction(simulator, line);
+            cout << "----------" << endl;
+        } else {
+            logStream = &quiet;
+            executeInstruction(simulator, line, true);
+            logStream = detailedLog;
+        }
+        stats.countInstruction(measured || warming);
+        index++;
+
+        if (measuring && (offset == window - 1 || inFile.peek() == EOF)) {
+            SampleWindow end = countAccesses(simulator);
+            end.start = start.start;
+            end.weight = start.weight;
+            end.accesses -= start.accesses;
+            end.tlbHits -= start.tlbHits;
+            end.faults -= start.faults;
+            stats.addWindow(end);
+            measuring = false;
+        }
     }
-    process.allocateMemory(allocatedFrames);
-    cout << "Allocated " << requestedPages << " pages for process " << process.getPid() << endl;
 }
 
-void Simulator::freeMemory(uint32_t virtualAddress){
-    Process process = getCurrentProcess();
-    uint32_t vpn = virtualAddress >> offsetBits;
-    if (!process.getPageTable()->isValidRange(vpn)) {
-        cout << "Virtual address is out of range: " << virtualAddress << ", vpn: " << vpn << endl;
-        return;
+// Replay a workload generated in process. Its instructions are not printed, only the statistics at the
+// end, so long workloads run at the simulator's speed; they can be written to a trace file instead
+static void replayWorkload(Simulator& simulator, SyntheticWorkload& workload, const string& tracePath) {
+    ofstream traceFile;
+    if (!tracePath.empty()) {
+        traceFile.open(tracePath);
+        if (!traceFile) {
+            throw runtime_error("Cannot open trace file " + tracePath);
+        }
     }
-    int pfn = process.getPageTable()->removeAddressForOneEntry(vpn);
-    if (pfn == -1) {
-        cout << "Virtual address for memory free is not found in page table: " << pfn << endl;
-        return;
+    ostream quiet(nullptr);
+    ostream* detailedLog = logStream;
+    logStream = &quiet;
+    vector<TraceOp> ops(4096);
+    size_t count;
+    while ((count = workload.next(ops.data(), ops.size())) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            if (traceFile.is_open()) {
+                traceFile << formatInstruction(ops[i]) << '\n';
+            }
+            executeOperation(simulator, ops[i]);
+            simulator.completeInstruction();
+        }
     }
-    pfManager.freeAFrame(pfn);
-    process.freeMemory(pfn);
-    tlb.deleteTLB(vpn);
+    logStream = detailedLog;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc < 3) {
-        cerr << "Usage: " << argv[0] << "<page_size> <virtual_address_len> <physical_memory> <tlb_size> <process_memory_sizes> <instruction_file>" << endl;
+    // Split optional "--name=value" flags from the positional arguments
+    map<string, string> options;
+    vector<string> args;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.rfind("--", 0) == 0) {
+            size_t eq = arg.find('=');
+            options[arg.substr(2, eq == string::npos ? string::npos : eq - 2)] = eq == string::npos ? "" : arg.substr(eq + 1);
+        } else {
+            args.push_back(arg);
+        }
+    }
+
+    if (args.size() < 5) {
+        cerr << "Usage: " << argv[0] << " [options] <page_size> <virtual_address_len> <physical_memory> <tlb_size> <process_memory_sizes> <instruction_file>[,<instruction_file>...]" << endl;
+        cerr << "Several comma-separated instruction files are replayed on as many CPUs, one instruction per CPU in turn" << endl;
+        cerr << "With --workload, instructions are generated in process and the instruction file is left out" << endl;
+        cerr << "Options:" << endl;
+        cerr << "  --watermarks=<min>:<low>:<high>  Free-frame reclaim watermarks, in frames" << endl;
+        cerr << "  --kswapd-interval=<accesses>     Run background reclaim every N accesses while below the low watermark" << endl;
+        cerr << "  --zswap-frames=<frames>          Reserve frames for a compressed swap pool in front of the swap file" << endl;
+        cerr << "  --page-compressibility=<percent> Share of synthetic page contents that compresses well (default 50)" << endl;
+        cerr << "  --tiers=<frames>:<ns>,...         Split physical memory into tiers, fastest first, with their access latency" << endl;
+        cerr << "  --tier-scan-interval=<accesses>  Accesses between hot/cold page migration scans (default 1000)" << endl;
+        cerr << "  --tier-migrate-limit=<pages>     Maximum pages migrated per scan (default 16)" << endl;
+        cerr << "  --tier-promote-threshold=<n>     Decayed access count needed to promote a page (default 4)" << endl;
+        cerr << "  --numa-nodes=<frames>,...         Split physical memory into NUMA nodes" << endl;
+        cerr << "  --numa-policy=<policy>,...        Placement policy by pid: first-touch, interleave, preferred:<node>, bind:<node>" << endl;
+        cerr << "  --numa-home=<node>,...            Node each process runs on, by pid (default pid % nodes)" << endl;
+        cerr << "  --numa-latency=<local>:<remote>  Local and remote access latency in ns (default 80:140)" << endl;
+        cerr << "  --numa-balance=<accesses>        Migrate a page to its accessor's node after N remote accesses (default 0, off)" << endl;
+        cerr << "  --shared-code                    Map one read-only copy of each code page into every process" << endl;
+        cerr << "  --shootdown-batch=<pages>        Batch TLB shootdowns per operation, flushing the whole TLB above N pages (default 0, off)" << endl;
+        cerr << "  --lazy-tlb                       Skip shootdown IPIs to CPUs no longer running the process" << endl;
+        cerr << "  --page-table=<two-level|hashed>  Page table backend, hashed is one inverted table sized to physical memory" << endl;
+        cerr << "  --unmap-flush-ceiling=<pages>    Flush whole TLBs when a free unmaps more than N pages (default 33)" << endl;
+        cerr << "  --shootdown-cost=<send>:<handle> Cycles to send a shootdown IPI and to handle one (default 2000:1000)" << endl;
+        cerr << "  --partition-frames               Give every process a fixed partition of frames sized by its memory quota" << endl;
+        cerr << "  --replay-threads=<threads>       Replay processes on worker threads, implies --partition-frames (default 1)" << endl;
+        cerr << "  --cycle-costs=<tlb>:<walk>:<memory>:<minor>:<pool>:<major>:<write_back> Cycles per event on the access path (default 1:100:100:2000:10000:300000:300000)" << endl;
+        cerr << "  --caches=<bytes>:<ways>,...       Physically indexed caches fed with data accesses and PTE fetches, L1 first" << endl;
+        cerr << "  --cache-line=<bytes>             Cache line size (default 64)" << endl;
+        cerr << "  --cache-inclusion=<policy>       non-inclusive, inclusive or exclusive (default non-inclusive)" << endl;
+        cerr << "  --page-coloring                  Give faulting pages frames whose cache color matches their VPN" << endl;
+        cerr << "  --event-driven                   Schedule processes on a simulated clock, blocking them on swap reads" << endl;
+        cerr << "  --fault-latency=<swap>:<pool>:<zero> Swap read, compressed pool load and zero-fill latency in ns (default 100000:3000:500)" << endl;
+        cerr << "  --time-slice=<ns>                Scheduler time slice (default 100000)" << endl;
+        cerr << "  --sched-cost=<instruction>:<switch> Time per instruction and per context switch in ns (default 100:2000)" << endl;
+        cerr << "  --heat-profile                   Track per-page heat with a count-min sketch and a top-K per process" << endl;
+        cerr << "  --heat-sketch=<width>:<depth>    Count-min sketch size (default 1024:4)" << endl;
+        cerr << "  --heat-top=<k>                   Hottest pages tracked per process (default 16)" << endl;
+        cerr << "  --heat-decay=<accesses>          Halve the heat of a process every N of its accesses (default 0, off)" << endl;
+        cerr << "  --heat-region=<pages>            Pages per region of the heat map (default 512)" << endl;
+        cerr << "  --interval-stats=<file>          Write per-process counters every window to a CSV file, or JSON for a .json file" << endl;
+        cerr << "  --interval=<instructions>        Window length in trace instructions (default 10000)" << endl;
+        cerr << "  --interval-cycles=<cycles>       Window length in simulated cycles instead" << endl;
+        cerr << "  --interval-buffer=<samples>      Samples buffered before they are written out (default 4096)" << endl;
+        cerr << "  --sample-window=<instructions>   Simulate this many instructions of every interval in detail, fast-forward the rest" << endl;
+        cerr << "  --sample-interval=<instructions> Instructions from one sample window to the next (default 10 windows)" << endl;
+        cerr << "  --sample-warmup=<instructions>   Detailed but unmeasured instructions before each window (default 0)" << endl;
+        cerr << "  --simpoints=<clusters>           Only simulate the windows of representative intervals chosen by clustering" << endl;
+        cerr << "  --checkpoint=<file>              Snapshot the simulator state to a file during the replay" << endl;
+        cerr << "  --checkpoint-at=<instruction>    Trace instructions replayed before the snapshot is taken (default 0)" << endl;
+        cerr << "  --restore=<file>                 Start from a snapshot and resume the trace after its instruction" << endl;
+        cerr << "  --workload=<model>,...           Generate the instructions, a model by pid: mixed[:<locality>], strided[:<stride>]," << endl;
+        cerr << "                                   pointer-chase[:<node_bytes>], graph[:<degree>] or key-value[:<value_bytes>[:<skew>]]" << endl;
+        cerr << "  --workload-instructions=<n>      Instructions generated (default 1000000)" << endl;
+        cerr << "  --workload-seed=<n>              Seed of the workload (default 1)" << endl;
+        cerr << "  --workload-switch=<probability>  Chance of a process switch before every step (default 0.01)" << endl;
+        cerr << "  --workload-zipf=<exponent>       Zipf exponent of allocation and free sizes, in pages (default 2)" << endl;
+        cerr << "  --workload-writes=<share>        Share of heap accesses that are writes (default 0.3)" << endl;
+        cerr << "  --workload-trace=<file>          Also write the generated instructions to a trace file" << endl;
+        cerr << "  --profile-sample=<n>             Time every Nth call of each profiled stage (default 1), needs a VMSIM_PROFILE build" << endl;
+        cerr << "  --profile-json=<file>            Also write the simulator profile as JSON, needs a VMSIM_PROFILE build" << endl;
         return 1;
     }
 
-    const uint32_t PAGE_SIZE = stoul(argv[1]);
-    const uint32_t VA_LEN = stoul(argv[2]);
-    const uint32_t PHYSICAL_MEM = stoul(argv[3]);
+    const uint32_t PAGE_SIZE = stoul(args[0]);
+    const uint32_t VA_LEN = stoul(args[1]);
+    const uint32_t PHYSICAL_MEM = stoul(args[2]);
     const uint32_t PHYSICAL_FRAMES = PHYSICAL_MEM / PAGE_SIZE;
-    const uint32_t TLB_SIZE = stoul(argv[4]);
+    const uint32_t TLB_SIZE = stoul(args[3]);
 
-    // Get process memory sizes from user
+    // Get process memory sizes from user, a generated workload has no instruction file after them
+    bool workloadMode = options.count("workload") > 0;
+    size_t cpuCount = workloadMode ? 1 : splitList(args.back(), ',').size();
     vector<uint32_t> processMemSizes;
-    for (int i = 5; i < argc - 1; i++) {
-        processMemSizes.push_back(stoul(argv[i]));
+    for (size_t i = 4; i < (workloadMode ? args.size() : args.size() - 1); i++) {
+        processMemSizes.push_back(stoul(args[i]));
     }
     try {
-        Simulator simulator(VA_LEN, PAGE_SIZE, PHYSICAL_FRAMES, TLB_SIZE, processMemSizes);
+        string profileSample = takeOption(options, "profile-sample", "");
+        string profileJson = takeOption(options, "profile-json", "");
+#ifdef VMSIM_PROFILE
+        Profiler::setSamplePeriod(stoul(profileSample.empty() ? "1" : profileSample));
+#else
+        if (!profileSample.empty() || !profileJson.empty()) {
+            throw runtime_error("Profiling options require a build with VMSIM_PROFILE defined");
+        }
+#endif
+        string workloadModels = takeOption(options, "workload", "");
+        string workloadInstructions = takeOption(options, "workload-instructions", "");
+        string workloadSeed = takeOption(options, "workload-seed", "");
+        string workloadSwitch = takeOption(options, "workload-switch", "");
+        string workloadZipf = takeOption(options, "workload-zipf", "");
+        string workloadWrites = takeOption(options, "workload-writes", "");
+        string workloadTrace = takeOption(options, "workload-trace", "");
+        if (!workloadMode && (!workloadInstructions.empty() || !workloadSeed.empty() || !workloadSwitch.empty()
+                              || !workloadZipf.empty() || !workloadWrites.empty() || !workloadTrace.empty())) {
+            throw runtime_error("Workload options require --workload");
+        }
+        bool partitionFrames = takeFlag(options, "partition-frames");
+        string intervalStatsPath = takeOption(options, "interval-stats", "");
+        string intervalOption = takeOption(options, "interval", "");
+        string intervalCyclesOption = takeOption(options, "interval-cycles", "");
+        uint32_t intervalBuffer = stoul(takeOption(options, "interval-buffer", "4096"));
+        if (intervalStatsPath.empty() && (!intervalOption.empty() || !intervalCyclesOption.empty())) {
+            throw runtime_error("Interval options require --interval-stats");
+        }
+        uint64_t sampleWindow = stoull(takeOption(options, "sample-window", "0"));
+        string sampleIntervalOption = takeOption(options, "sample-interval", "");
+        string sampleWarmupOption = takeOption(options, "sample-warmup", "");
+        uint32_t simpointClusters = stoul(takeOption(options, "simpoints", "0"));
+        if (sampleWindow == 0 && (!sampleIntervalOption.empty() || !sampleWarmupOption.empty() || simpointClusters > 0)) {
+            throw runtime_error("Sampling options require --sample-window");
+        }
+        uint64_t sampleInterval = sampleIntervalOption.empty() ? sampleWindow * 10 : stoull(sampleIntervalOption);
+        uint64_t sampleWarmup = stoull(sampleWarmupOption.empty() ? "0" : sampleWarmupOption);
+        string checkpointPath = takeOption(options, "checkpoint", "");
+        string checkpointAtOption = takeOption(options, "checkpoint-at", "");
+        string restorePath = takeOption(options, "restore", "");
+        if (checkpointPath.empty() && !checkpointAtOption.empty()) {
+            throw runtime_error("--checkpoint-at requires --checkpoint");
+        }
+        uint64_t checkpointAt = stoull(checkpointAtOption.empty() ? "0" : checkpointAtOption);
+        uint32_t replayThreads = stoul(takeOption(options, "replay-threads", "1"));
+        bool eventDriven = takeFlag(options, "event-driven");
+        string faultLatencyOption = takeOption(options, "fault-latency", "");
+        string timeSliceOption = takeOption(options, "time-slice", "");
+        string schedCostOption = takeOption(options, "sched-cost", "");
+        if (!eventDriven && (!faultLatencyOption.empty() || !timeSliceOption.empty() || !schedCostOption.empty())) {
+            throw runtime_error("Scheduler options require --event-driven");
+        }
+        vector<uint32_t> faultLatency = parseColonList(faultLatencyOption.empty() ? "100000:3000:500" : faultLatencyOption);
+        vector<uint32_t> schedCost = parseColonList(schedCostOption.empty() ? "100:2000" : schedCostOption);
+        if (faultLatency.size() != 3) {
+            throw runtime_error("Fault latency must be given as <swap_read_ns>:<pool_load_ns>:<zero_fill_ns>");
+        }
+        if (schedCost.size() != 2) {
+            throw runtime_error("Scheduler cost must be given as <instruction_ns>:<switch_ns>");
+        }
+        if (eventDriven && (replayThreads > 1 || cpuCount > 1)) {
+            throw runtime_error("Event-driven replay runs one trace on one CPU, without replay threads");
+        }
+        vector<uint32_t> processPages;
+        for (uint32_t size : processMemSizes) {
+            processPages.push_back(static_cast<uint32_t>(ceil(static_cast<double>(size) / PAGE_SIZE)));
+        }
+        vector<uint32_t> shootdownCost = parseColonList(takeOption(options, "shootdown-cost", "2000:1000"));
+        if (shootdownCost.size() != 2) {
+            throw runtime_error("Shootdown cost must be given as <send_cycles>:<handle_cycles>");
+        }
+        Simulator simulator(VA_LEN, PAGE_SIZE, PHYSICAL_FRAMES, TLB_SIZE);
+        simulator.setCpuCount(cpuCount, stoul(takeOption(options, "shootdown-batch", "0")),
+                              takeFlag(options, "lazy-tlb"), shootdownCost[0], shootdownCost[1]);
+        configureSimulator(simulator, options);
+        if (replayThreads > 1 && simulator.hasHashedPageTable()) {
+            throw runtime_error("The hashed page table is shared by every process, it needs a replay without replay threads");
+        }
+        if (partitionFrames || replayThreads > 1) {
+            simulator.setFramePartitions(processPages);
+        }
+        if (!intervalStatsPath.empty()) {
+            if (replayThreads > 1) {
+                throw runtime_error("Interval statistics need a serial replay, without replay threads");
+            }
+            if (!intervalOption.empty() && !intervalCyclesOption.empty()) {
+                throw runtime_error("Windows are either --interval instructions or --interval-cycles long");
+            }
+            uint64_t cycles = intervalCyclesOption.empty() ? 0 : stoull(intervalCyclesOption);
+            uint64_t instructions = cycles > 0 ? 0 : stoull(intervalOption.empty() ? "10000" : intervalOption);
+            simulator.enableIntervalStats(intervalStatsPath, instructions, cycles, intervalBuffer);
+        }
 
-        // Parse instruction file
-        ifstream inFile(argv[argc - 1]);
-        if (!inFile) {
-            throw runtime_error("Cannot open instruction file");
+        if ((!checkpointPath.empty() || !restorePath.empty())
+            && (eventDriven || replayThreads > 1 || cpuCount > 1 || sampleWindow > 0)) {
+            throw runtime_error("Checkpoints are taken and restored in a serial replay of one trace, without event-driven scheduling, replay threads or sampling");
         }
 
-        string line;
-        while (getline(inFile, line)) {
-            istringstream iss(line);
-            uint32_t pid;
-            string command;
+        if (workloadMode && (eventDriven || replayThreads > 1 || sampleWindow > 0 || !checkpointPath.empty() || !restorePath.empty())) {
+            throw runtime_error("A generated workload is replayed serially on one CPU, without event-driven scheduling, replay threads, sampling or checkpoints");
+        }
 
-            iss >> pid >> command;
+        unique_ptr<SampleStats> sampleStats;
+        if (sampleWindow > 0) {
+            if (eventDriven || replayThreads > 1 || cpuCount > 1 || !intervalStatsPath.empty()) {
+                throw runtime_error("Sampled simulation replays one trace serially, without event-driven scheduling, replay threads or interval statistics");
+            }
+            sampleStats.reset(new SampleStats(sampleWindow, sampleInterval, sampleWarmup, simpointClusters > 0));
+        }
 
-            cout << "Execute instruction: " << line << endl;
-            if (command == "switch") {
-                simulator.switchProcess(pid);
+        unique_ptr<Scheduler> scheduler;
+        if (sampleStats) {
+            for (uint32_t i = 0; i < processPages.size(); i++) {
+                simulator.createProcess(i, processPages[i]);
             }
-            else if (command == "alloc") {
-                string hexSize;
-                iss >> hexSize;
-                uint32_t size = stoul(hexSize, nullptr, 16);
-                simulator.allocateMemory(size);
+            replaySampled(simulator, *sampleStats, args.back(), sampleWindow, sampleInterval, sampleWarmup,
+                          simpointClusters, getPageShift(PAGE_SIZE));
+        } else if (workloadMode) {
+            WorkloadOptions workloadOptions;
+            workloadOptions.instructions = stoull(workloadInstructions.empty() ? "1000000" : workloadInstructions);
+            workloadOptions.seed = stoull(workloadSeed.empty() ? "1" : workloadSeed);
+            workloadOptions.switchProbability = stod(workloadSwitch.empty() ? "0.01" : workloadSwitch);
+            workloadOptions.parameters.addressBits = VA_LEN;
+            workloadOptions.parameters.allocZipf = stod(workloadZipf.empty() ? "2" : workloadZipf);
+            workloadOptions.parameters.writeShare = stod(workloadWrites.empty() ? "0.3" : workloadWrites);
+            SyntheticWorkload workload(splitList(workloadModels, ','), processMemSizes, workloadOptions);
+            for (uint32_t i = 0; i < processPages.size(); i++) {
+                simulator.createProcess(i, processPages[i]);
             }
-            else if (command.substr(0, 6) == "access") {
-                string hexAddr;
-                iss >> hexAddr;
-                uint32_t addr = stoul(hexAddr, nullptr, 16);
-                simulator.accessMemory(addr);
+            replayWorkload(simulator, workload, workloadTrace);
+        } else if (eventDriven) {
+            simulator.setFaultLatency(faultLatency[0], faultLatency[1], faultLatency[2]);
+            scheduler.reset(new Scheduler(stoul(timeSliceOption.empty() ? "100000" : timeSliceOption), schedCost[1]));
+            for (uint32_t i = 0; i < processPages.size(); i++) {
+                simulator.createProcess(i, processPages[i]);
+            }
+            replayEventDriven(simulator, *scheduler, args.back(), schedCost[0]);
+        } else if (replayThreads > 1) {
+            // Workers are set up exactly like the main simulator, each one then creates its own processes
+            auto makeSimulator = [&]() {
+                unique_ptr<Simulator> worker(new Simulator(VA_LEN, PAGE_SIZE, PHYSICAL_FRAMES, TLB_SIZE));
+                configureSimulator(*worker, options);
+                worker->setFramePartitions(processPages);
+                return worker;
+            };
+            replayInParallel(simulator, makeSimulator, processPages, args.back(), replayThreads);
+        } else {
+            // A restored snapshot replaces process creation, its processes keep their own sizes
+            uint64_t resumeAfter = 0;
+            uint64_t savedTraceHash = 0;
+            if (!restorePath.empty()) {
+                resumeAfter = simulator.restoreCheckpoint(restorePath, savedTraceHash);
+                cout << "Restored checkpoint " << restorePath << ", resuming after instruction " << resumeAfter << endl;
+            } else {
+                for (uint32_t i = 0; i < processPages.size(); i++) {
+                    simulator.createProcess(i, processPages[i]);
+                }
             }
-            cout << "----------" << endl;
-        }
 
-        // Display statistics for each process after simulation
-        cout << "\n--- Process Statistics ---" << endl;
-        for (const auto& [pid, process] : simulator.getProcessTable()) {
-            process.displayStatistics();
-            if (process.getPageTable()) {
-                process.getPageTable()->displayStatistics();
+            // Parse instruction files, one stream per CPU
+            vector<ifstream> streams;
+            for (const string& file : splitList(args.back(), ',')) {
+                streams.emplace_back(file);
+                if (!streams.back()) {
+                    throw runtime_error("Cannot open instruction file " + file);
+                }
+            }
+
+            // Lines already replayed are hashed, so a snapshot can tell whether a restore uses the same trace
+            uint64_t replayed = 0;
+            uint64_t traceHash = 14695981039346656037ULL;
+            auto hashLine = [&traceHash](const string& line) {
+                for (char c : line) {
+                    traceHash = (traceHash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+                }
+                traceHash = (traceHash ^ '\n') * 1099511628211ULL;
+            };
+            string skipped;
+            while (replayed < resumeAfter && getline(streams[0], skipped)) {
+                hashLine(skipped);
+                replayed++;
+            }
+            if (!restorePath.empty() && (replayed < resumeAfter || traceHash != savedTraceHash)) {
+                throw runtime_error("Instruction file " + args.back() + " does not start with the instructions of checkpoint " + restorePath);
+            }
+            if (!checkpointPath.empty() && checkpointAt < resumeAfter) {
+                throw runtime_error("The checkpoint at " + to_string(checkpointAt) + " comes before the restored one at " + to_string(resumeAfter));
             }
+            auto checkpointIfDue = [&]() {
+                if (!checkpointPath.empty() && replayed == checkpointAt) {
+                    simulator.saveCheckpoint(checkpointPath, replayed, traceHash);
+                    cout << "Saved checkpoint " << checkpointPath << " after instruction " << replayed << endl;
+                }
+            };
+            checkpointIfDue();
+
+            // Replay the streams in lockstep until all of them are exhausted, reusing one line buffer
+            bool running = true;
+            string line;
+            while (running) {
+                running = false;
+                for (uint32_t cpu = 0; cpu < streams.size(); cpu++) {
+                    if (!getline(streams[cpu], line)) {
+                        continue;
+                    }
+                    running = true;
+                    simulator.setCurrentCpu(cpu);
+                    if (streams.size() > 1) {
+                        cout << "Execute instruction on CPU " << cpu << ": " << line << endl;
+                    } else {
+                        cout << "Execute instruction: " << line << endl;
+                    }
+                    executeInstruction(simulator, line);
+                    cout << "----------" << endl;
+                    if (!checkpointPath.empty()) {
+                        hashLine(line);
+                        replayed++;
+                        checkpointIfDue();
+                    }
+                }
+            }
+            if (!checkpointPath.empty() && replayed < checkpointAt) {
+                throw runtime_error("The trace ended after " + to_string(replayed) + " instructions, before the checkpoint at " + to_string(checkpointAt));
+            }
+        }
+
+        simulator.finishIntervalStats();
+
+        // Display statistics for each process and component after simulation
+        simulator.displayStatistics();
+        if (scheduler) {
+            scheduler->displayStatistics();
+        }
+        if (sampleStats) {
+            uint64_t detailedAccesses = countAccesses(simulator).accesses;
+            sampleStats->displayStatistics(detailedAccesses + simulator.getFastForwardAccesses());
+        }
+#ifdef VMSIM_PROFILE
+        Profiler::displayStatistics(cout);
+        if (!profileJson.empty()) {
+            Profiler::writeJson(profileJson);
         }
+#endif
 
     }
     catch (const exception& e) {